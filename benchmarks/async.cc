@@ -1,19 +1,31 @@
 #include <yamail/resource_pool/async/pool.hpp>
+#include <yamail/resource_pool/async/sharded_pool.hpp>
+
+#include "latency_histogram.hpp"
 
 #include <benchmark/benchmark.h>
 
 #include <boost/asio/post.hpp>
 
+#if defined(BOOST_ASIO_HAS_CO_AWAIT)
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#endif
+
 #include <array>
 #include <atomic>
 #include <condition_variable>
 #include <iomanip>
 #include <random>
 #include <thread>
+#include <vector>
 
 namespace {
 
 using namespace yamail::resource_pool;
+using bench::latency_histogram;
+using bench::report_latencies;
 
 class benchmark_args {
 public:
@@ -57,11 +69,22 @@ public:
         return queue_size_;
     }
 
+    constexpr benchmark_args recycle_probability(double value) const {
+        auto copy = *this;
+        copy.recycle_probability_ = value;
+        return copy;
+    }
+
+    constexpr double recycle_probability() const {
+        return recycle_probability_;
+    }
+
 private:
     std::size_t sequences_ = 0;
     std::size_t threads_ = 0;
     std::size_t resources_ = 0;
     std::size_t queue_size_ = 0;
+    double recycle_probability_ = 0.5;
 };
 
 struct resource {
@@ -84,11 +107,13 @@ struct context {
     boost::asio::executor_work_guard<boost::asio::io_context::executor_type> guard = boost::asio::make_work_guard(io_context);
     std::conditional_t<std::is_same_v<Threading, multi_thread>, std::atomic_bool, bool> stop {false};
     time_traits::duration timeout {std::chrono::milliseconds(100)};
-    std::vector<std::chrono::steady_clock::duration> durations;
+    // Time from get call to handler invocation, written only by the thread running io_context.
+    latency_histogram latencies;
     std::mutex get_next_mutex;
     std::condition_variable get_next;
     std::unique_lock<std::mutex> get_next_lock {get_next_mutex};
     std::conditional_t<std::is_same_v<Threading, multi_thread>, std::atomic<std::int64_t>, std::int64_t> ready_count {0};
+    std::size_t depth = 0;
 
     void wait_next() {
         if (--ready_count < 0) {
@@ -109,19 +134,35 @@ struct context {
     }
 };
 
-template <class Threading>
+template <class Threading,
+          class Pool = async::pool<resource, std::conditional_t<std::is_same_v<Threading, multi_thread>, std::mutex, stub_mutex>>>
 struct callback {
-    using mutex_t = std::conditional_t<std::is_same_v<Threading, multi_thread>, std::mutex, stub_mutex>;
-    using pool_t = async::pool<resource, mutex_t>;
+    using pool_t = Pool;
     using handle_t = typename pool_t::handle;
 
     context<Threading>& ctx;
     pool_t& pool;
+    async::completion_mode mode = async::completion_mode::post;
+    double recycle_probability = 0.5;
+    time_traits::time_point issued {};
+
+    // Returns copy of the callback to pass into get started now.
+    callback issue() const {
+        auto copy = *this;
+        copy.issued = time_traits::now();
+        return copy;
+    }
 
     void operator ()(const boost::system::error_code& ec, handle_t handle) {
+        ctx.latencies.record(time_traits::now() - issued);
         impl(ec, std::move(handle));
         if (!ctx.stop) {
-            pool.get_auto_waste(ctx.io_context, *this, ctx.timeout);
+            // Dispatched completion runs inline, post after a few of them to keep stack bounded.
+            constexpr std::size_t max_dispatch_depth = 16;
+            ++ctx.depth;
+            pool.get_auto_waste(ctx.io_context, issue(), ctx.timeout,
+                                ctx.depth < max_dispatch_depth ? mode : async::completion_mode::post);
+            --ctx.depth;
         }
         ctx.allow_next();
     }
@@ -129,7 +170,6 @@ struct callback {
     void impl(const boost::system::error_code& ec, handle_t handle) {
         static thread_local std::minstd_rand generator(std::hash<std::thread::id>()(std::this_thread::get_id()));
         static std::uniform_real_distribution<> distrubution(0, 1);
-        constexpr const double recycle_probability = 0.5;
         if (!ec) {
             if (handle.empty()) {
                 handle.reset(resource {});
@@ -142,33 +182,45 @@ struct callback {
     }
 };
 
-const std::array<benchmark_args, 17> benchmarks{{
-    benchmark_args().sequences(1).threads(1).resources(1).queue_size(0), // 0
-    benchmark_args().sequences(2).threads(1).resources(1).queue_size(1), // 1
-    benchmark_args().sequences(2).threads(1).resources(2).queue_size(0), // 2
-    benchmark_args().sequences(10).threads(1).resources(10).queue_size(0), // 3
-    benchmark_args().sequences(10).threads(1).resources(1).queue_size(9), // 4
-    benchmark_args().sequences(10).threads(1).resources(5).queue_size(5), // 5
-    benchmark_args().sequences(10).threads(1).resources(9).queue_size(1), // 6
-    benchmark_args().sequences(10).threads(2).resources(5).queue_size(5), // 7
-    benchmark_args().sequences(100).threads(1).resources(100).queue_size(0), // 8
-    benchmark_args().sequences(100).threads(1).resources(10).queue_size(90), // 9
-    benchmark_args().sequences(100).threads(1).resources(50).queue_size(50), // 10
-    benchmark_args().sequences(100).threads(1).resources(90).queue_size(10), // 11
-    benchmark_args().sequences(100).threads(2).resources(50).queue_size(50), // 12
-    benchmark_args().sequences(1000).threads(1).resources(10).queue_size(990), // 13
-    benchmark_args().sequences(1000).threads(2).resources(10).queue_size(990), // 14
-    benchmark_args().sequences(10000).threads(1).resources(10).queue_size(9990), // 15
-    benchmark_args().sequences(10000).threads(2).resources(10).queue_size(9990), // 16
-}};
-
-void get_auto_waste_callbacks_st(benchmark::State& state) {
+// Matrix of threads from 1 to hardware concurrency by powers of 2, pool capacity,
+// queue size relative to capacity and recycle probability. Each thread runs
+// enough get sequences to occupy all resources and fill the queue.
+std::vector<benchmark_args> make_benchmarks() {
+    const auto max_threads = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+    std::vector<std::size_t> threads;
+    for (std::size_t n = 1; n < max_threads; n *= 2) {
+        threads.push_back(n);
+    }
+    threads.push_back(max_threads);
+    std::vector<benchmark_args> result;
+    for (const auto threads_count : threads) {
+        for (const std::size_t resources : {1, 10, 100}) {
+            for (const std::size_t queue_factor : {0, 1, 9}) {
+                for (const double recycle_probability : {0.0, 0.5, 1.0}) {
+                    const auto queue_size = resources * queue_factor;
+                    const auto sequences = std::max<std::size_t>(1, (resources + queue_size) / threads_count);
+                    result.push_back(benchmark_args()
+                        .sequences(sequences)
+                        .threads(threads_count)
+                        .resources(resources)
+                        .queue_size(queue_size)
+                        .recycle_probability(recycle_probability));
+                }
+            }
+        }
+    }
+    return result;
+}
+
+const std::vector<benchmark_args> benchmarks = make_benchmarks();
+
+void get_auto_waste_callbacks_st(benchmark::State& state, async::completion_mode mode) {
     const auto& args = benchmarks[static_cast<std::size_t>(state.range(0))];
     context<single_thread> ctx;
     async::pool<resource, stub_mutex> pool(args.resources(), args.queue_size());
-    callback<single_thread> cb {ctx, pool};
+    callback<single_thread> cb {ctx, pool, mode, args.recycle_probability()};
     for (std::size_t i = 0; i < args.sequences(); ++i) {
-        pool.get_auto_waste(ctx.io_context, cb, ctx.timeout);
+        pool.get_auto_waste(ctx.io_context, cb.issue(), ctx.timeout, mode);
     }
     while (state.KeepRunning()) {
         const auto ready_count = ctx.ready_count;
@@ -176,6 +228,9 @@ void get_auto_waste_callbacks_st(benchmark::State& state) {
             ctx.io_context.run_one();
         } while (ready_count == ctx.ready_count);
     }
+    // Handler run may complete several gets inline, so compare modes by items.
+    state.SetItemsProcessed(ctx.ready_count);
+    report_latencies(state, ctx.latencies);
     ctx.finish();
 }
 
@@ -187,6 +242,12 @@ struct thread_context {
         : thread([this] { this->impl.io_context.run(); }) {}
 };
 
+latency_histogram merge_latencies(const std::vector<std::unique_ptr<thread_context>>& threads) {
+    latency_histogram result;
+    std::for_each(threads.begin(), threads.end(), [&] (const auto& ctx) { result.merge(ctx->impl.latencies); });
+    return result;
+}
+
 void get_auto_waste_callbacks_mt(benchmark::State& state) {
     const auto& args = benchmarks[static_cast<std::size_t>(state.range(0))];
     std::vector<std::unique_ptr<thread_context>> threads;
@@ -195,16 +256,18 @@ void get_auto_waste_callbacks_mt(benchmark::State& state) {
     }
     async::pool<resource> pool(args.resources(), args.queue_size());
     for (const auto& ctx : threads) {
-        callback<multi_thread> cb {ctx->impl, pool};
+        callback<multi_thread> cb {ctx->impl, pool, async::completion_mode::post, args.recycle_probability()};
         for (std::size_t i = 0; i < args.sequences(); ++i) {
-            pool.get_auto_waste(ctx->impl.io_context, cb, ctx->impl.timeout);
+            pool.get_auto_waste(ctx->impl.io_context, cb.issue(), ctx->impl.timeout);
         }
     }
     while (state.KeepRunning()) {
         std::for_each(threads.begin(), threads.end(), [] (const auto& ctx) { ctx->impl.wait_next(); });
     }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * args.threads()));
     std::for_each(threads.begin(), threads.end(), [] (const auto& ctx) { ctx->impl.finish(); });
     std::for_each(threads.begin(), threads.end(), [] (const auto& ctx) { ctx->thread.join(); });
+    report_latencies(state, merge_latencies(threads));
 }
 
 void get_auto_waste_callbacks(benchmark::State& state) {
@@ -212,7 +275,7 @@ void get_auto_waste_callbacks(benchmark::State& state) {
     if (args.threads() > 1) {
         get_auto_waste_callbacks_mt(state);
     } else {
-        get_auto_waste_callbacks_st(state);
+        get_auto_waste_callbacks_st(state, async::completion_mode::post);
     }
 }
 
@@ -224,16 +287,17 @@ void get_auto_waste_coroutines_st(benchmark::State& state) {
         boost::asio::spawn(ctx.io_context, [&] (boost::asio::yield_context yield) {
             static thread_local std::minstd_rand generator(std::hash<std::thread::id>()(std::this_thread::get_id()));
             std::uniform_real_distribution<> distrubution(0, 1);
-            constexpr const double recycle_probability = 0.5;
             while (!ctx.stop) {
                 boost::system::error_code ec;
+                const auto issued = time_traits::now();
                 auto handle = pool.get_auto_waste(ctx.io_context, yield[ec], ctx.timeout);
+                ctx.latencies.record(time_traits::now() - issued);
                 if (!ec) {
                     if (handle.empty()) {
                         handle.reset(resource {});
                     }
                     benchmark::DoNotOptimize(++handle->value);
-                    if (distrubution(generator) < recycle_probability) {
+                    if (distrubution(generator) < args.recycle_probability()) {
                         handle.recycle();
                     }
                     ctx.allow_next();
@@ -247,6 +311,8 @@ void get_auto_waste_coroutines_st(benchmark::State& state) {
             ctx.io_context.run_one();
         } while (ready_count == ctx.ready_count);
     }
+    state.SetItemsProcessed(ctx.ready_count);
+    report_latencies(state, ctx.latencies);
     ctx.finish();
 }
 
@@ -262,16 +328,17 @@ void get_auto_waste_coroutines_mt(benchmark::State& state) {
             boost::asio::spawn(ctx->impl.io_context, [&] (boost::asio::yield_context yield) {
                 static thread_local std::minstd_rand generator(std::hash<std::thread::id>()(std::this_thread::get_id()));
                 std::uniform_real_distribution<> distrubution(0, 1);
-                constexpr const double recycle_probability = 0.5;
                 while (!ctx->impl.stop) {
                     boost::system::error_code ec;
+                    const auto issued = time_traits::now();
                     auto handle = pool.get_auto_waste(ctx->impl.io_context, yield[ec], ctx->impl.timeout);
+                    ctx->impl.latencies.record(time_traits::now() - issued);
                     if (!ec) {
                         if (handle.empty()) {
                             handle.reset(resource {});
                         }
                         benchmark::DoNotOptimize(++handle->value);
-                        if (distrubution(generator) < recycle_probability) {
+                        if (distrubution(generator) < args.recycle_probability()) {
                             handle.recycle();
                         }
                         ctx->impl.allow_next();
@@ -283,28 +350,311 @@ void get_auto_waste_coroutines_mt(benchmark::State& state) {
     while (state.KeepRunning()) {
         std::for_each(threads.begin(), threads.end(), [] (const auto& ctx) { ctx->impl.wait_next(); });
     }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * args.threads()));
     std::for_each(threads.begin(), threads.end(), [] (const auto& ctx) { ctx->impl.finish(); });
     std::for_each(threads.begin(), threads.end(), [] (const auto& ctx) { ctx->thread.join(); });
+    report_latencies(state, merge_latencies(threads));
 }
 
 void get_auto_waste_coroutines(benchmark::State& state) {
     const auto& args = benchmarks[static_cast<std::size_t>(state.range(0))];
     if (args.threads() > 1) {
-        get_auto_waste_coroutines_st(state);
-    } else {
         get_auto_waste_coroutines_mt(state);
+    } else {
+        get_auto_waste_coroutines_st(state);
+    }
+}
+
+// Runs sequences_per_thread callback chains on each thread sharing one pool
+// with capacity for all of them, so get is limited only by pool locking.
+template <class MakePool>
+void get_auto_waste_scaling(benchmark::State& state, MakePool make_pool) {
+    constexpr std::size_t sequences_per_thread = 10;
+    const auto threads_count = static_cast<std::size_t>(state.range(0));
+    std::vector<std::unique_ptr<thread_context>> threads;
+    for (std::size_t i = 0; i < threads_count; ++i) {
+        threads.emplace_back(std::make_unique<thread_context>());
+    }
+    auto pool = make_pool(threads_count, threads_count * sequences_per_thread, sequences_per_thread);
+    for (const auto& ctx : threads) {
+        callback<multi_thread, decltype(pool)> cb {ctx->impl, pool};
+        for (std::size_t i = 0; i < sequences_per_thread; ++i) {
+            pool.get_auto_waste(ctx->impl.io_context, cb.issue(), ctx->impl.timeout);
+        }
+    }
+    while (state.KeepRunning()) {
+        std::for_each(threads.begin(), threads.end(), [] (const auto& ctx) { ctx->impl.wait_next(); });
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * threads_count));
+    std::for_each(threads.begin(), threads.end(), [] (const auto& ctx) { ctx->impl.finish(); });
+    std::for_each(threads.begin(), threads.end(), [] (const auto& ctx) { ctx->thread.join(); });
+}
+
+using handle_benchmark_pool_impl = async::default_pool_impl<resource, stub_mutex, boost::asio::io_context>::type;
+
+// Leases cell directly from pool implementation and returns it through handle destructor.
+template <class Handle>
+void recycle_handle(benchmark::State& state) {
+    const auto impl = std::make_shared<handle_benchmark_pool_impl>(1, 0, time_traits::duration::max(),
+                                                                   time_traits::duration::max());
+    for (auto _ : state) {
+        const auto cell = impl->try_lease();
+        if constexpr (std::is_same_v<Handle, handle<resource, handle_benchmark_pool_impl::list_iterator>>) {
+            Handle handle(impl.get(), &Handle::recycle, *cell);
+            benchmark::DoNotOptimize(handle.unusable());
+        } else {
+            Handle handle(impl.get(), *cell);
+            benchmark::DoNotOptimize(handle.unusable());
+        }
+    }
+}
+
+// Chains of gets with handler bound to executor of other io_context than one
+// passed to pool.
+struct bound_callback {
+    using executor_type = boost::asio::io_context::executor_type;
+    using pool_t = async::pool<resource>;
+
+    boost::asio::io_context& io;
+    executor_type executor;
+    pool_t& pool;
+    std::int64_t& completed;
+
+    void operator ()(const boost::system::error_code& ec, pool_t::handle handle) {
+        if (!ec) {
+            if (handle.empty()) {
+                handle.reset(resource {});
+            }
+            benchmark::DoNotOptimize(++handle->value);
+            handle.recycle();
+        }
+        ++completed;
+        pool.get_auto_waste(io, *this, time_traits::duration::max());
+    }
+
+    executor_type get_executor() const noexcept {
+        return executor;
+    }
+};
+
+void get_auto_waste_bound_to_other_io_context(benchmark::State& state) {
+    const auto sequences = static_cast<std::size_t>(state.range(0));
+    boost::asio::io_context io;
+    boost::asio::io_context handler_io;
+    async::pool<resource> pool(sequences, sequences);
+    std::int64_t completed = 0;
+    for (std::size_t i = 0; i < sequences; ++i) {
+        pool.get_auto_waste(io, bound_callback {io, handler_io.get_executor(), pool, completed});
+    }
+    for (auto _ : state) {
+        const auto before = completed;
+        do {
+            io.poll_one();
+            handler_io.poll_one();
+            io.restart();
+            handler_io.restart();
+        } while (before == completed);
+    }
+    state.SetItemsProcessed(completed);
+}
+
+// Leases fan_out resources per iteration on single io_context by separate gets
+// or by one batch get.
+void get_fan_out(benchmark::State& state, bool batch) {
+    const auto fan_out = static_cast<std::size_t>(state.range(0));
+    boost::asio::io_context io;
+    async::pool<resource> pool(fan_out, 0);
+    const auto use = [] (auto& handle) {
+        if (handle.empty()) {
+            handle.reset(resource {});
+        }
+        benchmark::DoNotOptimize(handle->value);
+    };
+    for (auto _ : state) {
+        if (batch) {
+            pool.get_many_auto_recycle(io, fan_out, [&] (const boost::system::error_code&, auto handles) {
+                std::for_each(handles.begin(), handles.end(), use);
+            });
+        } else {
+            for (std::size_t i = 0; i < fan_out; ++i) {
+                pool.get_auto_recycle(io, [&] (const boost::system::error_code&, auto handle) {
+                    use(handle);
+                });
+            }
+        }
+        io.run();
+        io.restart();
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * fan_out));
+}
+
+// Leases fan_out handles, queues fan_out requests and returns handles one by one
+// or by single recycle_all serving the requests.
+void recycle_fan_out(benchmark::State& state, bool batch) {
+    const auto fan_out = static_cast<std::size_t>(state.range(0));
+    boost::asio::io_context io;
+    async::pool<resource> pool(fan_out, fan_out);
+    std::vector<async::pool<resource>::handle> handles;
+    for (auto _ : state) {
+        pool.get_many_auto_waste(io, fan_out, [&] (const boost::system::error_code&, auto result) {
+            handles = std::move(result);
+            for (auto& handle : handles) {
+                if (handle.empty()) {
+                    handle.reset(resource {});
+                }
+            }
+        });
+        io.run();
+        io.restart();
+        for (std::size_t i = 0; i < fan_out; ++i) {
+            pool.get_auto_recycle(io, [] (const boost::system::error_code&, auto handle) {
+                benchmark::DoNotOptimize(handle->value);
+            }, time_traits::duration::max());
+        }
+        if (batch) {
+            pool.recycle_all(handles);
+        } else {
+            std::for_each(handles.begin(), handles.end(), [] (auto& handle) { handle.recycle(); });
+        }
+        io.run();
+        io.restart();
     }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * fan_out));
+}
+
+#if defined(BOOST_ASIO_HAS_CO_AWAIT)
+enum class coroutine_get {
+    yield_context,
+    use_awaitable,
+    co_get,
+};
+
+template <class Handle>
+void use_handle(Handle& handle, std::minstd_rand& generator) {
+    std::uniform_real_distribution<> distrubution(0, 1);
+    constexpr const double recycle_probability = 0.5;
+    if (handle.empty()) {
+        handle.reset(resource {});
+    }
+    benchmark::DoNotOptimize(++handle->value);
+    if (distrubution(generator) < recycle_probability) {
+        handle.recycle();
+    }
+}
+
+// Each of sequences coroutines gets handle gets_per_sequence times, resources
+// count is given by second argument, queue fits the rest of sequences.
+void get_auto_waste_coroutine_kinds(benchmark::State& state, coroutine_get kind) {
+    constexpr std::size_t gets_per_sequence = 1000;
+    const auto sequences = static_cast<std::size_t>(state.range(0));
+    const auto resources = static_cast<std::size_t>(state.range(1));
+    const time_traits::duration timeout = std::chrono::seconds(1);
+    boost::asio::io_context io;
+    async::pool<resource, stub_mutex> pool(resources, sequences - resources);
+    std::minstd_rand generator;
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < sequences; ++i) {
+            if (kind == coroutine_get::yield_context) {
+                boost::asio::spawn(io, [&] (boost::asio::yield_context yield) {
+                    for (std::size_t n = 0; n < gets_per_sequence; ++n) {
+                        auto handle = pool.get_auto_waste(io, yield, timeout);
+                        use_handle(handle, generator);
+                    }
+                });
+            } else {
+                boost::asio::co_spawn(io, [&] () -> boost::asio::awaitable<void> {
+                    for (std::size_t n = 0; n < gets_per_sequence; ++n) {
+                        auto handle = kind == coroutine_get::co_get
+                            ? co_await pool.co_get_auto_waste(io, timeout)
+                            : co_await pool.get_auto_waste(io, boost::asio::use_awaitable, timeout);
+                        use_handle(handle, generator);
+                    }
+                }, boost::asio::detached);
+            }
+        }
+        io.run();
+        io.restart();
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * sequences * gets_per_sequence));
+}
+
+void coroutine_kinds_args(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"sequences", "resources"})->Args({1, 1})->Args({10, 10})->Args({10, 5})->Args({100, 50});
+}
+#endif
+
+void fan_out_sizes(benchmark::internal::Benchmark* b) {
+    b->ArgName("fan_out")->RangeMultiplier(4)->Range(1, 64);
+}
+
+void scaling_threads(benchmark::internal::Benchmark* b) {
+    b->ArgName("threads")->RangeMultiplier(2)->Range(1, 32)->UseRealTime();
+}
+
+// First argument is index of benchmark_args row, others are its values for
+// readable names, recycle probability is given in percents.
+void add_benchmark_args(benchmark::internal::Benchmark* b, std::size_t n) {
+    const auto& args = benchmarks[n];
+    b->Args({
+        static_cast<int>(n),
+        static_cast<int>(args.threads()),
+        static_cast<int>(args.resources()),
+        static_cast<int>(args.queue_size()),
+        static_cast<int>(args.recycle_probability() * 100),
+    });
 }
 
 void all_benchmarks(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"row", "threads", "resources", "queue_size", "recycle_percent"})->UseRealTime();
+    for (std::size_t n = 0; n < benchmarks.size(); ++n) {
+        add_benchmark_args(b, n);
+    }
+}
+
+void single_thread_benchmarks(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"row", "threads", "resources", "queue_size", "recycle_percent"});
     for (std::size_t n = 0; n < benchmarks.size(); ++n) {
-        b->Arg(static_cast<int>(n));
+        if (benchmarks[n].threads() == 1) {
+            add_benchmark_args(b, n);
+        }
     }
 }
 
 }
 
 BENCHMARK(get_auto_waste_callbacks)->Apply(all_benchmarks);
+BENCHMARK_CAPTURE(get_auto_waste_callbacks_st, post, async::completion_mode::post)->Apply(single_thread_benchmarks);
+BENCHMARK_CAPTURE(get_auto_waste_callbacks_st, dispatch, async::completion_mode::dispatch)->Apply(single_thread_benchmarks);
 BENCHMARK(get_auto_waste_coroutines)->Apply(all_benchmarks);
+#if defined(BOOST_ASIO_HAS_CO_AWAIT)
+BENCHMARK_CAPTURE(get_auto_waste_coroutine_kinds, yield_context, coroutine_get::yield_context)->Apply(coroutine_kinds_args);
+BENCHMARK_CAPTURE(get_auto_waste_coroutine_kinds, use_awaitable, coroutine_get::use_awaitable)->Apply(coroutine_kinds_args);
+BENCHMARK_CAPTURE(get_auto_waste_coroutine_kinds, co_get, coroutine_get::co_get)->Apply(coroutine_kinds_args);
+#endif
+BENCHMARK(get_auto_waste_bound_to_other_io_context)->ArgName("sequences")->Arg(1)->Arg(10);
+BENCHMARK_TEMPLATE(recycle_handle, handle<resource, handle_benchmark_pool_impl::list_iterator>);
+BENCHMARK_TEMPLATE(recycle_handle, static_handle<handle_benchmark_pool_impl, auto_recycle>);
+BENCHMARK_CAPTURE(get_fan_out, get_auto_recycle, false)->Apply(fan_out_sizes);
+BENCHMARK_CAPTURE(get_fan_out, get_many_auto_recycle, true)->Apply(fan_out_sizes);
+BENCHMARK_CAPTURE(recycle_fan_out, recycle, false)->Apply(fan_out_sizes);
+BENCHMARK_CAPTURE(recycle_fan_out, recycle_all, true)->Apply(fan_out_sizes);
+BENCHMARK_CAPTURE(get_auto_waste_scaling, pool,
+    [] (std::size_t, std::size_t resources, std::size_t queue_size) {
+        return async::pool<resource>(resources, queue_size);
+    })->Apply(scaling_threads);
+BENCHMARK_CAPTURE(get_auto_waste_scaling, fast_path_pool,
+    [] (std::size_t, std::size_t resources, std::size_t queue_size) {
+        using impl = async::fast_path_pool_impl<resource, std::mutex, boost::asio::io_context>::type;
+        return async::pool<resource, std::mutex, boost::asio::io_context, impl>(resources, queue_size);
+    })->Apply(scaling_threads);
+BENCHMARK_CAPTURE(get_auto_waste_scaling, magazine_pool,
+    [] (std::size_t, std::size_t resources, std::size_t queue_size) {
+        using impl = async::magazine_pool_impl<resource, std::mutex, boost::asio::io_context>::type;
+        return async::pool<resource, std::mutex, boost::asio::io_context, impl>(resources, queue_size);
+    })->Apply(scaling_threads);
+BENCHMARK_CAPTURE(get_auto_waste_scaling, sharded_pool,
+    [] (std::size_t threads, std::size_t resources, std::size_t queue_size) {
+        return async::sharded_pool<resource>(threads, resources, queue_size);
+    })->Apply(scaling_threads);
 
 BENCHMARK_MAIN();
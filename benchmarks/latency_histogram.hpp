@@ -0,0 +1,99 @@
+#ifndef YAMAIL_RESOURCE_POOL_BENCHMARKS_LATENCY_HISTOGRAM_HPP
+#define YAMAIL_RESOURCE_POOL_BENCHMARKS_LATENCY_HISTOGRAM_HPP
+
+#include <yamail/resource_pool/time_traits.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+namespace yamail {
+namespace resource_pool {
+namespace bench {
+
+// Log-linear histogram of durations in nanoseconds like HdrHistogram: values
+// below sub_buckets are counted exactly, each next power of two range is split
+// into sub_buckets / 2 linear buckets, so relative error is below 2 / sub_buckets.
+class latency_histogram {
+public:
+    static constexpr unsigned sub_bucket_bits = 6;
+    static constexpr std::size_t sub_buckets = std::size_t(1) << sub_bucket_bits;
+    static constexpr std::size_t half = sub_buckets / 2;
+    static constexpr std::size_t buckets = sub_buckets + (64 - sub_bucket_bits) * half;
+
+    void record(time_traits::duration value) {
+        const auto ns = static_cast<std::uint64_t>(std::max<std::int64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(value).count(), 0));
+        ++counts_[index(ns)];
+        ++count_;
+        max_ = std::max(max_, ns);
+    }
+
+    void merge(const latency_histogram& other) {
+        for (std::size_t i = 0; i < buckets; ++i) {
+            counts_[i] += other.counts_[i];
+        }
+        count_ += other.count_;
+        max_ = std::max(max_, other.max_);
+    }
+
+    std::uint64_t count() const { return count_; }
+    std::uint64_t max() const { return max_; }
+
+    // Returns highest value of the bucket containing given quantile.
+    std::uint64_t percentile(double quantile) const {
+        const auto rank = static_cast<std::uint64_t>(quantile * static_cast<double>(count_));
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < buckets; ++i) {
+            seen += counts_[i];
+            if (seen > rank) {
+                return std::min(highest(i), max_);
+            }
+        }
+        return max_;
+    }
+
+private:
+    std::array<std::uint64_t, buckets> counts_ {};
+    std::uint64_t count_ = 0;
+    std::uint64_t max_ = 0;
+
+    static unsigned shift(std::uint64_t value) {
+        const auto msb = 63u - static_cast<unsigned>(__builtin_clzll(value));
+        return msb - sub_bucket_bits + 1;
+    }
+
+    static std::size_t index(std::uint64_t value) {
+        if (value < sub_buckets) {
+            return static_cast<std::size_t>(value);
+        }
+        const auto e = shift(value);
+        return sub_buckets + (e - 1) * half + static_cast<std::size_t>((value >> e) - half);
+    }
+
+    static std::uint64_t highest(std::size_t index) {
+        if (index < sub_buckets) {
+            return index;
+        }
+        const auto e = static_cast<unsigned>((index - sub_buckets) / half + 1);
+        const auto sub = (index - sub_buckets) % half + half;
+        return ((static_cast<std::uint64_t>(sub) + 1) << e) - 1;
+    }
+};
+
+inline void report_latencies(benchmark::State& state, const latency_histogram& latencies) {
+    state.counters["latency_p50_ns"] = static_cast<double>(latencies.percentile(0.5));
+    state.counters["latency_p90_ns"] = static_cast<double>(latencies.percentile(0.9));
+    state.counters["latency_p99_ns"] = static_cast<double>(latencies.percentile(0.99));
+    state.counters["latency_p999_ns"] = static_cast<double>(latencies.percentile(0.999));
+    state.counters["latency_max_ns"] = static_cast<double>(latencies.max());
+}
+
+} // namespace bench
+} // namespace resource_pool
+} // namespace yamail
+
+#endif // YAMAIL_RESOURCE_POOL_BENCHMARKS_LATENCY_HISTOGRAM_HPP
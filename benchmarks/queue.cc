@@ -0,0 +1,89 @@
+#include <yamail/resource_pool/async/detail/queue.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <boost/asio/io_context.hpp>
+
+#include <array>
+#include <memory>
+
+namespace {
+
+using namespace yamail::resource_pool;
+
+struct request {
+    void operator ()(boost::system::error_code) const {}
+};
+
+template <template <class> class DeadlineIndex>
+using queue = async::detail::queue<request, std::mutex, boost::asio::io_context, time_traits::timer, DeadlineIndex>;
+
+using async::detail::fifo_deadline_index;
+using async::detail::multimap_deadline_index;
+
+const std::array<time_traits::duration, 4> wait_durations {{
+    std::chrono::seconds(1),
+    std::chrono::seconds(2),
+    std::chrono::seconds(3),
+    std::chrono::seconds(4),
+}};
+
+time_traits::duration wait_duration(std::size_t n, std::size_t distinct_durations) {
+    return wait_durations[n % distinct_durations];
+}
+
+// Keeps in_flight requests with the same wait duration queued, pops the oldest
+// and pushes a new one on each iteration, polling io_context for timer completions.
+template <template <class> class DeadlineIndex>
+void push_pop(benchmark::State& state) {
+    const auto in_flight = static_cast<std::size_t>(state.range(0));
+    const auto distinct_durations = static_cast<std::size_t>(state.range(1));
+    boost::asio::io_context io;
+    const auto requests = std::make_shared<queue<DeadlineIndex>>(in_flight + 1);
+    std::size_t n = 0;
+    for (std::size_t i = 0; i < in_flight; ++i) {
+        requests->push(io, wait_duration(n++, distinct_durations), request {});
+    }
+    for (auto _ : state) {
+        requests->push(io, wait_duration(n++, distinct_durations), request {});
+        benchmark::DoNotOptimize(requests->pop());
+        io.poll();
+    }
+    while (requests->pop()) {}
+    io.run();
+}
+
+// Pushes burst requests and then pops all of them, so each pop removes the earliest deadline.
+template <template <class> class DeadlineIndex>
+void push_pop_burst(benchmark::State& state) {
+    const auto burst = static_cast<std::size_t>(state.range(0));
+    const auto distinct_durations = static_cast<std::size_t>(state.range(1));
+    boost::asio::io_context io;
+    const auto requests = std::make_shared<queue<DeadlineIndex>>(burst);
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < burst; ++i) {
+            requests->push(io, wait_duration(i, distinct_durations), request {});
+        }
+        while (requests->pop()) {}
+        io.poll();
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * burst));
+    io.run();
+}
+
+void push_pop_args(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"in_flight", "durations"})->ArgsProduct({{1, 10, 100, 1000, 10000}, {1, 4}});
+}
+
+void push_pop_burst_args(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"burst", "durations"})->ArgsProduct({{1, 10, 100, 1000, 10000}, {1, 4}});
+}
+
+}
+
+BENCHMARK_TEMPLATE(push_pop, fifo_deadline_index)->Apply(push_pop_args);
+BENCHMARK_TEMPLATE(push_pop, multimap_deadline_index)->Apply(push_pop_args);
+BENCHMARK_TEMPLATE(push_pop_burst, fifo_deadline_index)->Apply(push_pop_burst_args);
+BENCHMARK_TEMPLATE(push_pop_burst, multimap_deadline_index)->Apply(push_pop_burst_args);
+
+BENCHMARK_MAIN();
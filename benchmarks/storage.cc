@@ -0,0 +1,59 @@
+#include <yamail/resource_pool/detail/storage.hpp>
+#include <yamail/resource_pool/detail/slab_storage.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <deque>
+
+namespace {
+
+using namespace yamail::resource_pool;
+
+struct resource {
+    std::size_t leases = 0;
+};
+
+// Keeps in_flight resources leased and recycles the oldest one on each iteration.
+// Reports how many distinct resources were leased at least once (working_set).
+template <class Storage>
+void lease_recycle(benchmark::State& state) {
+    const auto order = static_cast<lease_order>(state.range(0));
+    const auto capacity = static_cast<std::size_t>(state.range(1));
+    const auto in_flight = static_cast<std::size_t>(state.range(2));
+    Storage storage([] { return resource {}; }, capacity, time_traits::duration::max(), time_traits::duration::max(), order);
+    std::deque<typename Storage::cell_iterator> leased;
+    std::vector<resource> dropped;
+    for (auto _ : state) {
+        const auto cell = *storage.lease(dropped);
+        benchmark::DoNotOptimize(++cell->value->leases);
+        leased.push_back(cell);
+        if (leased.size() > in_flight) {
+            storage.recycle(leased.front(), dropped);
+            leased.pop_front();
+        }
+    }
+    std::for_each(leased.begin(), leased.end(), [&] (const auto& cell) { storage.recycle(cell, dropped); });
+    std::size_t working_set = 0;
+    while (const auto cell = storage.lease(dropped)) {
+        working_set += (*cell)->value->leases > 0;
+    }
+    state.counters["working_set"] = static_cast<double>(working_set);
+}
+
+void all_args(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"order", "capacity", "in_flight"});
+    for (const auto order : {lease_order::fifo, lease_order::lifo, lease_order::youngest}) {
+        for (const int capacity : {10, 100, 1000}) {
+            for (const int in_flight : {1, 4}) {
+                b->Args({static_cast<int>(order), capacity, in_flight});
+            }
+        }
+    }
+}
+
+}
+
+BENCHMARK_TEMPLATE(lease_recycle, detail::storage<resource>)->Apply(all_args);
+BENCHMARK_TEMPLATE(lease_recycle, detail::slab_storage<resource>)->Apply(all_args);
+
+BENCHMARK_MAIN();
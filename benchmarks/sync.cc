@@ -0,0 +1,265 @@
+#include <yamail/resource_pool/sync/pool.hpp>
+
+#include "latency_histogram.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace yamail::resource_pool;
+using bench::latency_histogram;
+using bench::report_latencies;
+
+class benchmark_args {
+public:
+    constexpr benchmark_args threads(std::size_t value) const {
+        auto copy = *this;
+        copy.threads_ = value;
+        return copy;
+    }
+
+    constexpr std::size_t threads() const {
+        return threads_;
+    }
+
+    constexpr benchmark_args resources(std::size_t value) const {
+        auto copy = *this;
+        copy.resources_ = value;
+        return copy;
+    }
+
+    constexpr std::size_t resources() const {
+        return resources_;
+    }
+
+    constexpr benchmark_args recycle_probability(double value) const {
+        auto copy = *this;
+        copy.recycle_probability_ = value;
+        return copy;
+    }
+
+    constexpr double recycle_probability() const {
+        return recycle_probability_;
+    }
+
+    constexpr benchmark_args wait_duration(time_traits::duration value) const {
+        auto copy = *this;
+        copy.wait_duration_ = value;
+        return copy;
+    }
+
+    constexpr time_traits::duration wait_duration() const {
+        return wait_duration_;
+    }
+
+private:
+    std::size_t threads_ = 0;
+    std::size_t resources_ = 0;
+    double recycle_probability_ = 1;
+    time_traits::duration wait_duration_ = std::chrono::seconds(1);
+};
+
+struct resource {
+    std::int64_t value = 0;
+};
+
+using pool_t = sync::pool<resource>;
+using magazine_pool_t = sync::pool<resource, std::mutex, sync::magazine_pool_impl<resource>::type>;
+using spinning_pool_t = sync::pool<resource, std::mutex, sync::spinning_pool_impl<resource>::type>;
+
+template <class Handle>
+void use_resource(Handle& handle, std::size_t hold) {
+    if (handle.empty()) {
+        handle.reset(resource {});
+    }
+    for (std::size_t i = 0; i < hold; ++i) {
+        benchmark::DoNotOptimize(++handle->value);
+    }
+    handle.recycle();
+}
+
+// Recycles resource with given probability, otherwise handle of get_auto_waste wastes it.
+template <class Handle>
+void use_resource(Handle& handle, std::minstd_rand& generator, double recycle_probability) {
+    std::uniform_real_distribution<> distrubution(0, 1);
+    if (handle.empty()) {
+        handle.reset(resource {});
+    }
+    benchmark::DoNotOptimize(++handle->value);
+    if (distrubution(generator) < recycle_probability) {
+        handle.recycle();
+    }
+}
+
+const std::array<benchmark_args, 16> benchmarks{{
+    benchmark_args().threads(1).resources(1), // 0
+    benchmark_args().threads(2).resources(1), // 1
+    benchmark_args().threads(2).resources(2), // 2
+    benchmark_args().threads(4).resources(1), // 3
+    benchmark_args().threads(4).resources(2), // 4
+    benchmark_args().threads(4).resources(4), // 5
+    benchmark_args().threads(8).resources(1), // 6
+    benchmark_args().threads(8).resources(4), // 7
+    benchmark_args().threads(8).resources(8), // 8
+    benchmark_args().threads(16).resources(4), // 9
+    benchmark_args().threads(16).resources(16), // 10
+    benchmark_args().threads(1).resources(1).recycle_probability(0), // 11
+    benchmark_args().threads(4).resources(2).recycle_probability(0.5), // 12
+    benchmark_args().threads(4).resources(4).recycle_probability(0), // 13
+    benchmark_args().threads(8).resources(4).recycle_probability(0.1), // 14
+    benchmark_args().threads(8).resources(4).wait_duration(std::chrono::microseconds(10)), // 15
+}};
+
+// Single thread gets resource and returns it to the pool of capacity 1, so
+// each get takes the only cell without waiting.
+template <class Pool>
+void get_auto_recycle_uncontended(benchmark::State& state) {
+    Pool pool(1);
+    for (auto _ : state) {
+        auto res = pool.get_auto_recycle();
+        use_resource(res.second, 0);
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+}
+
+// Benchmark thread and threads - 1 workers get resources from shared pool with
+// get_auto_waste and recycle them with given probability. Reports acquisitions
+// of all threads as items and number of failed gets as timeouts.
+template <class Pool>
+void get_auto_waste_contended(benchmark::State& state) {
+    const auto& args = benchmarks[static_cast<std::size_t>(state.range(0))];
+    Pool pool(args.resources());
+    std::atomic_bool stop {false};
+    std::atomic<std::int64_t> acquired {0};
+    std::atomic<std::int64_t> timeouts {0};
+    const auto get = [&] (std::minstd_rand& generator) {
+        auto res = pool.get_auto_waste(args.wait_duration());
+        if (res.first) {
+            timeouts.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            use_resource(res.second, generator, args.recycle_probability());
+            acquired.fetch_add(1, std::memory_order_relaxed);
+        }
+    };
+    std::vector<std::thread> workers;
+    for (std::size_t i = 1; i < args.threads(); ++i) {
+        workers.emplace_back([&, i] {
+            std::minstd_rand generator(static_cast<std::minstd_rand::result_type>(i));
+            while (!stop) {
+                get(generator);
+            }
+        });
+    }
+    std::minstd_rand generator;
+    const auto acquired_before = acquired.load();
+    const auto timeouts_before = timeouts.load();
+    for (auto _ : state) {
+        get(generator);
+    }
+    state.SetItemsProcessed(acquired.load() - acquired_before);
+    state.counters["timeouts"] = static_cast<double>(timeouts.load() - timeouts_before);
+    stop = true;
+    std::for_each(workers.begin(), workers.end(), [] (auto& worker) { worker.join(); });
+}
+
+// Gets from exhausted pool with wait_duration given in nanoseconds, reports mean
+// time waited over wait_duration.
+template <class Pool>
+void get_timeout(benchmark::State& state) {
+    const time_traits::duration wait_duration = std::chrono::nanoseconds(state.range(0));
+    Pool pool(1);
+    const auto leased = pool.get_auto_recycle();
+    time_traits::duration overshoot(0);
+    for (auto _ : state) {
+        const auto start = time_traits::now();
+        const auto res = pool.get_auto_recycle(wait_duration);
+        overshoot += time_traits::now() - start - wait_duration;
+        benchmark::DoNotOptimize(res.first);
+    }
+    const auto mean = std::chrono::duration_cast<std::chrono::nanoseconds>(overshoot).count()
+        / std::max<std::int64_t>(state.iterations(), 1);
+    state.counters["overshoot_ns"] = static_cast<double>(mean);
+}
+
+// Benchmark thread and threads - 1 workers get resource from pool with given
+// capacity, hold it and recycle. Wait time of benchmark thread gets is reported
+// by percentiles in nanoseconds.
+template <class Pool>
+void get_auto_recycle_wait_time(benchmark::State& state) {
+    const auto threads_count = static_cast<std::size_t>(state.range(0));
+    const auto capacity = static_cast<std::size_t>(state.range(1));
+    const auto hold = static_cast<std::size_t>(state.range(2));
+    const time_traits::duration timeout = std::chrono::seconds(1);
+    Pool pool(capacity);
+    std::atomic_bool stop {false};
+    std::vector<std::thread> workers;
+    for (std::size_t i = 1; i < threads_count; ++i) {
+        workers.emplace_back([&] {
+            while (!stop) {
+                auto res = pool.get_auto_recycle(timeout);
+                if (!res.first) {
+                    use_resource(res.second, hold);
+                }
+            }
+        });
+    }
+    latency_histogram waits;
+    std::int64_t timeouts = 0;
+    for (auto _ : state) {
+        const auto start = time_traits::now();
+        auto res = pool.get_auto_recycle(timeout);
+        waits.record(time_traits::now() - start);
+        if (res.first) {
+            ++timeouts;
+        } else {
+            use_resource(res.second, hold);
+        }
+    }
+    stop = true;
+    std::for_each(workers.begin(), workers.end(), [] (auto& worker) { worker.join(); });
+    report_latencies(state, waits);
+    state.counters["timeouts"] = static_cast<double>(timeouts);
+}
+
+void all_benchmarks(benchmark::internal::Benchmark* b) {
+    for (std::size_t n = 0; n < benchmarks.size(); ++n) {
+        b->Arg(static_cast<int>(n));
+    }
+    b->UseRealTime();
+}
+
+void wait_durations(benchmark::internal::Benchmark* b) {
+    b->ArgName("wait_ns")->Arg(0)->Arg(1000)->Arg(10000)->Arg(100000)->UseRealTime();
+}
+
+void wait_time_args(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"threads", "capacity", "hold"})->UseRealTime();
+    for (const int threads : {2, 4, 8, 16}) {
+        for (const int capacity : {1, 2}) {
+            for (const int hold : {10, 1000}) {
+                b->Args({threads, capacity, hold});
+            }
+        }
+    }
+}
+
+}
+
+BENCHMARK_TEMPLATE(get_auto_recycle_uncontended, pool_t);
+BENCHMARK_TEMPLATE(get_auto_recycle_uncontended, magazine_pool_t);
+BENCHMARK_TEMPLATE(get_auto_recycle_uncontended, spinning_pool_t);
+BENCHMARK_TEMPLATE(get_auto_waste_contended, pool_t)->Apply(all_benchmarks);
+BENCHMARK_TEMPLATE(get_auto_waste_contended, magazine_pool_t)->Apply(all_benchmarks);
+BENCHMARK_TEMPLATE(get_auto_waste_contended, spinning_pool_t)->Apply(all_benchmarks);
+BENCHMARK_TEMPLATE(get_timeout, pool_t)->Apply(wait_durations);
+BENCHMARK_TEMPLATE(get_auto_recycle_wait_time, pool_t)->Apply(wait_time_args);
+BENCHMARK_TEMPLATE(get_auto_recycle_wait_time, spinning_pool_t)->Apply(wait_time_args);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,181 @@
+#ifndef YAMAIL_RESOURCE_POOL_ASYNC_CANCELLATION_HPP
+#define YAMAIL_RESOURCE_POOL_ASYNC_CANCELLATION_HPP
+
+#include <boost/asio/associated_allocator.hpp>
+#include <boost/asio/associated_executor.hpp>
+#include <boost/asio/version.hpp>
+
+#if BOOST_ASIO_VERSION >= 102000
+#include <boost/asio/associated_cancellation_slot.hpp>
+#include <boost/asio/cancellation_signal.hpp>
+#endif
+
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+namespace yamail {
+namespace resource_pool {
+namespace async {
+
+class cancellation_slot;
+
+// Emits cancellation of operation connected by slot. Like asio per-operation
+// cancellation, signal is not thread safe: it must outlive the operation and
+// be emitted from associated executor of the handler.
+class cancellation_signal {
+public:
+    cancellation_signal() = default;
+    cancellation_signal(const cancellation_signal&) = delete;
+    cancellation_signal& operator =(const cancellation_signal&) = delete;
+
+    void emit() {
+        if (_handler) {
+            const auto handler = std::exchange(_handler, nullptr);
+            handler();
+        }
+    }
+
+    cancellation_slot slot() noexcept;
+
+private:
+    friend class cancellation_slot;
+
+    std::function<void ()> _handler;
+};
+
+class cancellation_slot {
+public:
+    cancellation_slot() = default;
+
+    bool is_connected() const noexcept { return _signal != nullptr; }
+    bool has_handler() const noexcept { return is_connected() && static_cast<bool>(_signal->_handler); }
+
+    template <class Handler>
+    void assign(Handler&& handler) {
+        if (_signal) {
+            _signal->_handler = std::forward<Handler>(handler);
+        }
+    }
+
+    void clear() noexcept {
+        if (_signal) {
+            _signal->_handler = nullptr;
+        }
+    }
+
+private:
+    friend class cancellation_signal;
+
+    cancellation_signal* _signal = nullptr;
+
+    explicit cancellation_slot(cancellation_signal* signal) noexcept : _signal(signal) {}
+};
+
+inline cancellation_slot cancellation_signal::slot() noexcept {
+    return cancellation_slot(this);
+}
+
+// Handler with associated cancellation slot, executor and allocator are of
+// wrapped handler.
+template <class Handler>
+class cancellation_slot_binder {
+public:
+    using executor_type = boost::asio::associated_executor_t<Handler>;
+    using allocator_type = boost::asio::associated_allocator_t<Handler>;
+
+    template <class HandlerT>
+    cancellation_slot_binder(cancellation_slot slot, HandlerT&& handler)
+        : _slot(slot),
+          _handler(std::forward<HandlerT>(handler)) {}
+
+    template <class ... Args>
+    void operator ()(Args&& ... args) {
+        _handler(std::forward<Args>(args) ...);
+    }
+
+    cancellation_slot get_cancellation_slot() const noexcept { return _slot; }
+
+    executor_type get_executor() const noexcept {
+        return boost::asio::get_associated_executor(_handler);
+    }
+
+    allocator_type get_allocator() const noexcept {
+        return boost::asio::get_associated_allocator(_handler);
+    }
+
+private:
+    cancellation_slot _slot;
+    Handler _handler;
+};
+
+template <class Handler>
+auto bind_cancellation_slot(cancellation_slot slot, Handler&& handler) {
+    return cancellation_slot_binder<std::decay_t<Handler>>(slot, std::forward<Handler>(handler));
+}
+
+namespace detail {
+
+// Slot of this library is connected to queued request. Since Boost.Asio 1.77
+// asio slot is connected too, this library slot remains for older versions.
+// Handler with slot of other type completes without cancellation.
+template <class Slot>
+struct is_cancellation_slot : std::is_same<Slot, cancellation_slot> {};
+
+#if BOOST_ASIO_VERSION >= 102000
+template <>
+struct is_cancellation_slot<boost::asio::cancellation_slot> : std::true_type {};
+#endif
+
+template <class Handler, class = void>
+struct has_member_cancellation_slot : std::false_type {};
+
+template <class Handler>
+struct has_member_cancellation_slot<Handler, std::void_t<decltype(std::declval<const Handler&>().get_cancellation_slot())>>
+    : is_cancellation_slot<std::decay_t<decltype(std::declval<const Handler&>().get_cancellation_slot())>> {};
+
+#if BOOST_ASIO_VERSION >= 102000
+// Every handler has associated asio slot, not connected one by default.
+template <class Handler>
+struct has_cancellation_slot : std::disjunction<
+    has_member_cancellation_slot<Handler>,
+    std::is_same<boost::asio::associated_cancellation_slot_t<Handler>, boost::asio::cancellation_slot>
+> {};
+#else
+template <class Handler>
+struct has_cancellation_slot : has_member_cancellation_slot<Handler> {};
+#endif
+
+template <class Handler>
+constexpr bool has_cancellation_slot_v = has_cancellation_slot<std::decay_t<Handler>>::value;
+
+struct no_cancellation_slot {};
+
+template <class Handler>
+auto get_cancellation_slot(const Handler& handler) noexcept {
+    if constexpr (has_member_cancellation_slot<Handler>::value) {
+        return handler.get_cancellation_slot();
+#if BOOST_ASIO_VERSION >= 102000
+    } else if constexpr (has_cancellation_slot_v<Handler>) {
+        return boost::asio::get_associated_cancellation_slot(handler);
+#endif
+    } else {
+        return no_cancellation_slot {};
+    }
+}
+
+// Disconnects completed operation from the signal.
+template <class Handler>
+void clear_cancellation_slot(const Handler& handler) noexcept {
+    if constexpr (has_cancellation_slot_v<Handler>) {
+        get_cancellation_slot(handler).clear();
+    }
+}
+
+} // namespace detail
+
+} // namespace async
+} // namespace resource_pool
+} // namespace yamail
+
+#endif // YAMAIL_RESOURCE_POOL_ASYNC_CANCELLATION_HPP
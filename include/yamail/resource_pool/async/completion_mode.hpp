@@ -0,0 +1,17 @@
+#ifndef YAMAIL_RESOURCE_POOL_ASYNC_COMPLETION_MODE_HPP
+#define YAMAIL_RESOURCE_POOL_ASYNC_COMPLETION_MODE_HPP
+
+namespace yamail {
+namespace resource_pool {
+namespace async {
+
+enum class completion_mode {
+    post, // always post completion to io_context
+    dispatch, // dispatch completion of immediately leased resource, runs handler inline when called from io_context thread
+};
+
+} // namespace async
+} // namespace resource_pool
+} // namespace yamail
+
+#endif // YAMAIL_RESOURCE_POOL_ASYNC_COMPLETION_MODE_HPP
@@ -0,0 +1,176 @@
+#ifndef YAMAIL_RESOURCE_POOL_ASYNC_DETAIL_DEADLINE_INDEX_HPP
+#define YAMAIL_RESOURCE_POOL_ASYNC_DETAIL_DEADLINE_INDEX_HPP
+
+#include <yamail/resource_pool/time_traits.hpp>
+
+#include <cassert>
+#include <list>
+#include <map>
+
+namespace yamail {
+namespace resource_pool {
+namespace async {
+namespace detail {
+
+// Deadline indexes order queued nodes by expiration time. Node keeps index
+// specific data in member deadline_hook of type Index::hook.
+
+// Keeps nodes in FIFO lists per wait duration. Deadlines of nodes with the same
+// wait duration are ordered by push time because of monotonic clock, so insert
+// and erase take constant time without allocation after first use of each
+// duration. Node inserted again with its earlier deadline is put before later
+// ones in linear time of their number. Earliest lookup takes linear time of
+// distinct durations number.
+template <class Node>
+class fifo_deadline_index {
+    struct bucket;
+
+public:
+    struct hook {
+        time_traits::time_point expires_at;
+        Node* prev = nullptr;
+        Node* next = nullptr;
+        bucket* owner = nullptr;
+    };
+
+    fifo_deadline_index() = default;
+    fifo_deadline_index(const fifo_deadline_index&) = delete;
+    fifo_deadline_index(fifo_deadline_index&&) = delete;
+
+    std::size_t size() const noexcept { return _size; }
+    bool empty() const noexcept { return _size == 0; }
+
+    inline void insert(Node& node, time_traits::time_point expires_at, time_traits::duration wait_duration);
+    inline void erase(Node& node);
+    inline Node& earliest() const;
+
+    static time_traits::time_point expires_at(const Node& node) noexcept { return node.deadline_hook.expires_at; }
+
+private:
+    struct bucket {
+        time_traits::duration wait_duration;
+        Node* head = nullptr;
+        Node* tail = nullptr;
+    };
+
+    using bucket_list = std::list<bucket>;
+
+    bucket_list _buckets;
+    bucket_list _buckets_pool;
+    std::size_t _size = 0;
+
+    inline bucket& get_bucket(time_traits::duration wait_duration);
+};
+
+template <class N>
+void fifo_deadline_index<N>::insert(N& node, time_traits::time_point expires_at, time_traits::duration wait_duration) {
+    auto& owner = get_bucket(wait_duration);
+    N* prev = owner.tail;
+    while (prev && prev->deadline_hook.expires_at > expires_at) {
+        prev = prev->deadline_hook.prev;
+    }
+    N* const next = prev ? prev->deadline_hook.next : owner.head;
+    auto& hook = node.deadline_hook;
+    hook.expires_at = expires_at;
+    hook.prev = prev;
+    hook.next = next;
+    hook.owner = &owner;
+    (prev ? prev->deadline_hook.next : owner.head) = &node;
+    (next ? next->deadline_hook.prev : owner.tail) = &node;
+    ++_size;
+}
+
+template <class N>
+void fifo_deadline_index<N>::erase(N& node) {
+    auto& hook = node.deadline_hook;
+    auto& owner = *hook.owner;
+    if (hook.prev) {
+        hook.prev->deadline_hook.next = hook.next;
+    } else {
+        owner.head = hook.next;
+    }
+    if (hook.next) {
+        hook.next->deadline_hook.prev = hook.prev;
+    } else {
+        owner.tail = hook.prev;
+    }
+    hook = typename fifo_deadline_index<N>::hook {};
+    --_size;
+}
+
+template <class N>
+N& fifo_deadline_index<N>::earliest() const {
+    assert(!empty());
+    N* result = nullptr;
+    for (const auto& v : _buckets) {
+        if (v.head && (!result || v.head->deadline_hook.expires_at < result->deadline_hook.expires_at)) {
+            result = v.head;
+        }
+    }
+    return *result;
+}
+
+template <class N>
+typename fifo_deadline_index<N>::bucket& fifo_deadline_index<N>::get_bucket(time_traits::duration wait_duration) {
+    for (auto it = _buckets.begin(); it != _buckets.end();) {
+        if (it->wait_duration == wait_duration) {
+            return *it;
+        }
+        const auto next = std::next(it);
+        if (!it->head) {
+            _buckets_pool.splice(_buckets_pool.begin(), _buckets, it);
+        }
+        it = next;
+    }
+    if (_buckets_pool.empty()) {
+        _buckets_pool.emplace_back();
+    }
+    _buckets.splice(_buckets.end(), _buckets_pool, _buckets_pool.begin());
+    auto& result = _buckets.back();
+    result.wait_duration = wait_duration;
+    return result;
+}
+
+// Keeps nodes in std::multimap, insert and erase take logarithmic time and
+// allocate tree node. Suitable for arbitrary distinct wait durations.
+template <class Node>
+class multimap_deadline_index {
+    using multimap = std::multimap<time_traits::time_point, Node*>;
+
+public:
+    struct hook {
+        typename multimap::iterator it;
+    };
+
+    multimap_deadline_index() = default;
+    multimap_deadline_index(const multimap_deadline_index&) = delete;
+    multimap_deadline_index(multimap_deadline_index&&) = delete;
+
+    std::size_t size() const noexcept { return _nodes.size(); }
+    bool empty() const noexcept { return _nodes.empty(); }
+
+    void insert(Node& node, time_traits::time_point expires_at, time_traits::duration) {
+        node.deadline_hook.it = _nodes.emplace(expires_at, &node);
+    }
+
+    void erase(Node& node) {
+        _nodes.erase(node.deadline_hook.it);
+    }
+
+    Node& earliest() const {
+        assert(!empty());
+        return *_nodes.begin()->second;
+    }
+
+    static time_traits::time_point expires_at(const Node& node) noexcept { return node.deadline_hook.it->first; }
+
+private:
+    multimap _nodes;
+};
+
+} // namespace detail
+} // namespace async
+} // namespace resource_pool
+} // namespace yamail
+
+#endif // YAMAIL_RESOURCE_POOL_ASYNC_DETAIL_DEADLINE_INDEX_HPP
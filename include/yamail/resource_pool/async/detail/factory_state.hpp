@@ -0,0 +1,198 @@
+#ifndef YAMAIL_RESOURCE_POOL_ASYNC_DETAIL_FACTORY_STATE_HPP
+#define YAMAIL_RESOURCE_POOL_ASYNC_DETAIL_FACTORY_STATE_HPP
+
+#include <yamail/resource_pool/time_traits.hpp>
+#include <yamail/resource_pool/async/detail/queue.hpp>
+
+#include <boost/system/error_code.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace yamail {
+namespace resource_pool {
+namespace async {
+
+struct creation_stats {
+    std::size_t created;
+    std::size_t failed;
+    std::size_t in_flight;
+    std::size_t waiting;
+    time_traits::duration total_latency;
+    time_traits::duration max_latency;
+};
+
+namespace detail {
+
+template <class Handle, class Handler>
+class on_created_handler {
+    boost::system::error_code error;
+    Handle handle;
+    Handler handler;
+
+public:
+    using executor_type = std::decay_t<decltype(asio::get_associated_executor(handler))>;
+
+    template <class HandlerT>
+    on_created_handler(boost::system::error_code error, Handle&& handle, HandlerT&& handler)
+        : error(error),
+          handle(std::move(handle)),
+          handler(std::forward<HandlerT>(handler)) {}
+
+    void operator ()() {
+        handler(error, std::move(handle));
+    }
+
+    auto get_executor() const noexcept {
+        return asio::get_associated_executor(handler);
+    }
+};
+
+// Creates resources for empty handles with at most max_concurrent creations in
+// flight. Handles wait for creation in FIFO order, created resource goes to the
+// longest waiting handle whichever creation has finished first.
+template <class Value, class IoContext, class Handle>
+class factory_state : public std::enable_shared_from_this<factory_state<Value, IoContext, Handle>> {
+public:
+    using value_type = Value;
+    using io_context_t = IoContext;
+    using handle = Handle;
+    using on_create = std::function<void (boost::system::error_code, value_type)>;
+    using create_function = std::function<void (io_context_t&, on_create)>;
+
+    factory_state(create_function create, std::size_t max_concurrent)
+            : _create(std::move(create)),
+              _max_concurrent(std::max<std::size_t>(max_concurrent, 1)) {}
+
+    factory_state(const factory_state&) = delete;
+
+    factory_state(factory_state&&) = delete;
+
+    template <class Handler>
+    void create(io_context_t& io_context, handle&& handle, Handler&& handler);
+
+    creation_stats stats() const;
+
+private:
+    using mutex_t = std::mutex;
+    using lock_guard = std::lock_guard<mutex_t>;
+
+    struct waiter {
+        virtual ~waiter() = default;
+        virtual void complete(boost::system::error_code ec, value_type* value) = 0;
+    };
+
+    template <class Handler>
+    class handler_waiter;
+
+    mutable mutex_t _mutex;
+    const create_function _create;
+    const std::size_t _max_concurrent;
+    std::deque<std::unique_ptr<waiter>> _waiters;
+    std::size_t _in_flight = 0;
+    std::size_t _created = 0;
+    std::size_t _failed = 0;
+    time_traits::duration _total_latency {0};
+    time_traits::duration _max_latency {0};
+
+    bool can_start() const { return _in_flight < _max_concurrent && _in_flight < _waiters.size(); }
+    void start(io_context_t& io_context);
+    void on_created(io_context_t& io_context, time_traits::time_point started, boost::system::error_code ec,
+                    value_type&& value);
+};
+
+template <class V, class I, class H>
+template <class Handler>
+class factory_state<V, I, H>::handler_waiter : public waiter {
+public:
+    template <class HandlerT>
+    handler_waiter(io_context_t& io_context, handle&& handle, HandlerT&& handler)
+        : _io_context(io_context),
+          _handle(std::move(handle)),
+          _handler(std::forward<HandlerT>(handler)) {}
+
+    void complete(boost::system::error_code ec, value_type* value) override {
+        if (ec) {
+            _handle.waste();
+        } else {
+            _handle.reset(std::move(*value));
+        }
+        post_completion(_io_context, on_created_handler<handle, Handler>(ec, std::move(_handle), std::move(_handler)));
+    }
+
+private:
+    io_context_t& _io_context;
+    handle _handle;
+    Handler _handler;
+};
+
+template <class V, class I, class H>
+template <class Handler>
+void factory_state<V, I, H>::create(io_context_t& io_context, handle&& handle, Handler&& handler) {
+    auto waiter = std::make_unique<handler_waiter<std::decay_t<Handler>>>(io_context, std::move(handle),
+                                                                          std::forward<Handler>(handler));
+    bool started = false;
+    {
+        const lock_guard lock(_mutex);
+        _waiters.push_back(std::move(waiter));
+        if (can_start()) {
+            ++_in_flight;
+            started = true;
+        }
+    }
+    if (started) {
+        start(io_context);
+    }
+}
+
+template <class V, class I, class H>
+creation_stats factory_state<V, I, H>::stats() const {
+    const lock_guard lock(_mutex);
+    return creation_stats {_created, _failed, _in_flight, _waiters.size(), _total_latency, _max_latency};
+}
+
+template <class V, class I, class H>
+void factory_state<V, I, H>::start(io_context_t& io_context) {
+    const auto started = time_traits::now();
+    _create(io_context, [self = this->shared_from_this(), io_context = &io_context, started]
+            (boost::system::error_code ec, value_type value) {
+        self->on_created(*io_context, started, ec, std::move(value));
+    });
+}
+
+template <class V, class I, class H>
+void factory_state<V, I, H>::on_created(io_context_t& io_context, time_traits::time_point started,
+                                        boost::system::error_code ec, value_type&& value) {
+    const auto latency = time_traits::now() - started;
+    std::unique_ptr<waiter> served;
+    bool next = false;
+    {
+        const lock_guard lock(_mutex);
+        assert(_in_flight > 0 && !_waiters.empty());
+        --_in_flight;
+        ++(ec ? _failed : _created);
+        _total_latency += latency;
+        _max_latency = std::max(_max_latency, latency);
+        served = std::move(_waiters.front());
+        _waiters.pop_front();
+        if (can_start()) {
+            ++_in_flight;
+            next = true;
+        }
+    }
+    served->complete(ec, ec ? nullptr : std::addressof(value));
+    if (next) {
+        start(io_context);
+    }
+}
+
+} // namespace detail
+} // namespace async
+} // namespace resource_pool
+} // namespace yamail
+
+#endif // YAMAIL_RESOURCE_POOL_ASYNC_DETAIL_FACTORY_STATE_HPP
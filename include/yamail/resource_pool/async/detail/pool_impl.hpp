@@ -1,9 +1,12 @@
 #ifndef YAMAIL_RESOURCE_POOL_ASYNC_DETAIL_POOL_IMPL_HPP
 #define YAMAIL_RESOURCE_POOL_ASYNC_DETAIL_POOL_IMPL_HPP
 
+#include <yamail/resource_pool/batch_mode.hpp>
 #include <yamail/resource_pool/error.hpp>
+#include <yamail/resource_pool/lease_order.hpp>
 #include <yamail/resource_pool/detail/idle.hpp>
 #include <yamail/resource_pool/detail/storage.hpp>
+#include <yamail/resource_pool/detail/cell_ring.hpp>
 #include <yamail/resource_pool/detail/pool_returns.hpp>
 #include <yamail/resource_pool/async/detail/queue.hpp>
 
@@ -11,8 +14,13 @@
 #include <boost/asio/post.hpp>
 #include <boost/asio/spawn.hpp>
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <memory>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace yamail {
 namespace resource_pool {
@@ -30,15 +38,36 @@ namespace detail {
 namespace asio = boost::asio;
 
 using resource_pool::detail::cell_iterator;
-using resource_pool::detail::cell_value;
+using resource_pool::detail::cell_ring;
+using resource_pool::detail::no_cell_cache;
 using resource_pool::detail::pool_returns;
 
-template <class T, class Handler>
+// Returns leased cell to owner keeping its value when there is one.
+template <class Owner, class ListIterator>
+void return_leased(Owner& owner, ListIterator cell) {
+    if (cell->value) {
+        owner.recycle(cell);
+    } else {
+        owner.waste(cell);
+    }
+}
+
+template <class Owner, class ListIterator>
+void return_leased(Owner& owner, const std::vector<ListIterator>& cells) {
+    for (const auto cell : cells) {
+        return_leased(owner, cell);
+    }
+}
+
+// Handler with owner holds leased cells until it is called, cells of handler
+// destroyed without call, e.g. with not run io_context, are returned to owner.
+template <class ListIterator, class Handler, class Owner = void>
 class on_list_iterator_handler {
-    static_assert(std::is_invocable_v<Handler, boost::system::error_code, cell_iterator<T>>);
+    static_assert(std::is_invocable_v<Handler, boost::system::error_code, ListIterator>);
 
     boost::system::error_code error;
-    cell_iterator<T> list_iterator;
+    ListIterator list_iterator;
+    Owner* owner = nullptr;
     Handler handler;
 
 public:
@@ -47,14 +76,39 @@ public:
     on_list_iterator_handler() = default;
 
     template <class HandlerT>
-    on_list_iterator_handler(boost::system::error_code error, cell_iterator<T> list_iterator, HandlerT&& handler)
+    on_list_iterator_handler(boost::system::error_code error, ListIterator list_iterator, HandlerT&& handler)
         : error(error),
           list_iterator(list_iterator),
           handler(std::forward<HandlerT>(handler)) {}
 
+    template <class HandlerT>
+    on_list_iterator_handler(boost::system::error_code error, ListIterator list_iterator, Owner* owner,
+                             HandlerT&& handler)
+        : error(error),
+          list_iterator(std::move(list_iterator)),
+          owner(owner),
+          handler(std::forward<HandlerT>(handler)) {}
+
+    on_list_iterator_handler(on_list_iterator_handler&& other)
+        : error(other.error),
+          list_iterator(std::move(other.list_iterator)),
+          owner(std::exchange(other.owner, nullptr)),
+          handler(std::move(other.handler)) {}
+
+    on_list_iterator_handler& operator =(on_list_iterator_handler&&) = delete;
+
+    ~on_list_iterator_handler() {
+        if constexpr (!std::is_void_v<Owner>) {
+            if (owner) {
+                return_leased(*owner, list_iterator);
+            }
+        }
+    }
+
     template <class ... Args>
     void operator ()() {
-        return handler(error, list_iterator);
+        owner = nullptr;
+        return handler(error, std::move(list_iterator));
     }
 
     auto get_executor() const noexcept {
@@ -64,67 +118,174 @@ public:
 
 template <class ListIterator, class Handler>
 on_list_iterator_handler(boost::system::error_code, ListIterator, Handler&&)
-    -> on_list_iterator_handler<cell_value<ListIterator>, std::decay_t<Handler>>;
+    -> on_list_iterator_handler<ListIterator, std::decay_t<Handler>>;
 
-template <class T>
-struct base_list_iterator_handler_impl {
-    virtual void operator ()(boost::system::error_code ec, cell_iterator<T> iterator) = 0;
-    virtual ~base_list_iterator_handler_impl() = default;
-};
+template <class ListIterator, class Owner, class Handler>
+on_list_iterator_handler(boost::system::error_code, ListIterator, Owner*, Handler&&)
+    -> on_list_iterator_handler<ListIterator, std::decay_t<Handler>, Owner>;
 
-template <class T, class Handler>
-class list_iterator_handler_impl final : public base_list_iterator_handler_impl<T> {
-    static_assert(std::is_invocable_v<Handler, boost::system::error_code, cell_iterator<T>>);
+// Inline storage size of list_iterator_handler, enough for yield_context completion handler
+// wrapped by pool.
+constexpr std::size_t list_iterator_handler_buffer_size = 160;
+
+template <class ListIterator, class Owner, class Handler>
+struct list_iterator_handler_ops {
+    static_assert(std::is_invocable_v<Handler, boost::system::error_code, ListIterator>);
+
+    using allocator_type = typename std::allocator_traits<
+        std::decay_t<decltype(asio::get_associated_allocator(std::declval<const Handler&>()))>
+    >::template rebind_alloc<Handler>;
+    using allocator_traits = std::allocator_traits<allocator_type>;
+
+    static constexpr bool is_inline = sizeof(Handler) <= list_iterator_handler_buffer_size
+        && alignof(Handler) <= alignof(std::max_align_t);
+
+    static Handler& get(void* storage) noexcept {
+        if constexpr (is_inline) {
+            return *static_cast<Handler*>(storage);
+        } else {
+            return **static_cast<Handler**>(storage);
+        }
+    }
 
-public:
     template <class HandlerT>
-    list_iterator_handler_impl(HandlerT&& handler,
-            std::enable_if_t<!std::is_same_v<std::decay_t<HandlerT>, list_iterator_handler_impl>, void*> = nullptr)
-            : handler(std::forward<HandlerT>(handler)) {
-        static_assert(std::is_same_v<std::decay_t<HandlerT>, Handler>, "HandlerT is not Handler");
+    static void create(void* storage, HandlerT&& handler) {
+        if constexpr (is_inline) {
+            new (storage) Handler(std::forward<HandlerT>(handler));
+        } else {
+            allocator_type allocator(asio::get_associated_allocator(handler));
+            const auto ptr = allocator_traits::allocate(allocator, 1);
+            try {
+                allocator_traits::construct(allocator, std::addressof(*ptr), std::forward<HandlerT>(handler));
+            } catch (...) {
+                allocator_traits::deallocate(allocator, ptr, 1);
+                throw;
+            }
+            *static_cast<Handler**>(storage) = std::addressof(*ptr);
+        }
     }
 
-    void operator ()(boost::system::error_code ec, cell_iterator<T> iterator) final {
-        handler(ec, iterator);
+    // Handler accepting owner is told which pool serves the request.
+    static void call(void* storage, boost::system::error_code ec, ListIterator iterator, Owner* owner) {
+        if constexpr (std::is_invocable_v<Handler&, boost::system::error_code, ListIterator, Owner*>) {
+            get(storage)(ec, iterator, owner);
+        } else {
+            get(storage)(ec, iterator);
+        }
     }
 
-private:
-    Handler handler;
+    static void move(void* dst, void* src) {
+        if constexpr (is_inline) {
+            new (dst) Handler(std::move(get(src)));
+            destroy(src);
+        } else {
+            *static_cast<Handler**>(dst) = *static_cast<Handler**>(src);
+        }
+    }
+
+    static void destroy(void* storage) noexcept {
+        if constexpr (is_inline) {
+            get(storage).~Handler();
+        } else {
+            const auto ptr = *static_cast<Handler**>(storage);
+            allocator_type allocator(asio::get_associated_allocator(*ptr));
+            allocator_traits::destroy(allocator, ptr);
+            allocator_traits::deallocate(allocator, ptr, 1);
+        }
+    }
+
+    static asio::executor executor(const void* storage) {
+        return asio::get_associated_executor(get(const_cast<void*>(storage)));
+    }
+};
+
+template <class ListIterator, class Owner>
+struct list_iterator_handler_vtable {
+    void (*call)(void* storage, boost::system::error_code ec, ListIterator iterator, Owner* owner);
+    void (*move)(void* dst, void* src);
+    void (*destroy)(void* storage) noexcept;
+    asio::executor (*executor)(const void* storage);
+};
+
+template <class ListIterator, class Owner, class Handler>
+constexpr list_iterator_handler_vtable<ListIterator, Owner> list_iterator_handler_vtable_instance {
+    &list_iterator_handler_ops<ListIterator, Owner, Handler>::call,
+    &list_iterator_handler_ops<ListIterator, Owner, Handler>::move,
+    &list_iterator_handler_ops<ListIterator, Owner, Handler>::destroy,
+    &list_iterator_handler_ops<ListIterator, Owner, Handler>::executor,
 };
 
-template <class T>
+// Type erased queued request handler. Handler is stored inline if it fits into
+// list_iterator_handler_buffer_size, otherwise it is allocated with associated allocator.
+template <class T, class ListIterator = cell_iterator<T>>
 class list_iterator_handler {
 public:
     using executor_type = asio::executor;
+    using owner_type = pool_returns<T, ListIterator>;
 
     list_iterator_handler() = default;
 
     template <class Handler>
     list_iterator_handler(Handler&& handler,
             std::enable_if_t<!std::is_same_v<std::decay_t<Handler>, list_iterator_handler>, void*> = nullptr)
-            : executor(asio::get_associated_executor(handler)),
-              impl(std::make_unique<list_iterator_handler_impl<T, std::decay_t<Handler>>>(std::forward<Handler>(handler))) {
+            : vtable(&list_iterator_handler_vtable_instance<ListIterator, owner_type, std::decay_t<Handler>>) {
+        list_iterator_handler_ops<ListIterator, owner_type, std::decay_t<Handler>>::create(&buffer,
+            std::forward<Handler>(handler));
+    }
+
+    list_iterator_handler(list_iterator_handler&& other)
+            : vtable(other.vtable) {
+        if (vtable) {
+            vtable->move(&buffer, &other.buffer);
+            other.vtable = nullptr;
+        }
+    }
+
+    list_iterator_handler& operator =(list_iterator_handler&& other) {
+        if (this != &other) {
+            reset();
+            if (other.vtable) {
+                other.vtable->move(&buffer, &other.buffer);
+                vtable = std::exchange(other.vtable, nullptr);
+            }
+        }
+        return *this;
+    }
+
+    ~list_iterator_handler() {
+        reset();
+    }
+
+    void operator ()(boost::system::error_code ec, ListIterator iterator) {
+        vtable->call(&buffer, ec, iterator, nullptr);
     }
 
-    void operator ()(boost::system::error_code ec, cell_iterator<T> iterator) {
-        (*impl)(ec, iterator);
+    void operator ()(boost::system::error_code ec, ListIterator iterator, owner_type* owner) {
+        vtable->call(&buffer, ec, iterator, owner);
     }
 
     void operator ()(boost::system::error_code ec) {
-        (*impl)(ec, cell_iterator<T>());
+        vtable->call(&buffer, ec, ListIterator(), nullptr);
     }
 
-    void operator ()(cell_iterator<T> iterator) {
-        (*impl)(boost::system::error_code(), iterator);
+    void operator ()(ListIterator iterator) {
+        vtable->call(&buffer, boost::system::error_code(), iterator, nullptr);
     }
 
-    auto get_executor() const noexcept {
-        return executor;
+    executor_type get_executor() const noexcept {
+        return vtable ? vtable->executor(&buffer) : executor_type();
     }
 
 private:
-    asio::executor executor;
-    std::unique_ptr<base_list_iterator_handler_impl<T>> impl;
+    const list_iterator_handler_vtable<ListIterator, owner_type>* vtable = nullptr;
+    alignas(std::max_align_t) unsigned char buffer[list_iterator_handler_buffer_size];
+
+    void reset() noexcept {
+        if (vtable) {
+            vtable->destroy(&buffer);
+            vtable = nullptr;
+        }
+    }
 };
 
 template <class Handler>
@@ -156,53 +317,189 @@ public:
 template <class Handler>
 on_error_handler(boost::system::error_code, Handler&&) -> on_error_handler<std::decay_t<Handler>>;
 
-template <class T, class Handler>
+// Holds served cell until it is called, cell of handler destroyed without call
+// is returned to owner.
+template <class ListIterator, class Owner, class Handler>
 class on_serve_queued_handler {
-    static_assert(std::is_invocable_v<Handler, cell_iterator<T>>);
+    static_assert(std::is_invocable_v<Handler, boost::system::error_code, ListIterator, Owner*>);
 
-    cell_iterator<T> list_iterator;
+    ListIterator list_iterator;
+    Owner* owner;
     Handler handler;
 
 public:
     using executor_type = std::decay_t<decltype(asio::get_associated_executor(handler))>;
 
     template <class HandlerT>
-    on_serve_queued_handler(cell_iterator<T> list_iterator, HandlerT&& handler)
+    on_serve_queued_handler(ListIterator list_iterator, Owner* owner, HandlerT&& handler)
             : list_iterator(list_iterator),
+              owner(owner),
               handler(std::forward<HandlerT>(handler)) {
         static_assert(std::is_same_v<std::decay_t<HandlerT>, Handler>, "HandlerT is not Handler");
     }
 
+    on_serve_queued_handler(on_serve_queued_handler&& other)
+            : list_iterator(other.list_iterator),
+              owner(std::exchange(other.owner, nullptr)),
+              handler(std::move(other.handler)) {}
+
+    on_serve_queued_handler& operator =(on_serve_queued_handler&& other) {
+        if (this != &other) {
+            release();
+            list_iterator = other.list_iterator;
+            owner = std::exchange(other.owner, nullptr);
+            handler = std::move(other.handler);
+        }
+        return *this;
+    }
+
+    ~on_serve_queued_handler() {
+        release();
+    }
+
     void operator ()() {
-        return handler(list_iterator);
+        return handler(boost::system::error_code(), list_iterator, std::exchange(owner, nullptr));
     }
 
     auto get_executor() const noexcept {
         return asio::get_associated_executor(handler);
     }
+
+private:
+    void release() {
+        if (owner) {
+            return_leased(*std::exchange(owner, nullptr), list_iterator);
+        }
+    }
 };
 
-template <class ListIterator, class Handler>
-on_serve_queued_handler(ListIterator, Handler&&)
-    -> on_serve_queued_handler<cell_value<ListIterator>, std::decay_t<Handler>>;
+template <class ListIterator, class Owner, class Handler>
+on_serve_queued_handler(ListIterator, Owner*, Handler&&)
+    -> on_serve_queued_handler<ListIterator, Owner, std::decay_t<Handler>>;
+
+// Serves several queued requests of one executor without associated executor
+// of handler by single posted handler.
+template <class Executor, class Handler>
+class on_serve_queued_batch_handler {
+    std::vector<std::pair<Executor, Handler>> handlers;
+
+public:
+    explicit on_serve_queued_batch_handler(std::vector<std::pair<Executor, Handler>>&& handlers)
+            : handlers(std::move(handlers)) {}
+
+    void operator ()() {
+        for (auto& handler : handlers) {
+            asio::dispatch(std::move(handler.second));
+        }
+    }
+};
+
+// Decrements number of waiters when request is completed or destroyed.
+template <class Handler>
+class counted_waiter_handler {
+    std::shared_ptr<std::atomic<std::size_t>> waiters;
+    Handler handler;
+
+public:
+    using executor_type = std::decay_t<decltype(asio::get_associated_executor(handler))>;
 
-template <class Value, class Mutex, class IoContext, class Queue>
-class pool_impl : public pool_returns<Value> {
+    template <class HandlerT>
+    counted_waiter_handler(std::shared_ptr<std::atomic<std::size_t>> waiters, HandlerT&& handler)
+            : waiters(std::move(waiters)),
+              handler(std::forward<HandlerT>(handler)) {
+        static_assert(std::is_same_v<std::decay_t<HandlerT>, Handler>, "HandlerT is not Handler");
+    }
+
+    counted_waiter_handler(counted_waiter_handler&&) = default;
+
+    counted_waiter_handler& operator =(counted_waiter_handler&&) = delete;
+
+    ~counted_waiter_handler() {
+        release();
+    }
+
+    template <class ListIterator>
+    void operator ()(boost::system::error_code ec, ListIterator iterator) {
+        release();
+        handler(ec, iterator);
+    }
+
+    template <class ListIterator, class Owner>
+    auto operator ()(boost::system::error_code ec, ListIterator iterator, Owner* owner)
+            -> decltype(std::declval<Handler&>()(ec, iterator, owner)) {
+        release();
+        handler(ec, iterator, owner);
+    }
+
+    auto get_executor() const noexcept {
+        return asio::get_associated_executor(handler);
+    }
+
+private:
+    void release() noexcept {
+        if (waiters) {
+            waiters->fetch_sub(1);
+            waiters.reset();
+        }
+    }
+};
+
+template <class Handler>
+counted_waiter_handler(std::shared_ptr<std::atomic<std::size_t>>, Handler&&)
+    -> counted_waiter_handler<std::decay_t<Handler>>;
+
+template <class Value,
+          class Mutex,
+          class IoContext,
+          class Queue,
+          class Storage = resource_pool::detail::storage<Value>,
+          template <class> class CellCache = no_cell_cache>
+class pool_impl : public pool_returns<Value, typename Storage::cell_iterator>,
+                  public std::enable_shared_from_this<pool_impl<Value, Mutex, IoContext, Queue, Storage, CellCache>> {
 public:
     using value_type = Value;
     using io_context_t = IoContext;
     using idle = resource_pool::detail::idle<value_type>;
-    using storage_type = resource_pool::detail::storage<value_type>;
+    using storage_type = Storage;
     using list_iterator = typename storage_type::cell_iterator;
     using queue_type = Queue;
+    using executor_type = typename queue_type::executor_type;
+    using cell_cache_type = CellCache<list_iterator>;
+
+    // Request queue with number of waiters shared by several pool implementations,
+    // request queued into one of them is served by a cell returned into any.
+    // Queued requests are told which pool serves them, batch requests are not
+    // supported.
+    struct shared_queue {
+        std::shared_ptr<queue_type> queue;
+        std::shared_ptr<std::atomic<std::size_t>> waiters;
+
+        explicit shared_queue(std::size_t queue_capacity)
+            : queue(std::make_shared<queue_type>(queue_capacity)),
+              waiters(std::make_shared<std::atomic<std::size_t>>(0)) {}
+    };
 
     pool_impl(std::size_t capacity,
               std::size_t queue_capacity,
               time_traits::duration idle_timeout,
-              time_traits::duration lifespan)
-            : storage_(assert_capacity(capacity), idle_timeout, lifespan),
+              time_traits::duration lifespan,
+              lease_order order = lease_order::fifo)
+            : pool_impl(capacity, shared_queue(queue_capacity), idle_timeout, lifespan, order) {
+    }
+
+    pool_impl(std::size_t capacity,
+              const shared_queue& queue,
+              time_traits::duration idle_timeout,
+              time_traits::duration lifespan,
+              lease_order order = lease_order::fifo)
+            : storage_(assert_capacity(capacity), idle_timeout, lifespan, order),
               _capacity(capacity),
-              _callbacks(std::make_shared<queue_type>(queue_capacity)) {
+              _idle_timeout(idle_timeout),
+              _lifespan(lifespan),
+              _callbacks(queue.queue),
+              _cache(capacity),
+              _waiters(queue.waiters),
+              _free(capacity) {
     }
 
     template <class Generator>
@@ -210,22 +507,41 @@ public:
               std::size_t capacity,
               std::size_t queue_capacity,
               time_traits::duration idle_timeout,
-              time_traits::duration lifespan)
-            : storage_(std::forward<Generator>(gen_value), assert_capacity(capacity), idle_timeout, lifespan),
+              time_traits::duration lifespan,
+              lease_order order = lease_order::fifo)
+            : pool_impl(std::forward<Generator>(gen_value), capacity, shared_queue(queue_capacity),
+                        idle_timeout, lifespan, order) {
+    }
+
+    template <class Generator>
+    pool_impl(Generator&& gen_value,
+              std::size_t capacity,
+              const shared_queue& queue,
+              time_traits::duration idle_timeout,
+              time_traits::duration lifespan,
+              lease_order order = lease_order::fifo)
+            : storage_(std::forward<Generator>(gen_value), assert_capacity(capacity), idle_timeout, lifespan, order),
               _capacity(assert_capacity(capacity)),
-              _callbacks(std::make_shared<queue_type>(queue_capacity)) {
+              _idle_timeout(idle_timeout),
+              _lifespan(lifespan),
+              _callbacks(queue.queue),
+              _cache(capacity),
+              _waiters(queue.waiters),
+              _free(capacity) {
     }
 
     template <class Iter>
     pool_impl(Iter first, Iter last,
               std::size_t queue_capacity,
               time_traits::duration idle_timeout,
-              time_traits::duration lifespan)
+              time_traits::duration lifespan,
+              lease_order order = lease_order::fifo)
             : pool_impl([&]{ return std::move(*first++); },
                     static_cast<std::size_t>(std::distance(first, last)),
                     queue_capacity,
                     idle_timeout,
-                    lifespan) {
+                    lifespan,
+                    order) {
     }
 
     pool_impl(const pool_impl&) = delete;
@@ -233,6 +549,9 @@ public:
     pool_impl(pool_impl&&) = delete;
 
     std::size_t capacity() const noexcept { return _capacity; }
+    // Number of not leased cells read without lock, it is increased before
+    // returned cell serves queued request.
+    std::size_t free_cells() const noexcept { return _free.load(); }
     std::size_t size() const noexcept;
     std::size_t available() const noexcept;
     std::size_t used() const noexcept;
@@ -240,12 +559,25 @@ public:
 
     const queue_type& queue() const noexcept { return *_callbacks; }
 
-    template <class Handler>
-    void get(io_context_t& io_context, Handler&& handler, time_traits::duration wait_duration = time_traits::duration(0));
+    // Context is io_context or executor completing handler without associated
+    // executor and running timer of queued request.
+    template <class Context, class Handler>
+    void get(Context& context, Handler&& handler, time_traits::duration wait_duration = time_traits::duration(0));
+    template <class Context, class Handler>
+    void get_many(Context& context, std::size_t count, Handler&& handler,
+                  time_traits::duration wait_duration = time_traits::duration(0),
+                  batch_mode mode = batch_mode::all);
+    boost::optional<list_iterator> try_lease() { return try_lease(false); }
+    boost::optional<list_iterator> try_lease_available() { return try_lease(true); }
+    boost::optional<list_iterator> try_lease_empty(std::size_t min_available);
+    void serve_queued();
     void recycle(list_iterator res_it) final;
     void waste(list_iterator res_it) final;
+    void recycle_many(const std::vector<list_iterator>& cells);
+    void waste_many(const std::vector<list_iterator>& cells);
     void disable();
     void invalidate();
+    void drop_expired();
 
     static std::size_t assert_capacity(std::size_t value);
 
@@ -253,16 +585,96 @@ private:
     using mutex_t = Mutex;
     using unique_lock = std::unique_lock<mutex_t>;
     using lock_guard = std::lock_guard<mutex_t>;
+    using cache_entry = typename cell_ring<list_iterator>::entry;
 
     mutable mutex_t _mutex;
     storage_type storage_;
     const std::size_t _capacity;
+    const time_traits::duration _idle_timeout;
+    const time_traits::duration _lifespan;
     std::shared_ptr<queue_type> _callbacks;
-    bool _disabled = false;
+    std::atomic<bool> _disabled {false};
+    cell_cache_type _cache;
+    std::atomic<std::uint64_t> _generation {0};
+    const std::shared_ptr<std::atomic<std::size_t>> _waiters;
+    std::atomic<std::size_t> _free;
+    std::shared_ptr<pool_impl> _self;
+
+    template <class Handler>
+    struct batch_state {
+        executor_type executor;
+        std::size_t count;
+        batch_mode mode;
+        time_traits::duration wait_duration;
+        time_traits::time_point expires_at;
+        std::vector<list_iterator> cells;
+        Handler handler;
+        std::shared_ptr<std::atomic<std::size_t>> waiters;
+
+        ~batch_state() {
+            release_waiter();
+        }
+
+        void release_waiter() noexcept {
+            if (waiters) {
+                waiters->fetch_sub(1);
+                waiters.reset();
+            }
+        }
+    };
+
+    // Queued batch request, queue serves it by one cell at a time. Queued batch
+    // holds no cells, so pool may be destroyed before it is completed.
+    template <class Handler>
+    class batch_request {
+        std::weak_ptr<pool_impl> impl;
+        std::shared_ptr<batch_state<Handler>> state;
+
+    public:
+        using executor_type = std::decay_t<decltype(asio::get_associated_executor(std::declval<const Handler&>()))>;
+
+        batch_request(std::weak_ptr<pool_impl> impl, std::shared_ptr<batch_state<Handler>> state)
+            : impl(std::move(impl)), state(std::move(state)) {}
+
+        void operator ()(boost::system::error_code ec, list_iterator cell);
+
+        auto get_executor() const noexcept {
+            return asio::get_associated_executor(state->handler);
+        }
+    };
+
+    template <class Context, class Handler>
+    void get_locked(Context& context, Handler&& handler, time_traits::duration wait_duration);
+    template <class Context, class Handler>
+    void get_cached(Context& context, Handler&& handler, time_traits::duration wait_duration);
+    template <class Context, class Slot>
+    bool push_request(Context& context, time_traits::duration wait_duration,
+                      typename queue_type::value_type& wrapped, const Slot& slot);
+    using serve_handler = on_serve_queued_handler<list_iterator, pool_returns<Value, list_iterator>,
+                                                  typename queue_type::value_type>;
+
+    boost::optional<list_iterator> try_lease(bool available_only);
+    void recycle_locked(list_iterator res_it);
+    void return_many(const std::vector<list_iterator>& cells, bool recycle);
+    static void serve_many(std::vector<std::pair<executor_type, serve_handler>>& served);
+    bool try_recycle_cached(list_iterator res_it);
+    boost::optional<list_iterator> lease_cached();
+    boost::optional<list_iterator> lease_cached(std::vector<value_type>& dropped);
+    boost::optional<list_iterator> lease_locked(std::vector<value_type>& dropped);
+    template <class Handler>
+    boost::optional<boost::system::error_code> lease_batch(const std::shared_ptr<batch_state<Handler>>& state,
+                                                           bool served);
+    template <class Handler>
+    static boost::system::error_code finish_batch(pool_impl* impl, batch_state<Handler>& state,
+                                                  boost::system::error_code ec);
+    void drain_cache(std::vector<value_type>& dropped);
+    std::size_t cached() const noexcept;
+    std::shared_ptr<pool_impl> keep_alive() const;
+    std::shared_ptr<pool_impl> release_if_unused();
 };
 
-template <class V, class M, class I, class Q>
-std::size_t pool_impl<V, M, I, Q>::size() const noexcept {
+template <class V, class M, class I, class Q, class S, template <class> class C>
+std::size_t pool_impl<V, M, I, Q, S, C>::size() const noexcept {
     const auto stats = [&] {
         const lock_guard lock(_mutex);
         return storage_.stats();
@@ -270,23 +682,27 @@ std::size_t pool_impl<V, M, I, Q>::size() const noexcept {
     return stats.available + stats.used;
 }
 
-template <class V, class M, class I, class Q>
-std::size_t pool_impl<V, M, I, Q>::available() const noexcept {
+template <class V, class M, class I, class Q, class S, template <class> class C>
+std::size_t pool_impl<V, M, I, Q, S, C>::available() const noexcept {
     const lock_guard lock(_mutex);
-    return storage_.stats().available;
+    return storage_.stats().available + cached();
 }
 
-template <class V, class M, class I, class Q>
-std::size_t pool_impl<V, M, I, Q>::used() const noexcept {
+template <class V, class M, class I, class Q, class S, template <class> class C>
+std::size_t pool_impl<V, M, I, Q, S, C>::used() const noexcept {
     const lock_guard lock(_mutex);
-    return storage_.stats().used;
+    return storage_.stats().used - cached();
 }
 
-template <class V, class M, class I, class Q>
-async::stats pool_impl<V, M, I, Q>::stats() const noexcept {
+template <class V, class M, class I, class Q, class S, template <class> class C>
+async::stats pool_impl<V, M, I, Q, S, C>::stats() const noexcept {
     const auto stats = [&] {
         const lock_guard lock(_mutex);
-        return storage_.stats();
+        auto result = storage_.stats();
+        const auto cached = this->cached();
+        result.available += cached;
+        result.used -= cached;
+        return result;
     } ();
     async::stats result;
     result.size = stats.available + stats.used;
@@ -296,44 +712,188 @@ async::stats pool_impl<V, M, I, Q>::stats() const noexcept {
     return result;
 }
 
-template <class V, class M, class I, class Q>
-void pool_impl<V, M, I, Q>::recycle(list_iterator res_it) {
+template <class V, class M, class I, class Q, class S, template <class> class C>
+void pool_impl<V, M, I, Q, S, C>::recycle(list_iterator res_it) {
+    if constexpr (cell_cache_type::enabled) {
+        if (try_recycle_cached(res_it)) {
+            return;
+        }
+    }
+    recycle_locked(res_it);
+}
+
+template <class V, class M, class I, class Q, class S, template <class> class C>
+void pool_impl<V, M, I, Q, S, C>::recycle_locked(list_iterator res_it) {
+    std::shared_ptr<pool_impl> self;
+    std::vector<value_type> dropped;
     unique_lock lock(_mutex);
+    ++_free;
     auto queued = _callbacks->pop();
     if (!queued) {
-        storage_.recycle(res_it);
+        storage_.recycle(res_it, dropped);
+        self = release_if_unused();
         return;
     }
+    --_free;
     const auto valid = storage_.is_valid(res_it);
+    res_it->generation = _generation;
     lock.unlock();
     if (!valid) {
         res_it->value.reset();
     }
-    asio::post(queued->io_context, on_serve_queued_handler(res_it, std::move(queued->request)));
+    post_completion(queued->executor, serve_handler(res_it, this, std::move(queued->request)));
 }
 
-template <class V, class M, class I, class Q>
-void pool_impl<V, M, I, Q>::waste(list_iterator res_it) {
+template <class V, class M, class I, class Q, class S, template <class> class C>
+void pool_impl<V, M, I, Q, S, C>::waste(list_iterator res_it) {
+    std::shared_ptr<pool_impl> self;
+    boost::optional<value_type> value;
+    value.swap(res_it->value);
+    std::vector<value_type> dropped;
     unique_lock lock(_mutex);
+    ++_free;
     auto queued = _callbacks->pop();
     if (!queued) {
-        storage_.waste(res_it);
+        storage_.waste(res_it, dropped);
+        self = release_if_unused();
         return;
     }
+    --_free;
+    res_it->generation = _generation;
     lock.unlock();
-    res_it->value.reset();
-    asio::post(queued->io_context, on_serve_queued_handler(res_it, std::move(queued->request)));
+    post_completion(queued->executor, serve_handler(res_it, this, std::move(queued->request)));
 }
 
-template <class V, class M, class I, class Q>
-template <class Handler>
-void pool_impl<V, M, I, Q>::get(io_context_t& io_context, Handler&& handler, time_traits::duration wait_duration) {
+template <class V, class M, class I, class Q, class S, template <class> class C>
+void pool_impl<V, M, I, Q, S, C>::recycle_many(const std::vector<list_iterator>& cells) {
+    if constexpr (cell_cache_type::enabled) {
+        std::vector<list_iterator> rest;
+        for (const auto cell : cells) {
+            if (!try_recycle_cached(cell)) {
+                rest.push_back(cell);
+            }
+        }
+        return_many(rest, true);
+    } else {
+        return_many(cells, true);
+    }
+}
+
+template <class V, class M, class I, class Q, class S, template <class> class C>
+void pool_impl<V, M, I, Q, S, C>::waste_many(const std::vector<list_iterator>& cells) {
+    return_many(cells, false);
+}
+
+// Returns cells under single lock serving as many queued requests as there are
+// cells, values are destroyed after unlock.
+template <class V, class M, class I, class Q, class S, template <class> class C>
+void pool_impl<V, M, I, Q, S, C>::return_many(const std::vector<list_iterator>& cells, bool recycle) {
+    if (cells.empty()) {
+        return;
+    }
+    std::shared_ptr<pool_impl> self;
+    std::vector<value_type> dropped;
+    if (!recycle) {
+        for (const auto cell : cells) {
+            if (cell->value) {
+                dropped.push_back(std::move(*cell->value));
+                cell->value.reset();
+            }
+        }
+    }
+    std::vector<list_iterator> invalid;
+    std::vector<std::pair<executor_type, serve_handler>> served;
+    served.reserve(cells.size());
+    unique_lock lock(_mutex);
+    _free += cells.size();
+    bool has_queued = true;
+    for (const auto cell : cells) {
+        auto queued = has_queued ? _callbacks->pop() : boost::none;
+        if (!queued) {
+            has_queued = false;
+            if (recycle) {
+                storage_.recycle(cell, dropped);
+            } else {
+                storage_.waste(cell, dropped);
+            }
+            continue;
+        }
+        if (recycle && !storage_.is_valid(cell)) {
+            invalid.push_back(cell);
+        }
+        cell->generation = _generation;
+        served.emplace_back(queued->executor, serve_handler(cell, this, std::move(queued->request)));
+    }
+    _free -= served.size();
+    self = release_if_unused();
+    lock.unlock();
+    for (const auto cell : invalid) {
+        cell->value.reset();
+    }
+    serve_many(served);
+}
+
+// Posts single handler per executor of queued requests, handlers with associated
+// executor are posted to it one by one.
+template <class V, class M, class I, class Q, class S, template <class> class C>
+void pool_impl<V, M, I, Q, S, C>::serve_many(std::vector<std::pair<executor_type, serve_handler>>& served) {
+    using batch_handler = on_serve_queued_batch_handler<executor_type, serve_handler>;
+    auto unbound = served.begin();
+    for (auto& v : served) {
+        if (has_associated_executor(v.second)) {
+            post_completion(v.first, std::move(v.second));
+        } else if (&*unbound++ != &v) {
+            *std::prev(unbound) = std::move(v);
+        }
+    }
+    served.erase(unbound, served.end());
+    if (served.empty()) {
+        return;
+    }
+    if (served.size() == 1) {
+        post_completion(served.front().first, std::move(served.front().second));
+        return;
+    }
+    const auto executor = served.front().first;
+    const auto same_executor = std::all_of(served.begin(), served.end(),
+        [&] (const auto& v) { return v.first == executor; });
+    if (same_executor) {
+        asio::post(executor, batch_handler(std::move(served)));
+        return;
+    }
+    std::vector<std::pair<executor_type, std::vector<std::pair<executor_type, serve_handler>>>> groups;
+    for (auto& v : served) {
+        auto group = std::find_if(groups.begin(), groups.end(), [&] (const auto& g) { return g.first == v.first; });
+        if (group == groups.end()) {
+            group = groups.emplace(groups.end(), v.first, std::vector<std::pair<executor_type, serve_handler>>());
+        }
+        group->second.push_back(std::move(v));
+    }
+    for (auto& group : groups) {
+        asio::post(group.first, batch_handler(std::move(group.second)));
+    }
+}
+
+template <class V, class M, class I, class Q, class S, template <class> class C>
+template <class Context, class Handler>
+void pool_impl<V, M, I, Q, S, C>::get(Context& context, Handler&& handler, time_traits::duration wait_duration) {
     static_assert(std::is_invocable_v<std::decay_t<Handler>, boost::system::error_code, list_iterator>);
 
+    if constexpr (cell_cache_type::enabled) {
+        get_cached(context, std::forward<Handler>(handler), wait_duration);
+    } else {
+        get_locked(context, std::forward<Handler>(handler), wait_duration);
+    }
+}
+
+template <class V, class M, class I, class Q, class S, template <class> class C>
+template <class Context, class Handler>
+void pool_impl<V, M, I, Q, S, C>::get_locked(Context& context, Handler&& handler, time_traits::duration wait_duration) {
+    std::vector<value_type> dropped;
     unique_lock lock(_mutex);
     if (_disabled) {
         lock.unlock();
-        asio::dispatch(io_context,
+        dispatch_completion(context,
             on_list_iterator_handler(
                 make_error_code(error::disabled),
                 list_iterator(),
@@ -341,19 +901,21 @@ void pool_impl<V, M, I, Q>::get(io_context_t& io_context, Handler&& handler, tim
             ));
         return;
     }
-    if (const auto cell = storage_.lease()) {
+    if (const auto cell = storage_.lease(dropped)) {
+        --_free;
         lock.unlock();
-        asio::post(io_context,
+        post_completion(context,
             on_list_iterator_handler(
                 boost::system::error_code(),
                 *cell,
+                this,
                 std::forward<Handler>(handler)
             ));
         return;
     }
     lock.unlock();
     if (wait_duration.count() == 0) {
-        asio::post(io_context,
+        post_completion(context,
             on_list_iterator_handler(
                 make_error_code(error::get_resource_timeout),
                 list_iterator(),
@@ -361,43 +923,471 @@ void pool_impl<V, M, I, Q>::get(io_context_t& io_context, Handler&& handler, tim
             ));
         return;
     }
-    list_iterator_handler<value_type> wrapped(std::forward<Handler>(handler));
-    const bool pushed = _callbacks->push(io_context, wait_duration, std::move(wrapped));
+    const auto slot = get_cancellation_slot(handler);
+    typename queue_type::value_type wrapped(std::forward<Handler>(handler));
+    const bool pushed = push_request(context, wait_duration, wrapped, slot);
+    if (pushed) {
+        return;
+    }
+    post_completion(context,
+        on_error_handler(
+            make_error_code(error::request_queue_overflow),
+            std::move(wrapped)
+        ));
+}
+
+// Serves get from cell cache without locking mutex. Otherwise registers waiter
+// before locked attempt to lease, so concurrent recycle does not put cell into
+// cache unnoticed, and queues request under the lock.
+template <class V, class M, class I, class Q, class S, template <class> class C>
+template <class Context, class Handler>
+void pool_impl<V, M, I, Q, S, C>::get_cached(Context& context, Handler&& handler, time_traits::duration wait_duration) {
+    if (!_disabled) {
+        if (const auto cell = lease_cached()) {
+            post_completion(context,
+                on_list_iterator_handler(
+                    boost::system::error_code(),
+                    *cell,
+                    this,
+                    std::forward<Handler>(handler)
+                ));
+            return;
+        }
+    }
+    const auto slot = get_cancellation_slot(handler);
+    counted_waiter_handler counted(_waiters, std::forward<Handler>(handler));
+    _waiters->fetch_add(1);
+    std::vector<value_type> dropped;
+    unique_lock lock(_mutex);
+    if (_disabled) {
+        lock.unlock();
+        dispatch_completion(context,
+            on_list_iterator_handler(
+                make_error_code(error::disabled),
+                list_iterator(),
+                std::move(counted)
+            ));
+        return;
+    }
+    if (const auto cell = lease_locked(dropped)) {
+        lock.unlock();
+        post_completion(context,
+            on_list_iterator_handler(
+                boost::system::error_code(),
+                *cell,
+                this,
+                std::move(counted)
+            ));
+        return;
+    }
+    if (wait_duration.count() == 0) {
+        lock.unlock();
+        post_completion(context,
+            on_list_iterator_handler(
+                make_error_code(error::get_resource_timeout),
+                list_iterator(),
+                std::move(counted)
+            ));
+        return;
+    }
+    typename queue_type::value_type wrapped(std::move(counted));
+    const bool pushed = push_request(context, wait_duration, wrapped, slot);
+    lock.unlock();
     if (pushed) {
         return;
     }
-    asio::post(io_context,
+    post_completion(context,
         on_error_handler(
             make_error_code(error::request_queue_overflow),
             std::move(wrapped)
         ));
 }
 
-template <class V, class M, class I, class Q>
-void pool_impl<V, M, I, Q>::disable() {
+// Queues request connected to cancellation slot of handler when there is one.
+template <class V, class M, class I, class Q, class S, template <class> class C>
+template <class Context, class Slot>
+bool pool_impl<V, M, I, Q, S, C>::push_request(Context& context, time_traits::duration wait_duration,
+        typename queue_type::value_type& wrapped, const Slot& slot) {
+    if constexpr (is_cancellation_slot<Slot>::value) {
+        return _callbacks->push(context, wait_duration, std::move(wrapped), slot);
+    } else {
+        return _callbacks->push(context, wait_duration, std::move(wrapped));
+    }
+}
+
+// Leases count cells under single lock or queues batch as single request, see
+// lease_batch.
+template <class V, class M, class I, class Q, class S, template <class> class C>
+template <class Context, class Handler>
+void pool_impl<V, M, I, Q, S, C>::get_many(Context& context, std::size_t count, Handler&& handler,
+        time_traits::duration wait_duration, batch_mode mode) {
+    static_assert(std::is_invocable_v<std::decay_t<Handler>, boost::system::error_code, std::vector<list_iterator>>);
+
+    if (count == 0 || (mode == batch_mode::all && count > _capacity)) {
+        post_completion(context,
+            on_list_iterator_handler(
+                count == 0 ? boost::system::error_code() : make_error_code(error::batch_exceeds_capacity),
+                std::vector<list_iterator>(),
+                std::forward<Handler>(handler)
+            ));
+        return;
+    }
+    using state_type = batch_state<std::decay_t<Handler>>;
+    const auto state = std::make_shared<state_type>(state_type {
+        get_queue_executor<executor_type>(context),
+        count,
+        mode,
+        wait_duration,
+        time_traits::add(time_traits::now(), wait_duration),
+        {},
+        std::forward<Handler>(handler),
+        {}
+    });
+    state->cells.reserve(count);
+    if constexpr (cell_cache_type::enabled) {
+        _waiters->fetch_add(1);
+        state->waiters = _waiters;
+    }
+    const auto ec = lease_batch(state, false);
+    if (!ec) {
+        return;
+    }
+    const auto result = finish_batch(this, *state, *ec);
+    state->release_waiter();
+    auto complete = on_list_iterator_handler(result, std::move(state->cells), this, std::move(state->handler));
+    if (result == error::disabled) {
+        dispatch_completion(context, std::move(complete));
+    } else {
+        post_completion(context, std::move(complete));
+    }
+}
+
+template <class V, class M, class I, class Q, class S, template <class> class C>
+template <class Handler>
+void pool_impl<V, M, I, Q, S, C>::batch_request<Handler>::operator ()(boost::system::error_code ec, list_iterator cell) {
+    const auto locked = impl.lock();
+    if (!ec) {
+        state->cells.push_back(cell);
+        const auto leased = locked->lease_batch(state, true);
+        if (!leased) {
+            return;
+        }
+        ec = finish_batch(locked.get(), *state, *leased);
+    }
+    // Requests queued behind expired batch may be served by cells it was waiting for.
+    if (ec == error::get_resource_timeout && locked) {
+        locked->serve_queued();
+    }
+    state->release_waiter();
+    state->handler(ec, std::move(state->cells));
+}
+
+// Returns none when batch is queued, otherwise result of lease. Batch is leased
+// only when there are enough free cells, so queued batch doesn't hold cells
+// required by other requests. Served batch which still can't be leased returns
+// its cell and is queued again before others with its deadline, so later
+// requests don't overtake it. Each time batch is queued it is connected to
+// cancellation slot of handler.
+template <class V, class M, class I, class Q, class S, template <class> class C>
+template <class Handler>
+boost::optional<boost::system::error_code> pool_impl<V, M, I, Q, S, C>::lease_batch(
+        const std::shared_ptr<batch_state<Handler>>& state, bool served) {
+    std::vector<value_type> dropped;
     const lock_guard lock(_mutex);
-    _disabled = true;
-    while (true) {
+    if (_disabled) {
+        return make_error_code(error::disabled);
+    }
+    const auto free = state->cells.size() + _capacity - (storage_.stats().used - cached());
+    if (free >= (state->mode == batch_mode::all ? state->count : 1)) {
+        while (state->cells.size() < state->count) {
+            const auto cell = lease_locked(dropped);
+            if (!cell) {
+                break;
+            }
+            state->cells.push_back(*cell);
+        }
+        if (state->cells.size() == state->count || (state->mode == batch_mode::partial && !state->cells.empty())) {
+            return boost::system::error_code();
+        }
+    }
+    for (const auto cell : state->cells) {
+        ++_free;
+        if (cell->value) {
+            storage_.recycle(cell, dropped);
+        } else {
+            storage_.waste(cell, dropped);
+        }
+    }
+    state->cells.clear();
+    if (state->expires_at <= time_traits::now()) {
+        return make_error_code(error::get_resource_timeout);
+    }
+    const auto slot = get_cancellation_slot(state->handler);
+    typename queue_type::value_type wrapped(batch_request<Handler>(this->weak_from_this(), state));
+    if (!served) {
+        if (!push_request(state->executor, state->wait_duration, wrapped, slot)) {
+            return make_error_code(error::request_queue_overflow);
+        }
+    } else if constexpr (is_cancellation_slot<std::decay_t<decltype(slot)>>::value) {
+        _callbacks->push_front(state->executor, state->expires_at, state->wait_duration, std::move(wrapped), slot);
+    } else {
+        _callbacks->push_front(state->executor, state->expires_at, state->wait_duration, std::move(wrapped));
+    }
+    return {};
+}
+
+// Returns leased cells to the pool on error unless partial batch can be completed.
+// Pool may be destroyed after last cell is returned.
+template <class V, class M, class I, class Q, class S, template <class> class C>
+template <class Handler>
+boost::system::error_code pool_impl<V, M, I, Q, S, C>::finish_batch(pool_impl* impl, batch_state<Handler>& state,
+        boost::system::error_code ec) {
+    if (!ec || (state.mode == batch_mode::partial && !state.cells.empty())) {
+        return boost::system::error_code();
+    }
+    const auto cells = std::move(state.cells);
+    state.cells.clear();
+    return_leased(*impl, cells);
+    return ec;
+}
+
+// Leases available cell, falls back to empty one unless available_only is set.
+template <class V, class M, class I, class Q, class S, template <class> class C>
+boost::optional<typename pool_impl<V, M, I, Q, S, C>::list_iterator> pool_impl<V, M, I, Q, S, C>::try_lease(
+        bool available_only) {
+    if constexpr (cell_cache_type::enabled) {
+        if (!_disabled) {
+            if (const auto cell = lease_cached()) {
+                return cell;
+            }
+        }
+    }
+    std::vector<value_type> dropped;
+    const lock_guard lock(_mutex);
+    if (_disabled) {
+        return {};
+    }
+    const auto cell = available_only ? storage_.lease_available(dropped) : storage_.lease(dropped);
+    if (cell) {
+        --_free;
+        (*cell)->generation = _generation;
+    }
+    return cell;
+}
+
+// Leases empty cell only when there are less than min_available available
+// resources, so resource could be created in advance.
+template <class V, class M, class I, class Q, class S, template <class> class C>
+boost::optional<typename pool_impl<V, M, I, Q, S, C>::list_iterator> pool_impl<V, M, I, Q, S, C>::try_lease_empty(
+        std::size_t min_available) {
+    const lock_guard lock(_mutex);
+    if (_disabled || storage_.stats().available + cached() >= min_available) {
+        return {};
+    }
+    const auto cell = storage_.lease_wasted();
+    if (cell) {
+        --_free;
+        (*cell)->generation = _generation;
+    }
+    return cell;
+}
+
+// Serves queued requests by own cells, so request queued into other pool
+// implementation sharing the queue gets cell returned into this one.
+template <class V, class M, class I, class Q, class S, template <class> class C>
+void pool_impl<V, M, I, Q, S, C>::serve_queued() {
+    std::vector<value_type> dropped;
+    std::vector<std::pair<executor_type, serve_handler>> served;
+    unique_lock lock(_mutex);
+    while (!_disabled && !_callbacks->empty()) {
+        const auto cell = lease_locked(dropped);
+        if (!cell) {
+            break;
+        }
         auto queued = _callbacks->pop();
         if (!queued) {
+            ++_free;
+            if ((*cell)->value) {
+                storage_.recycle(*cell, dropped);
+            } else {
+                storage_.waste(*cell, dropped);
+            }
             break;
         }
-        asio::dispatch(queued->io_context,
+        served.emplace_back(queued->executor, serve_handler(*cell, this, std::move(queued->request)));
+    }
+    lock.unlock();
+    serve_many(served);
+}
+
+// Puts valid cell into cache if there are no waiters. Waiters registered after
+// cell is put into cache will find it, otherwise cache is drained into storage
+// serving queued requests.
+template <class V, class M, class I, class Q, class S, template <class> class C>
+bool pool_impl<V, M, I, Q, S, C>::try_recycle_cached(list_iterator res_it) {
+    if (_disabled || *_waiters != 0 || !res_it->value || res_it->generation != _generation) {
+        return false;
+    }
+    const auto now = time_traits::now();
+    const auto life_end = time_traits::add(res_it->reset_time, _lifespan);
+    if (life_end <= now) {
+        return false;
+    }
+    res_it->drop_time = std::min(time_traits::add(now, _idle_timeout), life_end);
+    // Counted before push, so concurrent lease_cached can't decrement it below zero.
+    ++_free;
+    if (!_cache.push(cache_entry {res_it, res_it->generation})) {
+        --_free;
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (*_waiters != 0 || _disabled) {
+        const auto self = keep_alive();
+        cache_entry entry;
+        while (_cache.pop(entry)) {
+            --_free;
+            recycle_locked(entry.cell);
+        }
+    }
+    return true;
+}
+
+template <class V, class M, class I, class Q, class S, template <class> class C>
+boost::optional<typename pool_impl<V, M, I, Q, S, C>::list_iterator> pool_impl<V, M, I, Q, S, C>::lease_cached() {
+    cache_entry entry;
+    while (_cache.pop(entry)) {
+        --_free;
+        if (entry.generation == _generation && entry.cell->drop_time > time_traits::now()) {
+            entry.cell->generation = entry.generation;
+            return entry.cell;
+        }
+        waste(entry.cell);
+    }
+    return {};
+}
+
+template <class V, class M, class I, class Q, class S, template <class> class C>
+boost::optional<typename pool_impl<V, M, I, Q, S, C>::list_iterator> pool_impl<V, M, I, Q, S, C>::lease_cached(
+        std::vector<value_type>& dropped) {
+    cache_entry entry;
+    while (_cache.pop(entry)) {
+        if (entry.generation == _generation && entry.cell->drop_time > time_traits::now()) {
+            --_free;
+            entry.cell->generation = entry.generation;
+            return entry.cell;
+        }
+        storage_.waste(entry.cell, dropped);
+    }
+    return {};
+}
+
+template <class V, class M, class I, class Q, class S, template <class> class C>
+boost::optional<typename pool_impl<V, M, I, Q, S, C>::list_iterator> pool_impl<V, M, I, Q, S, C>::lease_locked(
+        std::vector<value_type>& dropped) {
+    if constexpr (cell_cache_type::enabled) {
+        if (const auto cell = lease_cached(dropped)) {
+            return cell;
+        }
+    }
+    const auto cell = storage_.lease(dropped);
+    if (cell) {
+        --_free;
+        (*cell)->generation = _generation;
+    }
+    return cell;
+}
+
+template <class V, class M, class I, class Q, class S, template <class> class C>
+void pool_impl<V, M, I, Q, S, C>::drain_cache(std::vector<value_type>& dropped) {
+    if constexpr (cell_cache_type::enabled) {
+        cache_entry entry;
+        while (_cache.pop(entry)) {
+            storage_.waste(entry.cell, dropped);
+        }
+    }
+}
+
+template <class V, class M, class I, class Q, class S, template <class> class C>
+std::size_t pool_impl<V, M, I, Q, S, C>::cached() const noexcept {
+    if constexpr (cell_cache_type::enabled) {
+        return _cache.size();
+    } else {
+        return 0;
+    }
+}
+
+template <class V, class M, class I, class Q, class S, template <class> class C>
+std::shared_ptr<pool_impl<V, M, I, Q, S, C>> pool_impl<V, M, I, Q, S, C>::keep_alive() const {
+    const lock_guard lock(_mutex);
+    return _self;
+}
+
+// Returns self reference to be released after unlock when disabled pool has no leased cells.
+template <class V, class M, class I, class Q, class S, template <class> class C>
+std::shared_ptr<pool_impl<V, M, I, Q, S, C>> pool_impl<V, M, I, Q, S, C>::release_if_unused() {
+    if (_self && storage_.stats().used == cached()) {
+        return std::move(_self);
+    }
+    return {};
+}
+
+// Disabled pool keeps itself alive while there are leased cells, handles refer
+// to the pool by raw pointer.
+// Queued requests are completed after unlock, batch requests return their cells
+// to the pool.
+template <class V, class M, class I, class Q, class S, template <class> class C>
+void pool_impl<V, M, I, Q, S, C>::disable() {
+    std::vector<value_type> dropped;
+    std::vector<typename queue_type::queued_value_t> queued_values;
+    unique_lock lock(_mutex);
+    _disabled = true;
+    if constexpr (cell_cache_type::enabled) {
+        cache_entry entry;
+        while (_cache.pop(entry)) {
+            storage_.recycle(entry.cell, dropped);
+        }
+    }
+    if (storage_.stats().used != 0) {
+        _self = this->weak_from_this().lock();
+    }
+    while (auto queued = _callbacks->pop()) {
+        queued_values.push_back(std::move(*queued));
+    }
+    lock.unlock();
+    for (auto& queued : queued_values) {
+        dispatch_completion(queued.executor,
             on_error_handler(
                 make_error_code(error::disabled),
-                std::move(queued->request)
+                std::move(queued.request)
             ));
     }
 }
 
-template <class V, class M, class I, class Q>
-void pool_impl<V, M, I, Q>::invalidate() {
+template <class V, class M, class I, class Q, class S, template <class> class C>
+void pool_impl<V, M, I, Q, S, C>::invalidate() {
+    std::vector<value_type> dropped;
     const lock_guard lock(_mutex);
-    storage_.invalidate();
+    ++_generation;
+    drain_cache(dropped);
+    storage_.invalidate(dropped);
+}
+
+template <class V, class M, class I, class Q, class S, template <class> class C>
+void pool_impl<V, M, I, Q, S, C>::drop_expired() {
+    std::vector<value_type> dropped;
+    const lock_guard lock(_mutex);
+    storage_.drop_expired(dropped);
+    if constexpr (cell_cache_type::enabled) {
+        const auto now = time_traits::now();
+        _cache.filter(
+            [&] (const cache_entry& entry) { return entry.generation == _generation && entry.cell->drop_time > now; },
+            [&] (const cache_entry& entry) { storage_.waste(entry.cell, dropped); }
+        );
+    }
 }
 
-template <class V, class M, class I, class Q>
-std::size_t pool_impl<V, M, I, Q>::assert_capacity(std::size_t value) {
+template <class V, class M, class I, class Q, class S, template <class> class C>
+std::size_t pool_impl<V, M, I, Q, S, C>::assert_capacity(std::size_t value) {
     if (value == 0) {
         throw error::zero_pool_capacity();
     }
@@ -427,6 +1417,19 @@ struct async_completion {
 using boost::asio::async_completion;
 #endif
 
+// Creates completion handler from token and calls initiation with it. Token may
+// defer initiation, so it must not refer to arguments of initiating function.
+template <class Signature, class CompletionToken, class Initiation>
+auto async_initiate(Initiation&& initiation, CompletionToken&& token) {
+#if BOOST_VERSION < 107000
+    async_completion<CompletionToken, Signature> init(token);
+    std::forward<Initiation>(initiation)(std::move(init.completion_handler));
+    return init.result.get();
+#else
+    return boost::asio::async_initiate<CompletionToken, Signature>(std::forward<Initiation>(initiation), token);
+#endif
+}
+
 template <typename Handler, typename Signature>
 using async_return_type = typename ::boost::asio::async_result<Handler, Signature>::return_type;
 
@@ -3,15 +3,24 @@
 
 #include <yamail/resource_pool/error.hpp>
 #include <yamail/resource_pool/time_traits.hpp>
+#include <yamail/resource_pool/async/cancellation.hpp>
+#include <yamail/resource_pool/async/detail/deadline_index.hpp>
 
+#include <boost/asio/associated_executor.hpp>
+#include <boost/asio/dispatch.hpp>
+#include <boost/asio/error.hpp>
 #include <boost/asio/executor.hpp>
+#include <boost/asio/execution/executor.hpp>
+#include <boost/asio/is_executor.hpp>
 #include <boost/asio/post.hpp>
+#include <boost/asio/system_executor.hpp>
+#include <boost/optional.hpp>
 
 #include <algorithm>
+#include <cstdint>
 #include <list>
-#include <map>
 #include <mutex>
-#include <unordered_map>
+#include <type_traits>
 
 namespace yamail {
 namespace resource_pool {
@@ -23,6 +32,45 @@ namespace detail {
 
 using clock = std::chrono::steady_clock;
 
+// Handler has associated executor other than default system executor.
+template <class Handler>
+bool has_associated_executor(const Handler& handler) noexcept {
+    using executor_type = asio::associated_executor_t<Handler>;
+    if constexpr (std::is_same_v<executor_type, asio::system_executor>) {
+        return false;
+    } else if constexpr (std::is_same_v<executor_type, asio::executor>) {
+        return asio::get_associated_executor(handler).template target<asio::system_executor>() == nullptr;
+    } else {
+        return true;
+    }
+}
+
+template <class T>
+constexpr bool is_executor_v = asio::is_executor<T>::value || asio::execution::is_executor<T>::value;
+
+// Posts completion directly to associated executor of handler, so handler bound
+// to strand or other executor does not take extra hop through io_context. Handler
+// without associated executor is completed through io_context.
+template <class IoContext, class Handler>
+void post_completion(IoContext& io_context, Handler&& handler) {
+    if (has_associated_executor(handler)) {
+        const auto executor = asio::get_associated_executor(handler);
+        asio::post(executor, std::forward<Handler>(handler));
+    } else {
+        asio::post(io_context, std::forward<Handler>(handler));
+    }
+}
+
+template <class IoContext, class Handler>
+void dispatch_completion(IoContext& io_context, Handler&& handler) {
+    if (has_associated_executor(handler)) {
+        const auto executor = asio::get_associated_executor(handler);
+        asio::dispatch(executor, std::forward<Handler>(handler));
+    } else {
+        asio::dispatch(io_context, std::forward<Handler>(handler));
+    }
+}
+
 template <class Handler>
 class expired_handler {
     Handler handler;
@@ -55,19 +103,57 @@ public:
 template <class Handler>
 expired_handler(Handler&&) -> expired_handler<std::decay_t<Handler>>;
 
-template <class Value, class IoContext>
+template <class Handler>
+class canceled_handler {
+    Handler handler;
+
+public:
+    using executor_type = std::decay_t<decltype(asio::get_associated_executor(handler))>;
+
+    template <class HandlerT>
+    explicit canceled_handler(HandlerT&& handler,
+            std::enable_if_t<!std::is_same_v<std::decay_t<HandlerT>, canceled_handler>, void*> = nullptr)
+            : handler(std::forward<HandlerT>(handler)) {
+        static_assert(std::is_same_v<std::decay_t<HandlerT>, Handler>, "HandlerT is not Handler");
+    }
+
+    void operator ()() {
+        handler(make_error_code(asio::error::operation_aborted));
+    }
+
+    auto get_executor() const noexcept {
+        return asio::get_associated_executor(handler);
+    }
+};
+
+template <class Handler>
+canceled_handler(Handler&&) -> canceled_handler<std::decay_t<Handler>>;
+
+template <class Value, class Executor>
 struct queued_value {
     Value request;
-    IoContext& io_context;
+    Executor executor;
 };
 
-template <class Value, class Mutex, class IoContext, class Timer>
-class queue : public std::enable_shared_from_this<queue<Value, Mutex, IoContext, Timer>> {
+// Executor of queued request, io_context is given by its executor.
+template <class Executor, class Context>
+Executor get_queue_executor(Context& context) {
+    if constexpr (std::is_constructible_v<Executor, Context&>) {
+        return Executor(context);
+    } else {
+        return Executor(context.get_executor());
+    }
+}
+
+template <class Value, class Mutex, class IoContext, class Timer,
+          template <class> class DeadlineIndex = fifo_deadline_index>
+class queue : public std::enable_shared_from_this<queue<Value, Mutex, IoContext, Timer, DeadlineIndex>> {
 public:
     using value_type = Value;
     using io_context_t = IoContext;
     using timer_t = Timer;
-    using queued_value_t = queued_value<value_type, io_context_t>;
+    using executor_type = typename timer_t::executor_type;
+    using queued_value_t = queued_value<value_type, executor_type>;
 
     queue(std::size_t capacity) : _capacity(capacity) {}
 
@@ -78,9 +164,21 @@ public:
     std::size_t capacity() const noexcept { return _capacity; }
     std::size_t size() const noexcept;
     bool empty() const noexcept;
-    const timer_t& timer(io_context_t& io_context);
-
-    bool push(io_context_t& io_context, time_traits::duration wait_duration, value_type&& request);
+    template <class Context>
+    const timer_t& timer(Context& context);
+
+    // Context is io_context or executor of the request, requests with equal
+    // executors share timer.
+    template <class Context>
+    bool push(Context& context, time_traits::duration wait_duration, value_type&& request);
+    template <class Context, class Slot>
+    bool push(Context& context, time_traits::duration wait_duration, value_type&& request, Slot slot);
+    template <class Context>
+    void push_front(Context& context, time_traits::time_point expires_at,
+                    time_traits::duration wait_duration, value_type&& request);
+    template <class Context, class Slot>
+    void push_front(Context& context, time_traits::time_point expires_at,
+                    time_traits::duration wait_duration, value_type&& request, Slot slot);
     boost::optional<queued_value_t> pop();
 
 private:
@@ -90,131 +188,265 @@ private:
     struct expiring_request {
         using list = std::list<expiring_request>;
         using list_it = typename list::iterator;
-        using multimap = std::multimap<time_traits::time_point, expiring_request*>;
-        using multimap_it = typename multimap::iterator;
+        using deadline_index = DeadlineIndex<expiring_request>;
 
-        io_context_t* io_context;
+        executor_type executor;
         queue::value_type request;
         list_it order_it;
-        multimap_it expires_at_it;
+        typename deadline_index::hook deadline_hook;
+        // Identifies queued request for cancellation, zero when node is in pool.
+        std::uint64_t id = 0;
 
         expiring_request() = default;
     };
 
-    using request_multimap_value = typename expiring_request::multimap::value_type;
-    using timers_map = typename std::unordered_map<const io_context_t*, timer_t>;
+    struct armed_timer {
+        executor_type executor;
+        timer_t timer;
+        boost::optional<time_traits::time_point> expires_at;
+
+        armed_timer(const executor_type& executor) : executor(executor), timer(executor) {}
+    };
+
+    using deadline_index = typename expiring_request::deadline_index;
+    // Executors are not hashable and there are few of them, so timers are found
+    // by linear search. List keeps armed timer in place.
+    using timers_map = std::list<armed_timer>;
 
     const std::size_t _capacity;
     mutable mutex_t _mutex;
     typename expiring_request::list _ordered_requests_pool;
     typename expiring_request::list _ordered_requests;
-    typename expiring_request::multimap _expires_at_requests;
+    typename expiring_request::deadline_index _expires_at_requests;
     timers_map _timers;
+    std::uint64_t _next_id = 0;
 
     bool fit_capacity() const { return _expires_at_requests.size() < _capacity; }
-    void cancel(boost::system::error_code ec, time_traits::time_point expires_at);
+    expiring_request* push_locked(const executor_type& executor, time_traits::duration wait_duration,
+                                  value_type&& request);
+    expiring_request& insert_locked(typename expiring_request::list_it position, const executor_type& executor,
+                                    time_traits::time_point expires_at, time_traits::duration wait_duration,
+                                    value_type&& request);
+    template <class Slot>
+    void connect(const expiring_request& req, Slot& slot);
+    void cancel_request(typename expiring_request::list_it order_it, std::uint64_t id);
+    void cancel(boost::system::error_code ec, const executor_type& executor, time_traits::time_point expires_at);
     void update_timer();
-    timer_t& get_timer(io_context_t& io_context);
+    bool is_armed_before(time_traits::time_point expires_at) const;
+    typename timers_map::iterator find_timer(const executor_type& executor);
+    armed_timer& get_timer(const executor_type& executor);
 };
 
-template <class V, class M, class I, class T>
-std::size_t queue<V, M, I, T>::size() const noexcept {
+template <class V, class M, class I, class T, template <class> class D>
+std::size_t queue<V, M, I, T, D>::size() const noexcept {
     const lock_guard lock(_mutex);
     return _expires_at_requests.size();
 }
 
-template <class V, class M, class I, class T>
-bool queue<V, M, I, T>::empty() const noexcept {
+template <class V, class M, class I, class T, template <class> class D>
+bool queue<V, M, I, T, D>::empty() const noexcept {
     const lock_guard lock(_mutex);
     return _ordered_requests.empty();
 }
 
-template <class V, class M, class I, class T>
-const typename queue<V, M, I, T>::timer_t& queue<V, M, I, T>::timer(io_context_t& io_context) {
+template <class V, class M, class I, class T, template <class> class D>
+template <class Context>
+const typename queue<V, M, I, T, D>::timer_t& queue<V, M, I, T, D>::timer(Context& context) {
+    const auto executor = get_queue_executor<executor_type>(context);
     const lock_guard lock(_mutex);
-    return get_timer(io_context);
+    return get_timer(executor).timer;
 }
 
-template <class V, class M, class I, class T>
-bool queue<V, M, I, T>::push(io_context_t& io_context, time_traits::duration wait_duration, value_type&& request) {
+template <class V, class M, class I, class T, template <class> class D>
+template <class Context>
+bool queue<V, M, I, T, D>::push(Context& context, time_traits::duration wait_duration, value_type&& request) {
+    const auto executor = get_queue_executor<executor_type>(context);
     const lock_guard lock(_mutex);
-    if (!fit_capacity()) {
+    return push_locked(executor, wait_duration, std::move(request)) != nullptr;
+}
+
+template <class V, class M, class I, class T, template <class> class D>
+template <class Context, class Slot>
+bool queue<V, M, I, T, D>::push(Context& context, time_traits::duration wait_duration, value_type&& request,
+                                Slot slot) {
+    const auto executor = get_queue_executor<executor_type>(context);
+    const lock_guard lock(_mutex);
+    const auto req = push_locked(executor, wait_duration, std::move(request));
+    if (!req) {
         return false;
     }
+    connect(*req, slot);
+    return true;
+}
+
+template <class V, class M, class I, class T, template <class> class D>
+typename queue<V, M, I, T, D>::expiring_request* queue<V, M, I, T, D>::push_locked(const executor_type& executor,
+        time_traits::duration wait_duration, value_type&& request) {
+    if (!fit_capacity()) {
+        return nullptr;
+    }
+    const auto expires_at = time_traits::add(time_traits::now(), wait_duration);
+    return std::addressof(insert_locked(_ordered_requests.end(), executor, expires_at, wait_duration,
+                                        std::move(request)));
+}
+
+// Puts popped request back before others keeping its deadline and wait duration.
+// Request was admitted by the queue already, so capacity is not checked.
+template <class V, class M, class I, class T, template <class> class D>
+template <class Context>
+void queue<V, M, I, T, D>::push_front(Context& context, time_traits::time_point expires_at,
+                                      time_traits::duration wait_duration, value_type&& request) {
+    const auto executor = get_queue_executor<executor_type>(context);
+    const lock_guard lock(_mutex);
+    insert_locked(_ordered_requests.begin(), executor, expires_at, wait_duration, std::move(request));
+}
+
+template <class V, class M, class I, class T, template <class> class D>
+template <class Context, class Slot>
+void queue<V, M, I, T, D>::push_front(Context& context, time_traits::time_point expires_at,
+                                      time_traits::duration wait_duration, value_type&& request, Slot slot) {
+    const auto executor = get_queue_executor<executor_type>(context);
+    const lock_guard lock(_mutex);
+    connect(insert_locked(_ordered_requests.begin(), executor, expires_at, wait_duration, std::move(request)), slot);
+}
+
+// Connects slot to queued request, emitted signal removes request from the queue
+// and completes it with operation_aborted. Signal emitted after request is popped
+// or expired does nothing. Queued request has no side effects, so any type of
+// asio cancellation removes it.
+template <class V, class M, class I, class T, template <class> class D>
+template <class Slot>
+void queue<V, M, I, T, D>::connect(const expiring_request& req, Slot& slot) {
+    static_assert(is_cancellation_slot<Slot>::value, "Slot is not cancellation slot");
+    if (!slot.is_connected()) {
+        return;
+    }
+    std::weak_ptr<queue> weak(this->shared_from_this());
+    slot.assign([weak, order_it = req.order_it, id = req.id] (auto&& ...) {
+        if (const auto locked = weak.lock()) {
+            locked->cancel_request(order_it, id);
+        }
+    });
+}
+
+template <class V, class M, class I, class T, template <class> class D>
+typename queue<V, M, I, T, D>::expiring_request& queue<V, M, I, T, D>::insert_locked(
+        typename expiring_request::list_it position, const executor_type& executor, time_traits::time_point expires_at,
+        time_traits::duration wait_duration, value_type&& request) {
     if (_ordered_requests_pool.empty()) {
         _ordered_requests_pool.emplace_back();
     }
     const auto order_it = _ordered_requests_pool.begin();
-    _ordered_requests.splice(_ordered_requests.end(), _ordered_requests_pool, order_it);
+    _ordered_requests.splice(position, _ordered_requests_pool, order_it);
     expiring_request& req = *order_it;
-    req.io_context = std::addressof(io_context);
+    req.executor = executor;
     req.request = std::move(request);
     req.order_it = order_it;
-    const auto expires_at = time_traits::add(time_traits::now(), wait_duration);
-    req.expires_at_it = _expires_at_requests.insert(std::make_pair(expires_at, &req));
+    req.id = ++_next_id;
+    _expires_at_requests.insert(req, expires_at, wait_duration);
     update_timer();
-    return true;
+    return req;
 }
 
-template <class V, class M, class I, class T>
-boost::optional<typename queue<V, M, I, T>::queued_value_t> queue<V, M, I, T>::pop() {
+template <class V, class M, class I, class T, template <class> class D>
+boost::optional<typename queue<V, M, I, T, D>::queued_value_t> queue<V, M, I, T, D>::pop() {
     const lock_guard lock(_mutex);
     if (_ordered_requests.empty()) {
         return {};
     }
     const auto ordered_it = _ordered_requests.begin();
     expiring_request& req = *ordered_it;
-    queued_value_t result {std::move(req.request), *req.io_context};
-    _expires_at_requests.erase(req.expires_at_it);
+    queued_value_t result {std::move(req.request), req.executor};
+    req.id = 0;
+    _expires_at_requests.erase(req);
     _ordered_requests_pool.splice(_ordered_requests_pool.begin(), _ordered_requests, ordered_it);
     update_timer();
     return { std::move(result) };
 }
 
-template <class V, class M, class I, class T>
-void queue<V, M, I, T>::cancel(boost::system::error_code ec, time_traits::time_point expires_at) {
+template <class V, class M, class I, class T, template <class> class D>
+void queue<V, M, I, T, D>::cancel(boost::system::error_code ec, const executor_type& executor,
+                                  time_traits::time_point expires_at) {
     if (ec) {
         return;
     }
     const lock_guard lock(_mutex);
-    const auto begin = _expires_at_requests.begin();
-    const auto end = _expires_at_requests.upper_bound(expires_at);
-    std::for_each(begin, end, [&] (request_multimap_value& v) {
-        const auto req = v.second;
-        asio::post(*req->io_context, expired_handler(std::move(req->request)));
-        _ordered_requests_pool.splice(_ordered_requests_pool.begin(), _ordered_requests, req->order_it);
-    });
-    _expires_at_requests.erase(_expires_at_requests.begin(), end);
+    const auto timer = find_timer(executor);
+    if (timer != _timers.end() && timer->expires_at == expires_at) {
+        timer->expires_at = boost::none;
+    }
+    const auto expire_until = std::max(expires_at, time_traits::now());
+    while (!_expires_at_requests.empty()) {
+        auto& req = _expires_at_requests.earliest();
+        if (deadline_index::expires_at(req) > expire_until) {
+            break;
+        }
+        _expires_at_requests.erase(req);
+        req.id = 0;
+        post_completion(req.executor, expired_handler(std::move(req.request)));
+        _ordered_requests_pool.splice(_ordered_requests_pool.begin(), _ordered_requests, req.order_it);
+    }
     update_timer();
 }
 
-template <class V, class M, class I, class T>
-void queue<V, M, I, T>::update_timer() {
-    using timers_map_value = typename timers_map::value_type;
+template <class V, class M, class I, class T, template <class> class D>
+void queue<V, M, I, T, D>::cancel_request(typename expiring_request::list_it order_it, std::uint64_t id) {
+    const lock_guard lock(_mutex);
+    expiring_request& req = *order_it;
+    if (req.id != id) {
+        return;
+    }
+    req.id = 0;
+    _expires_at_requests.erase(req);
+    post_completion(req.executor, canceled_handler(std::move(req.request)));
+    _ordered_requests_pool.splice(_ordered_requests_pool.begin(), _ordered_requests, order_it);
+    update_timer();
+}
+
+// Arms timer only when there is no timer armed to fire not later than the earliest request expiration.
+// Timer fired before the earliest expiration does nothing but rearms.
+template <class V, class M, class I, class T, template <class> class D>
+void queue<V, M, I, T, D>::update_timer() {
     if (_expires_at_requests.empty()) {
-        std::for_each(_timers.begin(), _timers.end(), [] (timers_map_value& v) { v.second.cancel(); });
+        std::for_each(_timers.begin(), _timers.end(), [] (armed_timer& v) { v.timer.cancel(); });
         _timers.clear();
         return;
     }
-    const auto earliest_expire = _expires_at_requests.begin();
-    const auto expires_at = earliest_expire->first;
-    auto& timer = get_timer(*earliest_expire->second->io_context);
-    timer.expires_at(expires_at);
+    const auto& earliest_expire = _expires_at_requests.earliest();
+    const auto expires_at = deadline_index::expires_at(earliest_expire);
+    if (is_armed_before(expires_at)) {
+        return;
+    }
+    auto& timer = get_timer(earliest_expire.executor);
+    timer.timer.expires_at(expires_at);
+    timer.expires_at = expires_at;
     std::weak_ptr<queue> weak(this->shared_from_this());
-    timer.async_wait([weak, expires_at] (boost::system::error_code ec) {
+    timer.timer.async_wait([weak, executor = timer.executor, expires_at] (boost::system::error_code ec) {
         if (const auto locked = weak.lock()) {
-            locked->cancel(ec, expires_at);
+            locked->cancel(ec, executor, expires_at);
         }
     });
 }
 
-template <class V, class M, class I, class T>
-typename queue<V, M, I, T>::timer_t& queue<V, M, I, T>::get_timer(io_context_t& io_context) {
-    auto it = _timers.find(&io_context);
+template <class V, class M, class I, class T, template <class> class D>
+bool queue<V, M, I, T, D>::is_armed_before(time_traits::time_point expires_at) const {
+    return std::any_of(_timers.begin(), _timers.end(), [&] (const armed_timer& v) {
+        return v.expires_at && *v.expires_at <= expires_at;
+    });
+}
+
+template <class V, class M, class I, class T, template <class> class D>
+typename queue<V, M, I, T, D>::timers_map::iterator queue<V, M, I, T, D>::find_timer(const executor_type& executor) {
+    return std::find_if(_timers.begin(), _timers.end(), [&] (const armed_timer& v) { return v.executor == executor; });
+}
+
+template <class V, class M, class I, class T, template <class> class D>
+typename queue<V, M, I, T, D>::armed_timer& queue<V, M, I, T, D>::get_timer(const executor_type& executor) {
+    const auto it = find_timer(executor);
     if (it != _timers.end()) {
-        return it->second;
+        return *it;
     }
-    return _timers.emplace(&io_context, timer_t(io_context)).first->second;
+    return _timers.emplace_back(executor);
 }
 
 } // namespace detail
@@ -0,0 +1,96 @@
+#ifndef YAMAIL_RESOURCE_POOL_ASYNC_DETAIL_REAPER_HPP
+#define YAMAIL_RESOURCE_POOL_ASYNC_DETAIL_REAPER_HPP
+
+#include <yamail/resource_pool/time_traits.hpp>
+
+#include <boost/system/error_code.hpp>
+
+#include <memory>
+#include <mutex>
+
+namespace yamail {
+namespace resource_pool {
+namespace async {
+namespace detail {
+
+// Periodically drops expired available resources of pool implementation
+// so lease does not pay for their destruction.
+template <class PoolImpl, class Timer = time_traits::timer>
+class reaper : public std::enable_shared_from_this<reaper<PoolImpl, Timer>> {
+public:
+    using pool_impl = PoolImpl;
+    using timer_t = Timer;
+
+    template <class Executor>
+    reaper(Executor&& executor, std::weak_ptr<pool_impl> impl, time_traits::duration interval)
+            : _timer(std::forward<Executor>(executor)),
+              _impl(std::move(impl)),
+              _interval(interval) {}
+
+    reaper(const reaper&) = delete;
+
+    reaper(reaper&&) = delete;
+
+    void start();
+    void stop();
+
+private:
+    using mutex_t = std::mutex;
+    using lock_guard = std::lock_guard<mutex_t>;
+
+    mutex_t _mutex;
+    timer_t _timer;
+    std::weak_ptr<pool_impl> _impl;
+    const time_traits::duration _interval;
+    bool _stopped = false;
+
+    void schedule();
+    void on_timer(boost::system::error_code ec);
+};
+
+template <class P, class T>
+void reaper<P, T>::start() {
+    const lock_guard lock(_mutex);
+    schedule();
+}
+
+template <class P, class T>
+void reaper<P, T>::stop() {
+    const lock_guard lock(_mutex);
+    _stopped = true;
+    _timer.cancel();
+}
+
+template <class P, class T>
+void reaper<P, T>::schedule() {
+    _timer.expires_at(time_traits::add(time_traits::now(), _interval));
+    std::weak_ptr<reaper> weak(this->shared_from_this());
+    _timer.async_wait([weak] (boost::system::error_code ec) {
+        if (const auto locked = weak.lock()) {
+            locked->on_timer(ec);
+        }
+    });
+}
+
+template <class P, class T>
+void reaper<P, T>::on_timer(boost::system::error_code ec) {
+    if (ec) {
+        return;
+    }
+    const auto impl = _impl.lock();
+    if (!impl) {
+        return;
+    }
+    impl->drop_expired();
+    const lock_guard lock(_mutex);
+    if (!_stopped) {
+        schedule();
+    }
+}
+
+} // namespace detail
+} // namespace async
+} // namespace resource_pool
+} // namespace yamail
+
+#endif // YAMAIL_RESOURCE_POOL_ASYNC_DETAIL_REAPER_HPP
@@ -0,0 +1,152 @@
+#ifndef YAMAIL_RESOURCE_POOL_ASYNC_DETAIL_WARMER_HPP
+#define YAMAIL_RESOURCE_POOL_ASYNC_DETAIL_WARMER_HPP
+
+#include <yamail/resource_pool/time_traits.hpp>
+
+#include <boost/system/error_code.hpp>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace yamail {
+namespace resource_pool {
+namespace async {
+namespace detail {
+
+// Keeps at least min_idle available resources in pool by creating resources for
+// empty cells through factory state. Refill happens on timer and after each
+// successful creation, failed creation is retried on next timer. Created resource
+// is recycled into pool even if warmer is already stopped.
+template <class Pool, class FactoryState, class Timer = time_traits::timer>
+class warmer : public std::enable_shared_from_this<warmer<Pool, FactoryState, Timer>> {
+public:
+    using pool_type = Pool;
+    using factory_state = FactoryState;
+    using io_context_t = typename pool_type::io_context_t;
+    using handle = typename pool_type::handle;
+    using timer_t = Timer;
+
+    warmer(io_context_t& io_context, pool_type& pool, std::shared_ptr<factory_state> state,
+           std::size_t min_idle, time_traits::duration interval)
+            : _io_context(io_context),
+              _timer(io_context),
+              _pool(pool),
+              _state(std::move(state)),
+              _min_idle(min_idle),
+              _interval(interval) {}
+
+    warmer(const warmer&) = delete;
+
+    warmer(warmer&&) = delete;
+
+    void start();
+    void stop();
+
+private:
+    using mutex_t = std::mutex;
+    using lock_guard = std::lock_guard<mutex_t>;
+
+    mutex_t _mutex;
+    io_context_t& _io_context;
+    timer_t _timer;
+    pool_type& _pool;
+    const std::shared_ptr<factory_state> _state;
+    const std::size_t _min_idle;
+    const time_traits::duration _interval;
+    std::size_t _in_flight = 0;
+    bool _stopped = false;
+
+    void schedule();
+    void on_timer(boost::system::error_code ec);
+    void refill();
+    void on_created(boost::system::error_code ec);
+};
+
+template <class P, class F, class T>
+void warmer<P, F, T>::start() {
+    refill();
+    const lock_guard lock(_mutex);
+    schedule();
+}
+
+template <class P, class F, class T>
+void warmer<P, F, T>::stop() {
+    const lock_guard lock(_mutex);
+    _stopped = true;
+    _timer.cancel();
+}
+
+template <class P, class F, class T>
+void warmer<P, F, T>::schedule() {
+    _timer.expires_at(time_traits::add(time_traits::now(), _interval));
+    std::weak_ptr<warmer> weak(this->shared_from_this());
+    _timer.async_wait([weak] (boost::system::error_code ec) {
+        if (const auto locked = weak.lock()) {
+            locked->on_timer(ec);
+        }
+    });
+}
+
+template <class P, class F, class T>
+void warmer<P, F, T>::on_timer(boost::system::error_code ec) {
+    if (ec) {
+        return;
+    }
+    refill();
+    const lock_guard lock(_mutex);
+    if (!_stopped) {
+        schedule();
+    }
+}
+
+// Takes empty cells while available resources and creations in flight are less
+// than min_idle, creation is started outside of the lock because create function
+// may complete inline.
+template <class P, class F, class T>
+void warmer<P, F, T>::refill() {
+    std::vector<handle> empty;
+    {
+        const lock_guard lock(_mutex);
+        if (_stopped) {
+            return;
+        }
+        while (_in_flight < _min_idle) {
+            auto res = _pool.try_get_empty(_min_idle - _in_flight);
+            if (res.unusable()) {
+                break;
+            }
+            empty.push_back(std::move(res));
+            ++_in_flight;
+        }
+    }
+    std::weak_ptr<warmer> weak(this->shared_from_this());
+    for (auto& res : empty) {
+        _state->create(_io_context, std::move(res), [weak] (boost::system::error_code ec, handle res) {
+            if (!res.unusable()) {
+                res.recycle();
+            }
+            if (const auto locked = weak.lock()) {
+                locked->on_created(ec);
+            }
+        });
+    }
+}
+
+template <class P, class F, class T>
+void warmer<P, F, T>::on_created(boost::system::error_code ec) {
+    {
+        const lock_guard lock(_mutex);
+        --_in_flight;
+    }
+    if (!ec) {
+        refill();
+    }
+}
+
+} // namespace detail
+} // namespace async
+} // namespace resource_pool
+} // namespace yamail
+
+#endif // YAMAIL_RESOURCE_POOL_ASYNC_DETAIL_WARMER_HPP
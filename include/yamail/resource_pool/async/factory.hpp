@@ -0,0 +1,132 @@
+#ifndef YAMAIL_RESOURCE_POOL_ASYNC_FACTORY_HPP
+#define YAMAIL_RESOURCE_POOL_ASYNC_FACTORY_HPP
+
+#include <yamail/resource_pool/async/pool.hpp>
+#include <yamail/resource_pool/async/detail/factory_state.hpp>
+#include <yamail/resource_pool/async/detail/warmer.hpp>
+
+namespace yamail {
+namespace resource_pool {
+namespace async {
+
+// Gets handles from attached pool and creates resources for empty ones with
+// bounded number of concurrent creations, so all callers getting empty cells
+// at once after invalidate don't create resources at once.
+template <class Pool>
+class factory {
+public:
+    using pool_type = Pool;
+    using value_type = typename pool_type::value_type;
+    using io_context_t = typename pool_type::io_context_t;
+    using handle = typename pool_type::handle;
+    using state_type = detail::factory_state<value_type, io_context_t, handle>;
+    using on_create = typename state_type::on_create;
+    using create_function = typename state_type::create_function;
+
+    // Function create is called as create(io_context, on_create) and must call
+    // on_create(error_code, value_type) once.
+    factory(pool_type& pool, create_function create, std::size_t max_concurrent)
+            : _pool(pool),
+              _state(std::make_shared<state_type>(std::move(create), max_concurrent)) {}
+
+    factory(const factory&) = delete;
+    factory(factory&&) = default;
+
+    ~factory() {
+        stop_warmer();
+    }
+
+    factory& operator =(const factory&) = delete;
+
+    pool_type& pool() noexcept { return _pool; }
+    const pool_type& pool() const noexcept { return _pool; }
+    creation_stats stats() const { return _state->stats(); }
+
+    // Completes with handle to not empty resource or with error of pool get or
+    // resource creation. Wait duration limits only wait for the pool.
+    template <class CompletionToken>
+    auto get_auto_waste(io_context_t& io_context, CompletionToken&& token,
+                        time_traits::duration wait_duration = time_traits::duration(0)) {
+        return detail::async_initiate<void (boost::system::error_code, handle)>(
+            [this, &io_context, wait_duration] (auto handler) {
+                _pool.get_auto_waste(io_context, make_on_get_handler(io_context, std::move(handler)), wait_duration);
+            },
+            std::forward<CompletionToken>(token));
+    }
+
+    template <class CompletionToken>
+    auto get_auto_recycle(io_context_t& io_context, CompletionToken&& token,
+                          time_traits::duration wait_duration = time_traits::duration(0)) {
+        return detail::async_initiate<void (boost::system::error_code, handle)>(
+            [this, &io_context, wait_duration] (auto handler) {
+                _pool.get_auto_recycle(io_context, make_on_get_handler(io_context, std::move(handler)), wait_duration);
+            },
+            std::forward<CompletionToken>(token));
+    }
+
+    // Keeps at least min_idle available resources in the pool creating resources for
+    // empty cells on io_context every interval and after each created resource.
+    void start_warmer(io_context_t& io_context, std::size_t min_idle, time_traits::duration interval) {
+        stop_warmer();
+        _warmer = std::make_shared<warmer>(io_context, _pool, _state, min_idle, interval);
+        _warmer->start();
+    }
+
+    void stop_warmer() {
+        if (_warmer) {
+            _warmer->stop();
+            _warmer.reset();
+        }
+    }
+
+private:
+    using warmer = detail::warmer<pool_type, state_type>;
+
+    template <class Handler>
+    class on_get_handler {
+        std::shared_ptr<state_type> state;
+        io_context_t* io_context;
+        Handler handler;
+
+    public:
+        using executor_type = std::decay_t<decltype(asio::get_associated_executor(handler))>;
+
+        template <class HandlerT>
+        on_get_handler(std::shared_ptr<state_type> state, io_context_t& io_context, HandlerT&& handler)
+            : state(std::move(state)),
+              io_context(std::addressof(io_context)),
+              handler(std::forward<HandlerT>(handler)) {}
+
+        void operator ()(boost::system::error_code ec, handle res) {
+            if (ec || !res.empty()) {
+                handler(ec, std::move(res));
+            } else {
+                state->create(*io_context, std::move(res), std::move(handler));
+            }
+        }
+
+        auto get_executor() const noexcept {
+            return asio::get_associated_executor(handler);
+        }
+
+        template <class H = Handler, class = std::enable_if_t<detail::has_cancellation_slot_v<H>>>
+        auto get_cancellation_slot() const noexcept {
+            return detail::get_cancellation_slot(handler);
+        }
+    };
+
+    template <class Handler>
+    auto make_on_get_handler(io_context_t& io_context, Handler&& handler) {
+        return on_get_handler<std::decay_t<Handler>>(_state, io_context, std::forward<Handler>(handler));
+    }
+
+    pool_type& _pool;
+    std::shared_ptr<state_type> _state;
+    std::shared_ptr<warmer> _warmer;
+};
+
+} // namespace async
+} // namespace resource_pool
+} // namespace yamail
+
+#endif // YAMAIL_RESOURCE_POOL_ASYNC_FACTORY_HPP
@@ -1,34 +1,75 @@
 #ifndef YAMAIL_RESOURCE_POOL_ASYNC_POOL_HPP
 #define YAMAIL_RESOURCE_POOL_ASYNC_POOL_HPP
 
+#include <yamail/resource_pool/batch_mode.hpp>
 #include <yamail/resource_pool/error.hpp>
 #include <yamail/resource_pool/handle.hpp>
+#include <yamail/resource_pool/lease_order.hpp>
+#include <yamail/resource_pool/async/cancellation.hpp>
+#include <yamail/resource_pool/async/completion_mode.hpp>
 #include <yamail/resource_pool/async/detail/pool_impl.hpp>
+#include <yamail/resource_pool/async/detail/reaper.hpp>
+#include <yamail/resource_pool/detail/magazine_cache.hpp>
 
 #include <boost/asio/io_context.hpp>
 
+#if defined(BOOST_ASIO_HAS_CO_AWAIT)
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#endif
+
+#include <vector>
+
 namespace yamail {
 namespace resource_pool {
 namespace async {
 
-template <class Value, class Mutex, class IoContext>
+template <class Value, class Mutex, class IoContext, class Storage = resource_pool::detail::storage<Value>>
 struct default_pool_queue {
     using value_type = Value;
     using io_context_t = IoContext;
     using mutex_t = Mutex;
     using idle = resource_pool::detail::idle<value_type>;
-    using list = std::list<idle>;
-    using list_iterator = typename list::iterator;
-    using type = detail::queue<detail::list_iterator_handler<value_type>, mutex_t, io_context_t, time_traits::timer>;
+    using list_iterator = typename Storage::cell_iterator;
+    using type = detail::queue<detail::list_iterator_handler<value_type, list_iterator>, mutex_t, io_context_t, time_traits::timer>;
 };
 
-template <class Value, class Mutex, class IoContext>
+template <class Value, class Mutex, class IoContext, class Storage = resource_pool::detail::storage<Value>>
 struct default_pool_impl {
     using type = typename detail::pool_impl<
         Value,
         Mutex,
         IoContext,
-        typename default_pool_queue<Value, Mutex, IoContext>::type
+        typename default_pool_queue<Value, Mutex, IoContext, Storage>::type,
+        Storage
+    >;
+};
+
+// Pool implementation serving get and recycle through lock-free cell cache
+// while there are no queued requests.
+template <class Value, class Mutex, class IoContext, class Storage = resource_pool::detail::storage<Value>>
+struct fast_path_pool_impl {
+    using type = typename detail::pool_impl<
+        Value,
+        Mutex,
+        IoContext,
+        typename default_pool_queue<Value, Mutex, IoContext, Storage>::type,
+        Storage,
+        detail::cell_ring
+    >;
+};
+
+// Pool implementation serving get and recycle through per thread magazines of cells
+// while there are no queued requests.
+template <class Value, class Mutex, class IoContext, class Storage = resource_pool::detail::storage<Value>>
+struct magazine_pool_impl {
+    using type = typename detail::pool_impl<
+        Value,
+        Mutex,
+        IoContext,
+        typename default_pool_queue<Value, Mutex, IoContext, Storage>::type,
+        Storage,
+        resource_pool::detail::magazine_cache
     >;
 };
 
@@ -41,41 +82,49 @@ public:
     using value_type = Value;
     using io_context_t = IoContext;
     using pool_impl = Impl;
-    using handle = resource_pool::handle<value_type>;
+    using handle = resource_pool::handle<value_type, typename pool_impl::list_iterator>;
+    template <class Strategy>
+    using static_handle = resource_pool::static_handle<pool_impl, Strategy>;
 
     pool(std::size_t capacity,
          std::size_t queue_capacity,
          time_traits::duration idle_timeout = time_traits::duration::max(),
-         time_traits::duration lifespan = time_traits::duration::max())
+         time_traits::duration lifespan = time_traits::duration::max(),
+         lease_order order = lease_order::fifo)
             : _impl(std::make_shared<pool_impl>(
                 capacity,
                 queue_capacity,
                 idle_timeout,
-                lifespan)) {}
+                lifespan,
+                order)) {}
 
     template <class Generator>
     pool(Generator&& gen_value,
          std::size_t capacity,
          std::size_t queue_capacity,
          time_traits::duration idle_timeout = time_traits::duration::max(),
-         time_traits::duration lifespan = time_traits::duration::max())
+         time_traits::duration lifespan = time_traits::duration::max(),
+         lease_order order = lease_order::fifo)
             : _impl(std::make_shared<pool_impl>(
                 std::forward<Generator>(gen_value),
                 capacity,
                 queue_capacity,
                 idle_timeout,
-                lifespan)) {}
+                lifespan,
+                order)) {}
 
     template <class Iter>
     pool(Iter first, Iter last,
          std::size_t queue_capacity,
          time_traits::duration idle_timeout = time_traits::duration::max(),
-         time_traits::duration lifespan = time_traits::duration::max())
+         time_traits::duration lifespan = time_traits::duration::max(),
+         lease_order order = lease_order::fifo)
             : _impl(std::make_shared<pool_impl>(
                 first, last,
                 queue_capacity,
                 idle_timeout,
-                lifespan)) {}
+                lifespan,
+                order)) {}
 
     pool(std::shared_ptr<pool_impl> impl)
             : _impl(std::move(impl)) {}
@@ -84,13 +133,24 @@ public:
     pool(pool&&) = default;
 
     ~pool() {
+        stop_reaper();
         if (_impl) {
             _impl->disable();
         }
     }
 
     pool& operator =(const pool&) = delete;
-    pool& operator =(pool&&) = default;
+    pool& operator =(pool&& other) {
+        if (this != &other) {
+            stop_reaper();
+            if (_impl) {
+                _impl->disable();
+            }
+            _impl = std::move(other._impl);
+            _reaper = std::move(other._reaper);
+        }
+        return *this;
+    }
 
     std::size_t capacity() const noexcept { return _impl->capacity(); }
     std::size_t size() const noexcept { return _impl->size(); }
@@ -100,35 +160,195 @@ public:
 
     const pool_impl& impl() const noexcept { return *_impl; }
 
+    // With completion_mode::dispatch handler of immediately leased resource may be
+    // called before get returns.
     template <class CompletionToken>
     auto get_auto_waste(io_context_t& io_context, CompletionToken&& token,
-                        time_traits::duration wait_duration = time_traits::duration(0)) {
-        async_completion<CompletionToken> init(token);
-        get(io_context, std::move(init.completion_handler), &handle::waste, wait_duration);
-        return init.result.get();
+                        time_traits::duration wait_duration = time_traits::duration(0),
+                        completion_mode mode = completion_mode::post) {
+        return async_initiate<handle>(std::forward<CompletionToken>(token),
+            [this, &io_context, wait_duration, mode] (auto handler) {
+                get_handle(io_context, std::move(handler), &handle::waste, wait_duration, mode);
+            });
     }
 
     template <class CompletionToken>
     auto get_auto_recycle(io_context_t& io_context, CompletionToken&& token,
-                          time_traits::duration wait_duration = time_traits::duration(0)) {
-        async_completion<CompletionToken> init(token);
-        get(io_context, std::move(init.completion_handler), &handle::recycle, wait_duration);
-        return init.result.get();
+                          time_traits::duration wait_duration = time_traits::duration(0),
+                          completion_mode mode = completion_mode::post) {
+        return async_initiate<handle>(std::forward<CompletionToken>(token),
+            [this, &io_context, wait_duration, mode] (auto handler) {
+                get_handle(io_context, std::move(handler), &handle::recycle, wait_duration, mode);
+            });
+    }
+
+    // Handler without associated executor is completed on executor, timer of
+    // queued request runs on it too, so io_context is not required.
+    template <class Executor, class CompletionToken, class = std::enable_if_t<detail::is_executor_v<Executor>>>
+    auto get_auto_waste(const Executor& executor, CompletionToken&& token,
+                        time_traits::duration wait_duration = time_traits::duration(0),
+                        completion_mode mode = completion_mode::post) {
+        return async_initiate<handle>(std::forward<CompletionToken>(token),
+            [this, executor, wait_duration, mode] (auto handler) {
+                get_handle(executor, std::move(handler), &handle::waste, wait_duration, mode);
+            });
+    }
+
+    template <class Executor, class CompletionToken, class = std::enable_if_t<detail::is_executor_v<Executor>>>
+    auto get_auto_recycle(const Executor& executor, CompletionToken&& token,
+                          time_traits::duration wait_duration = time_traits::duration(0),
+                          completion_mode mode = completion_mode::post) {
+        return async_initiate<handle>(std::forward<CompletionToken>(token),
+            [this, executor, wait_duration, mode] (auto handler) {
+                get_handle(executor, std::move(handler), &handle::recycle, wait_duration, mode);
+            });
+    }
+
+    // Completes once with vector of handles for count resources leased under single
+    // lock, see batch_mode for completion rules.
+    template <class CompletionToken>
+    auto get_many_auto_waste(io_context_t& io_context, std::size_t count, CompletionToken&& token,
+                             time_traits::duration wait_duration = time_traits::duration(0),
+                             batch_mode mode = batch_mode::all) {
+        return async_initiate<std::vector<handle>>(std::forward<CompletionToken>(token),
+            [this, &io_context, count, wait_duration, mode] (auto handler) {
+                get_handles(io_context, count, std::move(handler), &handle::waste, wait_duration, mode);
+            });
+    }
+
+    template <class CompletionToken>
+    auto get_many_auto_recycle(io_context_t& io_context, std::size_t count, CompletionToken&& token,
+                               time_traits::duration wait_duration = time_traits::duration(0),
+                               batch_mode mode = batch_mode::all) {
+        return async_initiate<std::vector<handle>>(std::forward<CompletionToken>(token),
+            [this, &io_context, count, wait_duration, mode] (auto handler) {
+                get_handles(io_context, count, std::move(handler), &handle::recycle, wait_duration, mode);
+            });
+    }
+
+    template <class Executor, class CompletionToken, class = std::enable_if_t<detail::is_executor_v<Executor>>>
+    auto get_many_auto_waste(const Executor& executor, std::size_t count, CompletionToken&& token,
+                             time_traits::duration wait_duration = time_traits::duration(0),
+                             batch_mode mode = batch_mode::all) {
+        return async_initiate<std::vector<handle>>(std::forward<CompletionToken>(token),
+            [this, executor, count, wait_duration, mode] (auto handler) {
+                get_handles(executor, count, std::move(handler), &handle::waste, wait_duration, mode);
+            });
+    }
+
+    template <class Executor, class CompletionToken, class = std::enable_if_t<detail::is_executor_v<Executor>>>
+    auto get_many_auto_recycle(const Executor& executor, std::size_t count, CompletionToken&& token,
+                               time_traits::duration wait_duration = time_traits::duration(0),
+                               batch_mode mode = batch_mode::all) {
+        return async_initiate<std::vector<handle>>(std::forward<CompletionToken>(token),
+            [this, executor, count, wait_duration, mode] (auto handler) {
+                get_handles(executor, count, std::move(handler), &handle::recycle, wait_duration, mode);
+            });
+    }
+
+    // Completes with static_handle, Strategy is auto_recycle or auto_waste.
+    template <class Strategy, class CompletionToken>
+    auto get(io_context_t& io_context, CompletionToken&& token,
+             time_traits::duration wait_duration = time_traits::duration(0),
+             completion_mode mode = completion_mode::post) {
+        return async_initiate<static_handle<Strategy>>(std::forward<CompletionToken>(token),
+            [this, &io_context, wait_duration, mode] (auto handler) {
+                get_handle(io_context, std::move(handler), Strategy {}, wait_duration, mode);
+            });
+    }
+
+    template <class Strategy, class Executor, class CompletionToken,
+              class = std::enable_if_t<detail::is_executor_v<Executor>>>
+    auto get(const Executor& executor, CompletionToken&& token,
+             time_traits::duration wait_duration = time_traits::duration(0),
+             completion_mode mode = completion_mode::post) {
+        return async_initiate<static_handle<Strategy>>(std::forward<CompletionToken>(token),
+            [this, executor, wait_duration, mode] (auto handler) {
+                get_handle(executor, std::move(handler), Strategy {}, wait_duration, mode);
+            });
+    }
+
+    // Returns handle to resource available without waiting, otherwise unusable handle.
+    handle try_get_auto_waste() {
+        return try_get_handle<handle>(&handle::waste);
+    }
+
+    handle try_get_auto_recycle() {
+        return try_get_handle<handle>(&handle::recycle);
+    }
+
+    template <class Strategy>
+    static_handle<Strategy> try_get() {
+        return try_get_handle<static_handle<Strategy>>(Strategy {});
+    }
+
+    // Returns auto waste handle to empty cell when pool has less than min_available
+    // available resources, otherwise unusable handle. Used to create resources in advance.
+    handle try_get_empty(std::size_t min_available) {
+        const auto cell = _impl->try_lease_empty(min_available);
+        return cell ? handle(_impl.get(), &handle::waste, *cell) : handle();
+    }
+
+#if defined(BOOST_ASIO_HAS_CO_AWAIT)
+    // Awaitable get, resource available without waiting is returned without posting
+    // to io_context. Errors are thrown as boost::system::system_error.
+    boost::asio::awaitable<handle> co_get_auto_waste(io_context_t& io_context,
+            time_traits::duration wait_duration = time_traits::duration(0)) {
+        return co_get(io_context, &handle::waste, wait_duration);
+    }
+
+    boost::asio::awaitable<handle> co_get_auto_recycle(io_context_t& io_context,
+            time_traits::duration wait_duration = time_traits::duration(0)) {
+        return co_get(io_context, &handle::recycle, wait_duration);
+    }
+#endif
+
+    // Returns resources of usable handles from range to the pool under single lock, queued requests
+    // are served by one post per io_context.
+    // Handles of other pools are returned one by one.
+    template <class Range>
+    void recycle_all(Range&& handles) {
+        _impl->recycle_many(resource_pool::detail::take_cells(_impl.get(), handles,
+            [] (auto& handle) { handle.recycle(); }));
+    }
+
+    template <class Range>
+    void waste_all(Range&& handles) {
+        _impl->waste_many(resource_pool::detail::take_cells(_impl.get(), handles,
+            [] (auto& handle) { handle.waste(); }));
     }
 
     void invalidate() {
         _impl->invalidate();
     }
 
+    template <class Executor>
+    void start_reaper(Executor&& executor, time_traits::duration interval) {
+        stop_reaper();
+        _reaper = std::make_shared<reaper>(std::forward<Executor>(executor), _impl, interval);
+        _reaper->start();
+    }
+
+    void stop_reaper() {
+        if (_reaper) {
+            _reaper->stop();
+            _reaper.reset();
+        }
+    }
+
 private:
     using list_iterator = typename pool_impl::list_iterator;
+    using reaper = detail::reaper<pool_impl>;
 
-    template <typename CompletionToken>
-    using async_completion = detail::async_completion<CompletionToken, void (boost::system::error_code, handle)>;
+    template <class Handle, class CompletionToken, class Initiation>
+    static auto async_initiate(CompletionToken&& token, Initiation&& initiation) {
+        return detail::async_initiate<void (boost::system::error_code, Handle)>(
+            std::forward<Initiation>(initiation), std::forward<CompletionToken>(token));
+    }
 
     template <class UseStrategy, class Handler>
     class on_get_handler {
-        std::shared_ptr<pool_impl> impl;
+        pool_impl* impl;
         UseStrategy use_strategy;
         Handler handler;
 
@@ -136,42 +356,144 @@ private:
         using executor_type = std::decay_t<decltype(asio::get_associated_executor(handler))>;
 
         template <class HandlerT>
-        on_get_handler(std::shared_ptr<pool_impl> impl, UseStrategy use_strategy, HandlerT&& handler)
-            : impl(std::move(impl)),
+        on_get_handler(pool_impl* impl, UseStrategy use_strategy, HandlerT&& handler)
+            : impl(impl),
               use_strategy(std::move(use_strategy)),
               handler(std::forward<HandlerT>(handler)) {
             static_assert(std::is_same<std::decay_t<HandlerT>, Handler>::value, "HandlerT is not Handler");
         }
 
+        using handle_type = std::conditional_t<
+            std::is_same_v<UseStrategy, typename handle::strategy>,
+            handle,
+            static_handle<UseStrategy>
+        >;
+
         void operator ()(boost::system::error_code ec, list_iterator res) {
+            detail::clear_cancellation_slot(handler);
             if (ec) {
-                handler(ec, handle());
-            } else {
+                handler(ec, handle_type());
+            } else if constexpr (std::is_same_v<handle_type, handle>) {
                 handler(ec, handle(impl, use_strategy, std::move(res)));
+            } else {
+                handler(ec, handle_type(impl, std::move(res)));
+            }
+        }
+
+        auto get_executor() const noexcept {
+            return asio::get_associated_executor(handler);
+        }
+
+        template <class H = Handler, class = std::enable_if_t<detail::has_cancellation_slot_v<H>>>
+        auto get_cancellation_slot() const noexcept {
+            return detail::get_cancellation_slot(handler);
+        }
+    };
+
+    template <class Handler>
+    class on_get_many_handler {
+        pool_impl* impl;
+        typename handle::strategy use_strategy;
+        Handler handler;
+
+    public:
+        using executor_type = std::decay_t<decltype(asio::get_associated_executor(handler))>;
+
+        template <class HandlerT>
+        on_get_many_handler(pool_impl* impl, typename handle::strategy use_strategy, HandlerT&& handler)
+            : impl(impl),
+              use_strategy(use_strategy),
+              handler(std::forward<HandlerT>(handler)) {
+            static_assert(std::is_same<std::decay_t<HandlerT>, Handler>::value, "HandlerT is not Handler");
+        }
+
+        void operator ()(boost::system::error_code ec, std::vector<list_iterator> cells) {
+            detail::clear_cancellation_slot(handler);
+            std::vector<handle> handles;
+            handles.reserve(cells.size());
+            for (const auto& cell : cells) {
+                handles.emplace_back(impl, use_strategy, cell);
             }
+            handler(ec, std::move(handles));
         }
 
         auto get_executor() const noexcept {
             return asio::get_associated_executor(handler);
         }
+        template <class H = Handler, class = std::enable_if_t<detail::has_cancellation_slot_v<H>>>
+        auto get_cancellation_slot() const noexcept {
+            return detail::get_cancellation_slot(handler);
+        }
     };
 
     template <class UseStrategy, class Handler>
     auto make_on_get_handler(UseStrategy&& use_strategy, Handler&& handler) {
         using result_type = on_get_handler<std::decay_t<UseStrategy>, std::decay_t<Handler>>;
-        return result_type(_impl, std::forward<UseStrategy>(use_strategy), std::forward<Handler>(handler));
+        return result_type(_impl.get(), std::forward<UseStrategy>(use_strategy), std::forward<Handler>(handler));
     }
 
     std::shared_ptr<pool_impl> _impl;
+    std::shared_ptr<reaper> _reaper;
 
-    template <class UseStrategy, class Handler>
-    void get(io_context_t &io_context, Handler&& handler, UseStrategy&& use_strategy, time_traits::duration wait_duration) {
+    template <class Context, class UseStrategy, class Handler>
+    void get_handle(Context& context, Handler&& handler, UseStrategy&& use_strategy, time_traits::duration wait_duration,
+                    completion_mode mode = completion_mode::post) {
+        if (mode == completion_mode::dispatch) {
+            if (const auto cell = _impl->try_lease()) {
+                detail::dispatch_completion(context,
+                    detail::on_list_iterator_handler(
+                        boost::system::error_code(),
+                        *cell,
+                        _impl.get(),
+                        make_on_get_handler(std::forward<UseStrategy>(use_strategy), std::forward<Handler>(handler))
+                    ));
+                return;
+            }
+        }
         _impl->get(
-            io_context,
+            context,
             make_on_get_handler(std::forward<UseStrategy>(use_strategy), std::forward<Handler>(handler)),
             wait_duration
         );
     }
+
+    template <class Handle, class UseStrategy>
+    Handle try_get_handle(UseStrategy use_strategy) {
+        const auto cell = _impl->try_lease();
+        if (!cell) {
+            return Handle();
+        }
+        if constexpr (std::is_same_v<Handle, handle>) {
+            return handle(_impl.get(), use_strategy, *cell);
+        } else {
+            return Handle(_impl.get(), *cell);
+        }
+    }
+
+#if defined(BOOST_ASIO_HAS_CO_AWAIT)
+    boost::asio::awaitable<handle> co_get(io_context_t& io_context, typename handle::strategy use_strategy,
+                                          time_traits::duration wait_duration) {
+        if (auto result = try_get_handle<handle>(use_strategy); !result.unusable()) {
+            co_return result;
+        }
+        co_return co_await async_initiate<handle>(boost::asio::use_awaitable,
+            [this, &io_context, use_strategy, wait_duration] (auto handler) {
+                get_handle(io_context, std::move(handler), use_strategy, wait_duration);
+            });
+    }
+#endif
+
+    template <class Context, class Handler>
+    void get_handles(Context& context, std::size_t count, Handler&& handler,
+                     typename handle::strategy use_strategy, time_traits::duration wait_duration, batch_mode mode) {
+        _impl->get_many(
+            context,
+            count,
+            on_get_many_handler<std::decay_t<Handler>>(_impl.get(), use_strategy, std::forward<Handler>(handler)),
+            wait_duration,
+            mode
+        );
+    }
 };
 
 } // namespace async
@@ -0,0 +1,315 @@
+#ifndef YAMAIL_RESOURCE_POOL_ASYNC_SHARDED_POOL_HPP
+#define YAMAIL_RESOURCE_POOL_ASYNC_SHARDED_POOL_HPP
+
+#include <yamail/resource_pool/async/pool.hpp>
+#include <yamail/resource_pool/detail/thread_index.hpp>
+
+#include <vector>
+
+namespace yamail {
+namespace resource_pool {
+namespace async {
+
+// Partitions capacity across several pool implementations (shards) to reduce
+// lock contention. Get is served by the shard of the calling thread, if it has
+// no capacity a resource is stolen from other shards, otherwise request waits in
+// the queue shared by all shards and is served by a resource returned into any
+// of them. Shards without free cells are skipped without locking. Resource is
+// always returned into the shard it belongs to.
+template <class Value,
+          class Mutex = std::mutex,
+          class IoContext = boost::asio::io_context,
+          class Impl = typename default_pool_impl<Value, Mutex, IoContext>::type >
+class sharded_pool {
+public:
+    using value_type = Value;
+    using io_context_t = IoContext;
+    using pool_impl = Impl;
+    using handle = resource_pool::handle<value_type, typename pool_impl::list_iterator>;
+
+    // Shards share one queue with queue_capacity.
+    sharded_pool(std::size_t shards,
+                 std::size_t capacity,
+                 std::size_t queue_capacity,
+                 time_traits::duration idle_timeout = time_traits::duration::max(),
+                 time_traits::duration lifespan = time_traits::duration::max(),
+                 lease_order order = lease_order::fifo)
+            : _shards(make_shards(shards, capacity, [&, queue = shared_queue(queue_capacity)] (std::size_t shard_capacity) {
+                return std::make_shared<pool_impl>(shard_capacity, queue, idle_timeout, lifespan, order);
+            })) {}
+
+    template <class Generator>
+    sharded_pool(Generator&& gen_value,
+                 std::size_t shards,
+                 std::size_t capacity,
+                 std::size_t queue_capacity,
+                 time_traits::duration idle_timeout = time_traits::duration::max(),
+                 time_traits::duration lifespan = time_traits::duration::max(),
+                 lease_order order = lease_order::fifo)
+            : _shards(make_shards(shards, capacity, [&, queue = shared_queue(queue_capacity)] (std::size_t shard_capacity) {
+                return std::make_shared<pool_impl>(gen_value, shard_capacity, queue, idle_timeout, lifespan, order);
+            })) {}
+
+    sharded_pool(const sharded_pool&) = delete;
+    sharded_pool(sharded_pool&&) = default;
+
+    ~sharded_pool() {
+        for (const auto& shard : _shards) {
+            shard->disable();
+        }
+    }
+
+    sharded_pool& operator =(const sharded_pool&) = delete;
+    sharded_pool& operator =(sharded_pool&& other) {
+        if (this != &other) {
+            for (const auto& shard : _shards) {
+                shard->disable();
+            }
+            _shards = std::move(other._shards);
+        }
+        return *this;
+    }
+
+    std::size_t shards() const noexcept { return _shards.size(); }
+    std::size_t capacity() const noexcept { return sum([] (const auto& shard) { return shard.capacity(); }); }
+    std::size_t size() const noexcept { return sum([] (const auto& shard) { return shard.size(); }); }
+    std::size_t available() const noexcept { return sum([] (const auto& shard) { return shard.available(); }); }
+    std::size_t used() const noexcept { return sum([] (const auto& shard) { return shard.used(); }); }
+    async::stats stats() const noexcept;
+
+    const pool_impl& shard(std::size_t index) const noexcept { return *_shards[index]; }
+
+    // Index of the shard serving calling thread.
+    std::size_t local_shard() const noexcept { return resource_pool::detail::thread_index() % _shards.size(); }
+
+    template <class CompletionToken>
+    auto get_auto_waste(io_context_t& io_context, CompletionToken&& token,
+                        time_traits::duration wait_duration = time_traits::duration(0),
+                        completion_mode mode = completion_mode::post) {
+        return async_initiate(std::forward<CompletionToken>(token),
+            [this, &io_context, wait_duration, mode] (auto handler) {
+                get(io_context, std::move(handler), &handle::waste, wait_duration, mode);
+            });
+    }
+
+    template <class CompletionToken>
+    auto get_auto_recycle(io_context_t& io_context, CompletionToken&& token,
+                          time_traits::duration wait_duration = time_traits::duration(0),
+                          completion_mode mode = completion_mode::post) {
+        return async_initiate(std::forward<CompletionToken>(token),
+            [this, &io_context, wait_duration, mode] (auto handler) {
+                get(io_context, std::move(handler), &handle::recycle, wait_duration, mode);
+            });
+    }
+
+    // Handler without associated executor is completed on executor, timer of
+    // queued request runs on it too, so io_context is not required.
+    template <class Executor, class CompletionToken, class = std::enable_if_t<detail::is_executor_v<Executor>>>
+    auto get_auto_waste(const Executor& executor, CompletionToken&& token,
+                        time_traits::duration wait_duration = time_traits::duration(0),
+                        completion_mode mode = completion_mode::post) {
+        return async_initiate(std::forward<CompletionToken>(token),
+            [this, executor, wait_duration, mode] (auto handler) {
+                get(executor, std::move(handler), &handle::waste, wait_duration, mode);
+            });
+    }
+
+    template <class Executor, class CompletionToken, class = std::enable_if_t<detail::is_executor_v<Executor>>>
+    auto get_auto_recycle(const Executor& executor, CompletionToken&& token,
+                          time_traits::duration wait_duration = time_traits::duration(0),
+                          completion_mode mode = completion_mode::post) {
+        return async_initiate(std::forward<CompletionToken>(token),
+            [this, executor, wait_duration, mode] (auto handler) {
+                get(executor, std::move(handler), &handle::recycle, wait_duration, mode);
+            });
+    }
+
+    // Returns handle to resource available without waiting in any shard, otherwise
+    // unusable handle.
+    handle try_get_auto_waste() {
+        return try_get(&handle::waste);
+    }
+
+    handle try_get_auto_recycle() {
+        return try_get(&handle::recycle);
+    }
+
+    void invalidate() {
+        for (const auto& shard : _shards) {
+            shard->invalidate();
+        }
+    }
+
+private:
+    using list_iterator = typename pool_impl::list_iterator;
+    using shared_queue = typename pool_impl::shared_queue;
+    using pool_returns = typename handle::pool_returns;
+
+    template <class CompletionToken, class Initiation>
+    static auto async_initiate(CompletionToken&& token, Initiation&& initiation) {
+        return detail::async_initiate<void (boost::system::error_code, handle)>(
+            std::forward<Initiation>(initiation), std::forward<CompletionToken>(token));
+    }
+
+    // Queued request is served by any shard, it is told which one by owner.
+    template <class UseStrategy, class Handler>
+    class on_get_handler {
+        pool_returns* impl;
+        UseStrategy use_strategy;
+        Handler handler;
+
+    public:
+        using executor_type = std::decay_t<decltype(asio::get_associated_executor(handler))>;
+
+        template <class HandlerT>
+        on_get_handler(pool_returns* impl, UseStrategy use_strategy, HandlerT&& handler)
+            : impl(impl),
+              use_strategy(std::move(use_strategy)),
+              handler(std::forward<HandlerT>(handler)) {
+            static_assert(std::is_same<std::decay_t<HandlerT>, Handler>::value, "HandlerT is not Handler");
+        }
+
+        void operator ()(boost::system::error_code ec, list_iterator res) {
+            (*this)(ec, std::move(res), impl);
+        }
+
+        void operator ()(boost::system::error_code ec, list_iterator res, pool_returns* owner) {
+            detail::clear_cancellation_slot(handler);
+            if (ec) {
+                handler(ec, handle());
+            } else {
+                handler(ec, handle(owner, use_strategy, std::move(res)));
+            }
+        }
+
+        auto get_executor() const noexcept {
+            return asio::get_associated_executor(handler);
+        }
+
+        template <class H = Handler, class = std::enable_if_t<detail::has_cancellation_slot_v<H>>>
+        auto get_cancellation_slot() const noexcept {
+            return detail::get_cancellation_slot(handler);
+        }
+    };
+
+    std::vector<std::shared_ptr<pool_impl>> _shards;
+
+    template <class MakeShard>
+    static std::vector<std::shared_ptr<pool_impl>> make_shards(std::size_t shards, std::size_t capacity,
+                                                               MakeShard&& make_shard);
+
+    template <class Function>
+    std::size_t sum(Function&& function) const noexcept {
+        std::size_t result = 0;
+        for (const auto& shard : _shards) {
+            result += function(*shard);
+        }
+        return result;
+    }
+
+    template <class Context, class UseStrategy, class Handler>
+    void get(Context& context, Handler&& handler, UseStrategy&& use_strategy, time_traits::duration wait_duration,
+             completion_mode mode);
+
+    handle try_get(typename handle::strategy use_strategy);
+
+    std::pair<pool_impl*, boost::optional<list_iterator>> try_lease();
+};
+
+template <class V, class M, class I, class P>
+template <class MakeShard>
+std::vector<std::shared_ptr<typename sharded_pool<V, M, I, P>::pool_impl>> sharded_pool<V, M, I, P>::make_shards(
+        std::size_t shards, std::size_t capacity, MakeShard&& make_shard) {
+    if (shards == 0 || capacity < shards) {
+        throw error::zero_pool_capacity();
+    }
+    std::vector<std::shared_ptr<pool_impl>> result;
+    result.reserve(shards);
+    for (std::size_t i = 0; i < shards; ++i) {
+        result.emplace_back(make_shard(capacity / shards + (i < capacity % shards)));
+    }
+    return result;
+}
+
+template <class V, class M, class I, class P>
+async::stats sharded_pool<V, M, I, P>::stats() const noexcept {
+    async::stats result {0, 0, 0, 0};
+    for (const auto& shard : _shards) {
+        const auto stats = shard->stats();
+        result.size += stats.size;
+        result.available += stats.available;
+        result.used += stats.used;
+        result.queue_size = stats.queue_size;
+    }
+    return result;
+}
+
+template <class V, class M, class I, class P>
+template <class Context, class UseStrategy, class Handler>
+void sharded_pool<V, M, I, P>::get(Context& context, Handler&& handler, UseStrategy&& use_strategy,
+                                   time_traits::duration wait_duration, completion_mode mode) {
+    using result_type = on_get_handler<std::decay_t<UseStrategy>, std::decay_t<Handler>>;
+    const auto [shard, cell] = try_lease();
+    if (cell) {
+        auto completion = detail::on_list_iterator_handler(
+            boost::system::error_code(),
+            *cell,
+            shard,
+            result_type(shard, std::forward<UseStrategy>(use_strategy), std::forward<Handler>(handler))
+        );
+        if (mode == completion_mode::dispatch) {
+            detail::dispatch_completion(context, std::move(completion));
+        } else {
+            detail::post_completion(context, std::move(completion));
+        }
+        return;
+    }
+    const auto local = local_shard();
+    _shards[local]->get(
+        context,
+        result_type(_shards[local].get(), std::forward<UseStrategy>(use_strategy), std::forward<Handler>(handler)),
+        wait_duration
+    );
+    // Shard returning cell increases its free cells before it checks the queue,
+    // so either it finds queued request or it is found here.
+    for (const auto& shard : _shards) {
+        if (shard->free_cells() != 0) {
+            shard->serve_queued();
+        }
+    }
+}
+
+template <class V, class M, class I, class P>
+typename sharded_pool<V, M, I, P>::handle sharded_pool<V, M, I, P>::try_get(typename handle::strategy use_strategy) {
+    const auto [shard, cell] = try_lease();
+    if (!cell) {
+        return handle();
+    }
+    return handle(shard, use_strategy, *cell);
+}
+
+// Steals idle resource of any shard starting from local one before it takes
+// empty cell, so resource is created only when there is no idle one.
+template <class V, class M, class I, class P>
+std::pair<typename sharded_pool<V, M, I, P>::pool_impl*, boost::optional<typename sharded_pool<V, M, I, P>::list_iterator>>
+        sharded_pool<V, M, I, P>::try_lease() {
+    const auto local = local_shard();
+    for (const bool available_only : {true, false}) {
+        for (std::size_t i = 0; i < _shards.size(); ++i) {
+            const auto& shard = _shards[(local + i) % _shards.size()];
+            if (shard->free_cells() == 0) {
+                continue;
+            }
+            if (auto cell = available_only ? shard->try_lease_available() : shard->try_lease()) {
+                return {shard.get(), std::move(cell)};
+            }
+        }
+    }
+    return {nullptr, boost::none};
+}
+
+} // namespace async
+} // namespace resource_pool
+} // namespace yamail
+
+#endif // YAMAIL_RESOURCE_POOL_ASYNC_SHARDED_POOL_HPP
@@ -0,0 +1,15 @@
+#ifndef YAMAIL_RESOURCE_POOL_BATCH_MODE_HPP
+#define YAMAIL_RESOURCE_POOL_BATCH_MODE_HPP
+
+namespace yamail {
+namespace resource_pool {
+
+enum class batch_mode {
+    all, // complete when all requested resources are leased, otherwise return leased ones to the pool
+    partial, // complete when at least one resource is leased with as many as are available up to requested
+};
+
+} // namespace resource_pool
+} // namespace yamail
+
+#endif // YAMAIL_RESOURCE_POOL_BATCH_MODE_HPP
@@ -0,0 +1,148 @@
+#ifndef YAMAIL_RESOURCE_POOL_DETAIL_CELL_RING_HPP
+#define YAMAIL_RESOURCE_POOL_DETAIL_CELL_RING_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace yamail {
+namespace resource_pool {
+namespace detail {
+
+// Cell caches keep recycled cells out of storage to serve get without locking
+// pool mutex. Entry keeps generation of pool invalidation at the moment of recycle.
+
+// Disables cell cache.
+template <class ListIterator>
+struct no_cell_cache {
+    static constexpr bool enabled = false;
+
+    explicit no_cell_cache(std::size_t) {}
+};
+
+// Bounded lock-free multi producer multi consumer FIFO queue of cells
+// based on sequence numbers per slot. Capacity is rounded up to power of 2
+// and is at least 2, because sequence numbers of single slot are ambiguous.
+// Push may fail while concurrent pop of the same slot is not finished yet.
+template <class ListIterator>
+class cell_ring {
+public:
+    static constexpr bool enabled = true;
+
+    struct entry {
+        ListIterator cell;
+        std::uint64_t generation = 0;
+    };
+
+    explicit cell_ring(std::size_t capacity);
+
+    cell_ring(const cell_ring&) = delete;
+    cell_ring(cell_ring&&) = delete;
+
+    std::size_t capacity() const noexcept { return _mask + 1; }
+
+    // Number of cells, exact when there are no concurrent push or pop.
+    std::size_t size() const noexcept {
+        const auto result = _size.load(std::memory_order_relaxed);
+        return result > 0 ? static_cast<std::size_t>(result) : 0;
+    }
+
+    bool push(const entry& value) noexcept;
+    bool pop(entry& value) noexcept;
+
+    // Pops each entry once, pushes back ones satisfying keep, passes others to consume.
+    template <class Keep, class Consume>
+    void filter(Keep&& keep, Consume&& consume);
+
+private:
+    struct slot {
+        std::atomic<std::size_t> sequence;
+        entry value;
+    };
+
+    static constexpr std::size_t cache_line_size = 64;
+
+    const std::size_t _mask;
+    const std::unique_ptr<slot[]> _slots;
+    alignas(cache_line_size) std::atomic<std::size_t> _push_pos {0};
+    alignas(cache_line_size) std::atomic<std::size_t> _pop_pos {0};
+    alignas(cache_line_size) std::atomic<std::ptrdiff_t> _size {0};
+
+    static std::size_t round_up_to_power_of_2(std::size_t value) noexcept {
+        std::size_t result = 2;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+};
+
+template <class I>
+cell_ring<I>::cell_ring(std::size_t capacity)
+        : _mask(round_up_to_power_of_2(capacity) - 1),
+          _slots(std::make_unique<slot[]>(_mask + 1)) {
+    for (std::size_t i = 0; i <= _mask; ++i) {
+        _slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+template <class I>
+bool cell_ring<I>::push(const entry& value) noexcept {
+    auto pos = _push_pos.load(std::memory_order_relaxed);
+    while (true) {
+        auto& target = _slots[pos & _mask];
+        const auto sequence = target.sequence.load(std::memory_order_acquire);
+        const auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+        if (diff == 0) {
+            if (_push_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                target.value = value;
+                target.sequence.store(pos + 1, std::memory_order_release);
+                _size.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = _push_pos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+template <class I>
+bool cell_ring<I>::pop(entry& value) noexcept {
+    auto pos = _pop_pos.load(std::memory_order_relaxed);
+    while (true) {
+        auto& target = _slots[pos & _mask];
+        const auto sequence = target.sequence.load(std::memory_order_acquire);
+        const auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos + 1);
+        if (diff == 0) {
+            if (_pop_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                value = target.value;
+                target.sequence.store(pos + _mask + 1, std::memory_order_release);
+                _size.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = _pop_pos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+template <class I>
+template <class Keep, class Consume>
+void cell_ring<I>::filter(Keep&& keep, Consume&& consume) {
+    entry value;
+    for (auto count = size(); count > 0 && pop(value); --count) {
+        if (!keep(value) || !push(value)) {
+            consume(value);
+        }
+    }
+}
+
+} // namespace detail
+} // namespace resource_pool
+} // namespace yamail
+
+#endif // YAMAIL_RESOURCE_POOL_DETAIL_CELL_RING_HPP
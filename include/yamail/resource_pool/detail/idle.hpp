@@ -5,6 +5,8 @@
 
 #include <boost/optional.hpp>
 
+#include <cstdint>
+
 namespace yamail {
 namespace resource_pool {
 namespace detail {
@@ -17,6 +19,7 @@ struct idle {
     time_traits::time_point drop_time;
     time_traits::time_point reset_time;
     bool waste_on_recycle = false;
+    std::uint64_t generation = 0; // pool invalidation generation at the moment of lease
 
     idle(time_traits::time_point drop_time = time_traits::time_point::max())
         : drop_time(drop_time) {}
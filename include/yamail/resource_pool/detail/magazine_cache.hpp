@@ -0,0 +1,205 @@
+#ifndef YAMAIL_RESOURCE_POOL_DETAIL_MAGAZINE_CACHE_HPP
+#define YAMAIL_RESOURCE_POOL_DETAIL_MAGAZINE_CACHE_HPP
+
+#include <yamail/resource_pool/detail/cell_ring.hpp>
+#include <yamail/resource_pool/detail/thread_index.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace yamail {
+namespace resource_pool {
+namespace detail {
+
+// LIFO stack of at most MaxCapacity cells guarded by spin lock. Lock is held
+// only to move entries, so it is almost never contended by more than the owning thread.
+template <class ListIterator, std::size_t MaxCapacity>
+class cell_stack {
+public:
+    using entry = typename cell_ring<ListIterator>::entry;
+
+    explicit cell_stack(std::size_t capacity) noexcept
+            : _capacity(std::min(capacity, MaxCapacity)) {}
+
+    cell_stack(const cell_stack&) = delete;
+    cell_stack(cell_stack&&) = delete;
+
+    std::size_t capacity() const noexcept { return _capacity; }
+
+    // Number of cells, exact when there are no concurrent push or pop.
+    std::size_t size() const noexcept { return _size.load(std::memory_order_relaxed); }
+
+    bool push(const entry& value) noexcept;
+    bool pop(entry& value) noexcept;
+
+    // Keeps entries satisfying keep in the same order, passes others to consume
+    // after the lock is released. Returns number of consumed entries.
+    template <class Keep, class Consume>
+    std::size_t filter(Keep&& keep, Consume&& consume);
+
+private:
+    const std::size_t _capacity;
+    std::atomic_flag _locked = ATOMIC_FLAG_INIT;
+    std::atomic<std::size_t> _size {0};
+    std::array<entry, MaxCapacity> _entries;
+
+    void lock() noexcept {
+        while (_locked.test_and_set(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+    }
+
+    void unlock() noexcept { _locked.clear(std::memory_order_release); }
+};
+
+template <class I, std::size_t C>
+bool cell_stack<I, C>::push(const entry& value) noexcept {
+    lock();
+    const auto size = _size.load(std::memory_order_relaxed);
+    const bool result = size < _capacity;
+    if (result) {
+        _entries[size] = value;
+        _size.store(size + 1, std::memory_order_relaxed);
+    }
+    unlock();
+    return result;
+}
+
+template <class I, std::size_t C>
+bool cell_stack<I, C>::pop(entry& value) noexcept {
+    lock();
+    const auto size = _size.load(std::memory_order_relaxed);
+    const bool result = size > 0;
+    if (result) {
+        value = _entries[size - 1];
+        _size.store(size - 1, std::memory_order_relaxed);
+    }
+    unlock();
+    return result;
+}
+
+template <class I, std::size_t C>
+template <class Keep, class Consume>
+std::size_t cell_stack<I, C>::filter(Keep&& keep, Consume&& consume) {
+    std::array<entry, C> dropped;
+    std::size_t dropped_count = 0;
+    lock();
+    const auto size = _size.load(std::memory_order_relaxed);
+    std::size_t kept_count = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+        if (keep(_entries[i])) {
+            _entries[kept_count++] = _entries[i];
+        } else {
+            dropped[dropped_count++] = _entries[i];
+        }
+    }
+    _size.store(kept_count, std::memory_order_relaxed);
+    unlock();
+    for (std::size_t i = 0; i < dropped_count; ++i) {
+        consume(dropped[i]);
+    }
+    return dropped_count;
+}
+
+// Cell cache with small magazine per thread. Recycle pushes cell into magazine
+// of calling thread, get pops the most recently recycled one from it first, so
+// cell recycled and leased by the same thread stays in its cache lines.
+// Magazines of other threads are checked when local one is empty to not keep
+// idle cells from waiting requests, empty ones are skipped without locking.
+template <class ListIterator>
+class magazine_cache {
+public:
+    static constexpr bool enabled = true;
+    static constexpr std::size_t magazine_capacity = 8;
+
+    using magazine = cell_stack<ListIterator, magazine_capacity>;
+    using entry = typename magazine::entry;
+
+    explicit magazine_cache(std::size_t capacity,
+                            std::size_t magazines = std::max(1u, std::thread::hardware_concurrency()));
+
+    magazine_cache(const magazine_cache&) = delete;
+    magazine_cache(magazine_cache&&) = delete;
+
+    std::size_t magazines() const noexcept { return _magazines.size(); }
+
+    std::size_t size() const noexcept;
+
+    bool push(const entry& value) noexcept;
+    bool pop(entry& value) noexcept;
+
+    // Keeps entries satisfying keep in their magazines, passes others to consume.
+    template <class Keep, class Consume>
+    void filter(Keep&& keep, Consume&& consume);
+
+private:
+    std::vector<std::unique_ptr<magazine>> _magazines;
+    // Counted before push and after pop, so it is never less than number of
+    // cells in magazines and zero means there is nothing to take from other threads.
+    std::atomic<std::size_t> _size {0};
+
+    std::size_t local_index() const noexcept { return thread_index() % _magazines.size(); }
+    magazine& local() noexcept { return *_magazines[local_index()]; }
+};
+
+template <class I>
+magazine_cache<I>::magazine_cache(std::size_t capacity, std::size_t magazines) {
+    _magazines.reserve(magazines);
+    for (std::size_t i = 0; i < magazines; ++i) {
+        _magazines.emplace_back(std::make_unique<magazine>(capacity));
+    }
+}
+
+template <class I>
+std::size_t magazine_cache<I>::size() const noexcept {
+    return _size.load(std::memory_order_relaxed);
+}
+
+template <class I>
+bool magazine_cache<I>::push(const entry& value) noexcept {
+    _size.fetch_add(1, std::memory_order_relaxed);
+    if (!local().push(value)) {
+        _size.fetch_sub(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+template <class I>
+bool magazine_cache<I>::pop(entry& value) noexcept {
+    const auto local = local_index();
+    if (_magazines[local]->pop(value)) {
+        _size.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+    if (size() == 0) {
+        return false;
+    }
+    for (std::size_t i = 1; i < _magazines.size(); ++i) {
+        auto& other = *_magazines[(local + i) % _magazines.size()];
+        if (other.size() > 0 && other.pop(value)) {
+            _size.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+template <class I>
+template <class Keep, class Consume>
+void magazine_cache<I>::filter(Keep&& keep, Consume&& consume) {
+    for (const auto& v : _magazines) {
+        const auto consumed = v->filter(keep, consume);
+        _size.fetch_sub(consumed, std::memory_order_relaxed);
+    }
+}
+
+} // namespace detail
+} // namespace resource_pool
+} // namespace yamail
+
+#endif // YAMAIL_RESOURCE_POOL_DETAIL_MAGAZINE_CACHE_HPP
@@ -7,13 +7,13 @@ namespace yamail {
 namespace resource_pool {
 namespace detail {
 
-template <class T>
+template <class T, class CellIterator = cell_iterator<T>>
 struct pool_returns {
     virtual ~pool_returns() = default;
 
-    virtual void waste(cell_iterator<T> resource_iterator) = 0;
+    virtual void waste(CellIterator resource_iterator) = 0;
 
-    virtual void recycle(cell_iterator<T> resource_iterator) = 0;
+    virtual void recycle(CellIterator resource_iterator) = 0;
 };
 
 } // namespace detail
@@ -0,0 +1,331 @@
+#ifndef YAMAIL_RESOURCE_POOL_DETAIL_SLAB_STORAGE_HPP
+#define YAMAIL_RESOURCE_POOL_DETAIL_SLAB_STORAGE_HPP
+
+#include <yamail/resource_pool/time_traits.hpp>
+#include <yamail/resource_pool/detail/idle.hpp>
+#include <yamail/resource_pool/detail/storage.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace yamail {
+namespace resource_pool {
+namespace detail {
+
+enum class cell_state {
+    available,
+    used,
+    wasted,
+};
+
+template <class T>
+struct slab_cell : idle<T> {
+    using idle<T>::idle;
+
+    cell_state state = cell_state::wasted;
+    std::size_t prev = 0;
+    std::size_t next = 0;
+};
+
+// Keeps all cells in one contiguous array allocated once by constructor.
+// Available and wasted cells are linked into intrusive lists by indices,
+// used cells are tracked only by state.
+template <class T>
+class slab_storage {
+public:
+    using cell = slab_cell<T>;
+    using cell_iterator = cell*;
+    using const_cell_iterator = const cell*;
+
+    inline slab_storage(std::size_t capacity, time_traits::duration idle_timeout, time_traits::duration lifespan,
+                        lease_order order = lease_order::fifo);
+
+    template <class Generator>
+    inline slab_storage(Generator&& generator, std::size_t capacity, time_traits::duration idle_timeout, time_traits::duration lifespan,
+                        lease_order order = lease_order::fifo);
+
+    template <class InputIterator>
+    inline slab_storage(InputIterator begin, InputIterator end, time_traits::duration idle_timeout, time_traits::duration lifespan,
+                        lease_order order = lease_order::fifo);
+
+    slab_storage(const slab_storage& other) = delete;
+
+    slab_storage(slab_storage&& other) = default;
+
+    inline storage_stats stats() const;
+
+    inline boost::optional<cell_iterator> lease(std::vector<T>& dropped);
+
+    inline boost::optional<cell_iterator> lease_available(std::vector<T>& dropped);
+
+    inline boost::optional<cell_iterator> lease_wasted();
+
+    inline void recycle(cell_iterator cell, std::vector<T>& dropped);
+
+    inline void waste(cell_iterator cell, std::vector<T>& dropped);
+
+    inline bool is_valid(const_cell_iterator cell) const;
+
+    inline void invalidate(std::vector<T>& dropped);
+
+    inline void drop_expired(std::vector<T>& dropped);
+
+private:
+    static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+    struct cell_list {
+        std::size_t head = npos;
+        std::size_t tail = npos;
+        std::size_t size = 0;
+    };
+
+    time_traits::duration idle_timeout_;
+    time_traits::duration lifespan_;
+    lease_order order_;
+    std::vector<cell> cells_;
+    cell_list available_;
+    cell_list wasted_;
+    std::size_t used_ = 0;
+
+    std::size_t index(const_cell_iterator cell) const { return static_cast<std::size_t>(cell - cells_.data()); }
+    inline std::size_t lease_candidate() const;
+    inline void drop(std::size_t index, std::vector<T>& dropped);
+    inline void make_available(std::size_t index);
+    inline void push_back(cell_list& list, std::size_t index, cell_state state);
+    inline void insert(cell_list& list, std::size_t next, std::size_t index, cell_state state);
+    inline void erase(cell_list& list, std::size_t index);
+};
+
+template <class T>
+slab_storage<T>::slab_storage(std::size_t capacity, time_traits::duration idle_timeout, time_traits::duration lifespan,
+                              lease_order order)
+        : idle_timeout_(idle_timeout),
+          lifespan_(lifespan),
+          order_(order),
+          cells_(capacity) {
+    for (std::size_t i = 0; i < cells_.size(); ++i) {
+        push_back(wasted_, i, cell_state::wasted);
+    }
+}
+
+template <class T>
+template <class Generator>
+slab_storage<T>::slab_storage(Generator&& generator, std::size_t capacity, time_traits::duration idle_timeout, time_traits::duration lifespan,
+                              lease_order order)
+        : idle_timeout_(idle_timeout), lifespan_(lifespan), order_(order) {
+    const auto now = time_traits::now();
+    const auto drop_time = std::min(time_traits::add(now, idle_timeout_), time_traits::add(now, lifespan_));
+    cells_.reserve(capacity);
+    for (std::size_t i = 0; i < capacity; ++i) {
+        cells_.emplace_back(generator(), drop_time, now);
+        push_back(available_, i, cell_state::available);
+    }
+}
+
+template <class T>
+template <class InputIterator>
+slab_storage<T>::slab_storage(InputIterator begin, InputIterator end, time_traits::duration idle_timeout, time_traits::duration lifespan,
+                              lease_order order)
+        : idle_timeout_(idle_timeout), lifespan_(lifespan), order_(order) {
+    const auto now = time_traits::now();
+    const auto drop_time = std::min(time_traits::add(now, idle_timeout_), time_traits::add(now, lifespan_));
+    std::for_each(begin, end, [&] (auto&& v) {
+        cells_.emplace_back(std::forward<decltype(v)>(v), drop_time, now);
+    });
+    for (std::size_t i = 0; i < cells_.size(); ++i) {
+        push_back(available_, i, cell_state::available);
+    }
+}
+
+template <class T>
+storage_stats slab_storage<T>::stats() const {
+    storage_stats result;
+    result.available = available_.size;
+    result.used = used_;
+    result.wasted = wasted_.size;
+    return result;
+}
+
+template <class T>
+boost::optional<typename slab_storage<T>::cell_iterator> slab_storage<T>::lease(std::vector<T>& dropped) {
+    if (const auto cell = lease_available(dropped)) {
+        return cell;
+    }
+    return lease_wasted();
+}
+
+// Leases not expired available cell without falling back to wasted one.
+template <class T>
+boost::optional<typename slab_storage<T>::cell_iterator> slab_storage<T>::lease_available(std::vector<T>& dropped) {
+    const auto now = time_traits::now();
+    while (available_.head != npos && cells_[available_.head].drop_time <= now) {
+        drop(available_.head, dropped);
+    }
+    while (available_.head != npos) {
+        const auto candidate = lease_candidate();
+        cell& c = cells_[candidate];
+        if (c.drop_time > now) {
+            erase(available_, candidate);
+            c.state = cell_state::used;
+            ++used_;
+            return &c;
+        }
+        drop(candidate, dropped);
+    }
+    return {};
+}
+
+template <class T>
+boost::optional<typename slab_storage<T>::cell_iterator> slab_storage<T>::lease_wasted() {
+    if (wasted_.head == npos) {
+        return {};
+    }
+    const auto result = wasted_.head;
+    cell& c = cells_[result];
+    erase(wasted_, result);
+    c.waste_on_recycle = false;
+    c.state = cell_state::used;
+    ++used_;
+    return &c;
+}
+
+template <class T>
+void slab_storage<T>::recycle(cell_iterator cell, std::vector<T>& dropped) {
+    if (cell->waste_on_recycle) {
+        return waste(cell, dropped);
+    }
+    const auto now = time_traits::now();
+    const auto life_end = time_traits::add(cell->reset_time, lifespan_);
+    if (life_end <= now) {
+        return waste(cell, dropped);
+    }
+    cell->drop_time = std::min(time_traits::add(now, idle_timeout_), life_end);
+    --used_;
+    make_available(index(cell));
+}
+
+template <class T>
+void slab_storage<T>::waste(cell_iterator cell, std::vector<T>& dropped) {
+    drop_value(*cell, dropped);
+    --used_;
+    push_back(wasted_, index(cell), cell_state::wasted);
+}
+
+template <class T>
+bool slab_storage<T>::is_valid(const_cell_iterator cell) const {
+    if (cell->waste_on_recycle) {
+        return false;
+    }
+    const auto now = time_traits::now();
+    const auto life_end = time_traits::add(cell->reset_time, lifespan_);
+    if (life_end <= now) {
+        return false;
+    }
+    return true;
+}
+
+template <class T>
+void slab_storage<T>::invalidate(std::vector<T>& dropped) {
+    while (available_.head != npos) {
+        drop(available_.head, dropped);
+    }
+    for (auto& cell : cells_) {
+        if (cell.state == cell_state::used) {
+            cell.waste_on_recycle = true;
+        }
+    }
+}
+
+template <class T>
+void slab_storage<T>::drop_expired(std::vector<T>& dropped) {
+    const auto now = time_traits::now();
+    for (auto i = available_.head; i != npos;) {
+        const auto next = cells_[i].next;
+        if (cells_[i].drop_time <= now) {
+            drop(i, dropped);
+        }
+        i = next;
+    }
+}
+
+template <class T>
+std::size_t slab_storage<T>::lease_candidate() const {
+    switch (order_) {
+        case lease_order::fifo:
+            break;
+        case lease_order::lifo:
+        case lease_order::youngest:
+            return available_.tail;
+    }
+    return available_.head;
+}
+
+template <class T>
+void slab_storage<T>::drop(std::size_t index, std::vector<T>& dropped) {
+    drop_value(cells_[index], dropped);
+    erase(available_, index);
+    push_back(wasted_, index, cell_state::wasted);
+}
+
+// With youngest order available cells are kept sorted by reset time, so the
+// youngest one is the tail.
+template <class T>
+void slab_storage<T>::make_available(std::size_t index) {
+    auto next = npos;
+    if (order_ == lease_order::youngest) {
+        auto prev = available_.tail;
+        while (prev != npos && cells_[index].reset_time < cells_[prev].reset_time) {
+            next = prev;
+            prev = cells_[prev].prev;
+        }
+    }
+    insert(available_, next, index, cell_state::available);
+}
+
+template <class T>
+void slab_storage<T>::push_back(cell_list& list, std::size_t index, cell_state state) {
+    insert(list, npos, index, state);
+}
+
+// Inserts cell before next, npos means the end of the list.
+template <class T>
+void slab_storage<T>::insert(cell_list& list, std::size_t next, std::size_t index, cell_state state) {
+    cell& c = cells_[index];
+    c.state = state;
+    c.prev = next == npos ? list.tail : cells_[next].prev;
+    c.next = next;
+    if (c.prev == npos) {
+        list.head = index;
+    } else {
+        cells_[c.prev].next = index;
+    }
+    if (next == npos) {
+        list.tail = index;
+    } else {
+        cells_[next].prev = index;
+    }
+    ++list.size;
+}
+
+template <class T>
+void slab_storage<T>::erase(cell_list& list, std::size_t index) {
+    cell& c = cells_[index];
+    if (c.prev == npos) {
+        list.head = c.next;
+    } else {
+        cells_[c.prev].next = c.next;
+    }
+    if (c.next == npos) {
+        list.tail = c.prev;
+    } else {
+        cells_[c.next].prev = c.prev;
+    }
+    --list.size;
+}
+
+} // namespace detail
+} // namespace resource_pool
+} // namespace yamail
+
+#endif // YAMAIL_RESOURCE_POOL_DETAIL_SLAB_STORAGE_HPP
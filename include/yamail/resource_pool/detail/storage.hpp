@@ -1,11 +1,13 @@
 #pragma once
 
 #include <yamail/resource_pool/error.hpp>
+#include <yamail/resource_pool/lease_order.hpp>
 #include <yamail/resource_pool/time_traits.hpp>
 #include <yamail/resource_pool/detail/idle.hpp>
 
 #include <algorithm>
 #include <list>
+#include <vector>
 
 namespace yamail {
 namespace resource_pool {
@@ -17,19 +19,31 @@ struct storage_stats {
     std::size_t wasted;
 };
 
+// Moves value out of the cell, so it could be destroyed later outside of a lock.
+template <class T>
+void drop_value(idle<T>& cell, std::vector<T>& dropped) {
+    if (cell.value) {
+        dropped.emplace_back(std::move(*cell.value));
+        cell.value.reset();
+    }
+}
+
 template <class T>
 class storage {
 public:
     using cell_iterator = typename std::list<idle<T>>::iterator;
     using const_cell_iterator = typename std::list<idle<T>>::iterator;
 
-    inline storage(std::size_t capacity, time_traits::duration idle_timeout, time_traits::duration lifespan);
+    inline storage(std::size_t capacity, time_traits::duration idle_timeout, time_traits::duration lifespan,
+                   lease_order order = lease_order::fifo);
 
     template <class Generator>
-    inline storage(Generator&& generator, std::size_t capacity, time_traits::duration idle_timeout, time_traits::duration lifespan);
+    inline storage(Generator&& generator, std::size_t capacity, time_traits::duration idle_timeout, time_traits::duration lifespan,
+                   lease_order order = lease_order::fifo);
 
     template <class InputIterator>
-    inline storage(InputIterator begin, InputIterator end, time_traits::duration idle_timeout, time_traits::duration lifespan);
+    inline storage(InputIterator begin, InputIterator end, time_traits::duration idle_timeout, time_traits::duration lifespan,
+                   lease_order order = lease_order::fifo);
 
     storage(const storage& other) = delete;
 
@@ -37,22 +51,33 @@ public:
 
     inline storage_stats stats() const;
 
-    inline boost::optional<cell_iterator> lease();
+    inline boost::optional<cell_iterator> lease(std::vector<T>& dropped);
 
-    inline void recycle(cell_iterator cell);
+    inline boost::optional<cell_iterator> lease_available(std::vector<T>& dropped);
 
-    inline void waste(cell_iterator cell);
+    inline boost::optional<cell_iterator> lease_wasted();
+
+    inline void recycle(cell_iterator cell, std::vector<T>& dropped);
+
+    inline void waste(cell_iterator cell, std::vector<T>& dropped);
 
     inline bool is_valid(const_cell_iterator cell) const;
 
-    inline void invalidate();
+    inline void invalidate(std::vector<T>& dropped);
+
+    inline void drop_expired(std::vector<T>& dropped);
 
 private:
     time_traits::duration idle_timeout_;
     time_traits::duration lifespan_;
+    lease_order order_;
     std::list<idle<T>> available_;
     std::list<idle<T>> used_;
     std::list<idle<T>> wasted_;
+
+    inline cell_iterator lease_candidate();
+    inline void make_available(cell_iterator cell);
+    inline void drop(cell_iterator cell, std::vector<T>& dropped);
 };
 
 template <class T>
@@ -62,16 +87,19 @@ template <class CellIterator>
 using cell_value = typename CellIterator::value_type::value_type;
 
 template <class T>
-storage<T>::storage(std::size_t capacity, time_traits::duration idle_timeout, time_traits::duration lifespan)
+storage<T>::storage(std::size_t capacity, time_traits::duration idle_timeout, time_traits::duration lifespan,
+                    lease_order order)
         : idle_timeout_(idle_timeout),
           lifespan_(lifespan),
+          order_(order),
           wasted_(capacity) {
 }
 
 template <class T>
 template <class Generator>
-storage<T>::storage(Generator&& generator, std::size_t capacity, time_traits::duration idle_timeout, time_traits::duration lifespan)
-        : idle_timeout_(idle_timeout), lifespan_(lifespan) {
+storage<T>::storage(Generator&& generator, std::size_t capacity, time_traits::duration idle_timeout, time_traits::duration lifespan,
+                    lease_order order)
+        : idle_timeout_(idle_timeout), lifespan_(lifespan), order_(order) {
     const auto now = time_traits::now();
     const auto drop_time = std::min(time_traits::add(now, idle_timeout_), time_traits::add(now, lifespan_));
     for (std::size_t i = 0; i < capacity; ++i) {
@@ -81,8 +109,9 @@ storage<T>::storage(Generator&& generator, std::size_t capacity, time_traits::du
 
 template <class T>
 template <class InputIterator>
-storage<T>::storage(InputIterator begin, InputIterator end, time_traits::duration idle_timeout, time_traits::duration lifespan)
-        : idle_timeout_(idle_timeout), lifespan_(lifespan) {
+storage<T>::storage(InputIterator begin, InputIterator end, time_traits::duration idle_timeout, time_traits::duration lifespan,
+                    lease_order order)
+        : idle_timeout_(idle_timeout), lifespan_(lifespan), order_(order) {
     const auto now = time_traits::now();
     const auto drop_time = std::min(time_traits::add(now, idle_timeout_), time_traits::add(now, lifespan_));
     std::for_each(begin, end, [&] (auto&& v) {
@@ -100,43 +129,85 @@ storage_stats storage<T>::stats() const {
 }
 
 template <class T>
-boost::optional<typename storage<T>::cell_iterator> storage<T>::lease() {
+boost::optional<typename storage<T>::cell_iterator> storage<T>::lease(std::vector<T>& dropped) {
+    if (const auto cell = lease_available(dropped)) {
+        return cell;
+    }
+    return lease_wasted();
+}
+
+// Leases not expired available cell without falling back to wasted one.
+template <class T>
+boost::optional<typename storage<T>::cell_iterator> storage<T>::lease_available(std::vector<T>& dropped) {
     const auto now = time_traits::now();
+    while (!available_.empty() && available_.front().drop_time <= now) {
+        drop(available_.begin(), dropped);
+    }
     while (!available_.empty()) {
-        const auto candidate = available_.begin();
+        const auto candidate = lease_candidate();
         if (candidate->drop_time > now) {
             used_.splice(used_.end(), available_, candidate);
             return candidate;
         }
-        candidate->value.reset();
-        wasted_.splice(wasted_.end(), available_, candidate);
-    }
-    if (!wasted_.empty()) {
-        const auto result = wasted_.begin();
-        result->waste_on_recycle = false;
-        used_.splice(used_.end(), wasted_, result);
-        return result;
+        drop(candidate, dropped);
     }
     return {};
 }
 
 template <class T>
-void storage<T>::recycle(typename storage<T>::cell_iterator cell) {
+boost::optional<typename storage<T>::cell_iterator> storage<T>::lease_wasted() {
+    if (wasted_.empty()) {
+        return {};
+    }
+    const auto result = wasted_.begin();
+    result->waste_on_recycle = false;
+    used_.splice(used_.end(), wasted_, result);
+    return result;
+}
+
+template <class T>
+typename storage<T>::cell_iterator storage<T>::lease_candidate() {
+    switch (order_) {
+        case lease_order::fifo:
+            break;
+        case lease_order::lifo:
+        case lease_order::youngest:
+            return std::prev(available_.end());
+    }
+    return available_.begin();
+}
+
+template <class T>
+void storage<T>::recycle(typename storage<T>::cell_iterator cell, std::vector<T>& dropped) {
     if (cell->waste_on_recycle) {
-        return waste(cell);
+        return waste(cell, dropped);
     }
     const auto now = time_traits::now();
     const auto life_end = time_traits::add(cell->reset_time, lifespan_);
     if (life_end <= now) {
-        return waste(cell);
+        return waste(cell, dropped);
     }
     cell->drop_time = std::min(time_traits::add(now, idle_timeout_), life_end);
-    available_.splice(available_.end(), used_, cell);
+    make_available(cell);
+}
+
+// With youngest order available cells are kept sorted by reset time, so the
+// youngest one is at the end. Recycled cell is usually reset not earlier than
+// others and is inserted after few comparisons from the end.
+template <class T>
+void storage<T>::make_available(cell_iterator cell) {
+    auto position = available_.end();
+    if (order_ == lease_order::youngest) {
+        while (position != available_.begin() && cell->reset_time < std::prev(position)->reset_time) {
+            --position;
+        }
+    }
+    available_.splice(position, used_, cell);
 }
 
 template <class T>
-void storage<T>::waste(typename storage<T>::cell_iterator cell) {
-    cell->value.reset();
+void storage<T>::waste(typename storage<T>::cell_iterator cell, std::vector<T>& dropped) {
+    drop_value(*cell, dropped);
     wasted_.splice(wasted_.end(), used_, cell);
 }
 
@@ -154,9 +225,9 @@ bool storage<T>::is_valid(typename storage<T>::const_cell_iterator cell) const {
 }
 
 template <class T>
-void storage<T>::invalidate() {
+void storage<T>::invalidate(std::vector<T>& dropped) {
     for (auto& cell : available_) {
-        cell.value.reset();
+        drop_value(cell, dropped);
     }
     wasted_.splice(wasted_.end(), available_, available_.begin(), available_.end());
     for (auto& cell : used_) {
@@ -164,6 +235,24 @@ void storage<T>::invalidate() {
     }
 }
 
+template <class T>
+void storage<T>::drop_expired(std::vector<T>& dropped) {
+    const auto now = time_traits::now();
+    for (auto cell = available_.begin(); cell != available_.end();) {
+        const auto next = std::next(cell);
+        if (cell->drop_time <= now) {
+            drop(cell, dropped);
+        }
+        cell = next;
+    }
+}
+
+template <class T>
+void storage<T>::drop(cell_iterator cell, std::vector<T>& dropped) {
+    drop_value(*cell, dropped);
+    wasted_.splice(wasted_.end(), available_, cell);
+}
+
 } // namespace detail
 } // namespace resource_pool
 } // namespace yamail
@@ -0,0 +1,22 @@
+#ifndef YAMAIL_RESOURCE_POOL_DETAIL_THREAD_INDEX_HPP
+#define YAMAIL_RESOURCE_POOL_DETAIL_THREAD_INDEX_HPP
+
+#include <atomic>
+#include <cstddef>
+
+namespace yamail {
+namespace resource_pool {
+namespace detail {
+
+// Sequential number of calling thread assigned on first call.
+inline std::size_t thread_index() noexcept {
+    static std::atomic<std::size_t> next {0};
+    static thread_local const std::size_t index = next++;
+    return index;
+}
+
+} // namespace detail
+} // namespace resource_pool
+} // namespace yamail
+
+#endif // YAMAIL_RESOURCE_POOL_DETAIL_THREAD_INDEX_HPP
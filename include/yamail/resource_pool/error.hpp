@@ -26,6 +26,7 @@ enum code {
     get_resource_timeout,
     request_queue_overflow,
     disabled,
+    batch_exceeds_capacity,
 };
 
 namespace detail {
@@ -46,6 +47,8 @@ public:
                 return "request queue overflow";
             case disabled:
                 return "resource pool is disabled";
+            case batch_exceeds_capacity:
+                return "requested batch exceeds pool capacity";
         }
         std::ostringstream error;
         error << "no message for yamail::resource_pool::error: " << value;
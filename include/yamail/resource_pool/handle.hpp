@@ -7,26 +7,37 @@
 
 #include <boost/optional.hpp>
 
-#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace yamail {
 namespace resource_pool {
 
-template <class T>
+namespace detail {
+
+struct handle_access;
+
+} // namespace detail
+
+template <class T, class CellIterator = detail::cell_iterator<T>>
 class handle {
 public:
     using value_type = T;
     using strategy = void (handle::*)();
-    using list_iterator = detail::cell_iterator<value_type>;
+    using list_iterator = CellIterator;
+    using pool_returns = detail::pool_returns<value_type, list_iterator>;
 
     handle() = default;
     handle(const handle& other) = delete;
     handle(handle&& other);
 
-    handle(std::shared_ptr<detail::pool_returns<value_type>> pool_impl,
+    // Handle doesn't own pool implementation, disabled pool implementation
+    // keeps itself alive until all leased cells are returned.
+    handle(pool_returns* pool_impl,
            strategy use_strategy,
            list_iterator resource_it)
-            : _pool_impl(std::move(pool_impl)),
+            : _pool_impl(pool_impl),
               _use_strategy(use_strategy),
               _resource_it(resource_it) {}
 
@@ -49,7 +60,9 @@ public:
     void reset(value_type&& res);
 
 private:
-    std::shared_ptr<detail::pool_returns<value_type>> _pool_impl;
+    friend struct detail::handle_access;
+
+    pool_returns* _pool_impl = nullptr;
     strategy _use_strategy;
     boost::optional<list_iterator> _resource_it;
 
@@ -57,24 +70,24 @@ private:
     void assert_not_unusable() const;
 };
 
-template <class P>
-handle<P>::handle(handle&& other)
+template <class P, class I>
+handle<P, I>::handle(handle&& other)
     : _pool_impl(other._pool_impl),
       _use_strategy(other._use_strategy),
       _resource_it(other._resource_it) {
     other._resource_it = boost::none;
-    other._pool_impl.reset();
+    other._pool_impl = nullptr;
 }
 
-template <class P>
-handle<P>::~handle() {
+template <class P, class I>
+handle<P, I>::~handle() {
     if (!unusable()) {
         (this->*_use_strategy)();
     }
 }
 
-template <class P>
-handle<P>& handle<P>::operator =(handle&& other) {
+template <class P, class I>
+handle<P, I>& handle<P, I>::operator =(handle&& other) {
     if (!unusable()) {
         (this->*_use_strategy)();
     }
@@ -82,57 +95,215 @@ handle<P>& handle<P>::operator =(handle&& other) {
     _use_strategy = other._use_strategy;
     _resource_it = other._resource_it;
     other._resource_it = boost::none;
-    other._pool_impl.reset();
+    other._pool_impl = nullptr;
     return *this;
 }
 
-template <class P>
-typename handle<P>::value_type& handle<P>::get() {
+template <class P, class I>
+typename handle<P, I>::value_type& handle<P, I>::get() {
     assert_not_empty();
     return *_resource_it.get()->value;
 }
 
-template <class P>
-const typename handle<P>::value_type& handle<P>::get() const {
+template <class P, class I>
+const typename handle<P, I>::value_type& handle<P, I>::get() const {
     assert_not_empty();
     return *_resource_it.get()->value;
 }
 
-template <class P>
-void handle<P>::recycle() {
+template <class P, class I>
+void handle<P, I>::recycle() {
     assert_not_unusable();
     _pool_impl->recycle(_resource_it.get());
     _resource_it = boost::none;
 }
 
-template <class P>
-void handle<P>::waste() {
+template <class P, class I>
+void handle<P, I>::waste() {
     assert_not_unusable();
     _pool_impl->waste(_resource_it.get());
     _resource_it = boost::none;
 }
 
-template <class P>
-void handle<P>::reset(value_type &&res) {
+template <class P, class I>
+void handle<P, I>::reset(value_type &&res) {
+    assert_not_unusable();
+    _resource_it.get()->value = std::move(res);
+    _resource_it.get()->reset_time = time_traits::now();
+}
+
+template <class P, class I>
+void handle<P, I>::assert_not_empty() const {
+    if (empty()) {
+        throw error::empty_handle();
+    }
+}
+
+template <class P, class I>
+void handle<P, I>::assert_not_unusable() const {
+    if (unusable()) {
+        throw error::unusable_handle();
+    }
+}
+
+// Handle strategies known at compile time.
+struct auto_recycle {};
+struct auto_waste {};
+
+// Handle returning cell to concrete pool implementation with strategy given by
+// tag type, so return path doesn't involve virtual or member pointer calls.
+template <class PoolImpl, class Strategy>
+class static_handle {
+    static_assert(std::is_same_v<Strategy, auto_recycle> || std::is_same_v<Strategy, auto_waste>,
+                  "Strategy is not auto_recycle or auto_waste");
+
+public:
+    using pool_impl = PoolImpl;
+    using strategy = Strategy;
+    using list_iterator = typename pool_impl::list_iterator;
+    using value_type = typename pool_impl::value_type;
+
+    static_handle() = default;
+    static_handle(const static_handle& other) = delete;
+
+    static_handle(static_handle&& other) noexcept
+        : _pool_impl(std::exchange(other._pool_impl, nullptr)),
+          _resource_it(std::exchange(other._resource_it, boost::none)) {}
+
+    static_handle(pool_impl* pool_impl, list_iterator resource_it)
+        : _pool_impl(pool_impl),
+          _resource_it(resource_it) {}
+
+    ~static_handle() {
+        release();
+    }
+
+    static_handle& operator =(const static_handle& other) = delete;
+
+    static_handle& operator =(static_handle&& other) {
+        release();
+        _pool_impl = std::exchange(other._pool_impl, nullptr);
+        _resource_it = std::exchange(other._resource_it, boost::none);
+        return *this;
+    }
+
+    bool unusable() const noexcept { return !static_cast<bool>(_resource_it); }
+    bool empty() const noexcept { return unusable() || !_resource_it.get()->value; }
+    value_type& get();
+    const value_type& get() const;
+    value_type *operator ->() { return &get(); }
+    const value_type *operator ->() const { return &get(); }
+    value_type &operator *() { return get(); }
+    const value_type &operator *() const { return get(); }
+
+    void recycle();
+    void waste();
+    void reset(value_type&& res);
+
+private:
+    friend struct detail::handle_access;
+
+    pool_impl* _pool_impl = nullptr;
+    boost::optional<list_iterator> _resource_it;
+
+    void release() {
+        if (unusable()) {
+            return;
+        }
+        if constexpr (std::is_same_v<strategy, auto_recycle>) {
+            recycle();
+        } else {
+            waste();
+        }
+    }
+
+    void assert_not_empty() const;
+    void assert_not_unusable() const;
+};
+
+template <class P, class S>
+typename static_handle<P, S>::value_type& static_handle<P, S>::get() {
+    assert_not_empty();
+    return *_resource_it.get()->value;
+}
+
+template <class P, class S>
+const typename static_handle<P, S>::value_type& static_handle<P, S>::get() const {
+    assert_not_empty();
+    return *_resource_it.get()->value;
+}
+
+template <class P, class S>
+void static_handle<P, S>::recycle() {
+    assert_not_unusable();
+    const auto resource_it = _resource_it.get();
+    _resource_it = boost::none;
+    _pool_impl->recycle(resource_it);
+}
+
+template <class P, class S>
+void static_handle<P, S>::waste() {
+    assert_not_unusable();
+    const auto resource_it = _resource_it.get();
+    _resource_it = boost::none;
+    _pool_impl->waste(resource_it);
+}
+
+template <class P, class S>
+void static_handle<P, S>::reset(value_type &&res) {
     assert_not_unusable();
     _resource_it.get()->value = std::move(res);
     _resource_it.get()->reset_time = time_traits::now();
 }
 
-template <class P>
-void handle<P>::assert_not_empty() const {
+template <class P, class S>
+void static_handle<P, S>::assert_not_empty() const {
     if (empty()) {
         throw error::empty_handle();
     }
 }
 
-template <class P>
-void handle<P>::assert_not_unusable() const {
+template <class P, class S>
+void static_handle<P, S>::assert_not_unusable() const {
     if (unusable()) {
         throw error::unusable_handle();
     }
 }
 
+namespace detail {
+
+struct handle_access {
+    template <class Handle, class PoolImpl>
+    static bool belongs_to(const Handle& handle, const PoolImpl* pool_impl) noexcept {
+        return !handle.unusable() && handle._pool_impl == pool_impl;
+    }
+
+    template <class Handle>
+    static auto release(Handle& handle) noexcept {
+        const auto resource_it = handle._resource_it.get();
+        handle._resource_it = boost::none;
+        return resource_it;
+    }
+};
+
+// Takes cells from usable handles of given pool implementation, handles of other
+// pools are released by release_other.
+template <class PoolImpl, class Range, class Release>
+std::vector<typename PoolImpl::list_iterator> take_cells(const PoolImpl* pool_impl, Range& handles,
+                                                         Release release_other) {
+    std::vector<typename PoolImpl::list_iterator> result;
+    for (auto& handle : handles) {
+        if (handle_access::belongs_to(handle, pool_impl)) {
+            result.push_back(handle_access::release(handle));
+        } else if (!handle.unusable()) {
+            release_other(handle);
+        }
+    }
+    return result;
+}
+
+} // namespace detail
+
 }
 }
 
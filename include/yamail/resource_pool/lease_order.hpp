@@ -0,0 +1,16 @@
+#ifndef YAMAIL_RESOURCE_POOL_LEASE_ORDER_HPP
+#define YAMAIL_RESOURCE_POOL_LEASE_ORDER_HPP
+
+namespace yamail {
+namespace resource_pool {
+
+enum class lease_order {
+    fifo, // least recently recycled resource first
+    lifo, // most recently recycled resource first
+    youngest, // most recently reset resource first, recycle takes linear time of available resources reset later
+};
+
+} // namespace resource_pool
+} // namespace yamail
+
+#endif // YAMAIL_RESOURCE_POOL_LEASE_ORDER_HPP
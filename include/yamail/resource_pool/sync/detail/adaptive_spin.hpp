@@ -0,0 +1,84 @@
+#ifndef YAMAIL_RESOURCE_POOL_SYNC_DETAIL_ADAPTIVE_SPIN_HPP
+#define YAMAIL_RESOURCE_POOL_SYNC_DETAIL_ADAPTIVE_SPIN_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+namespace yamail {
+namespace resource_pool {
+namespace sync {
+namespace detail {
+
+inline void cpu_relax() noexcept {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield" ::: "memory");
+#endif
+}
+
+struct no_spin {
+    static constexpr bool enabled = false;
+};
+
+// Bounded busy wait before parking on condition variable. Spin limit follows
+// twice the number of pauses after which waiter was served, so it grows while
+// resources are held shortly and shrinks while waiters are parked anyway.
+class adaptive_spin {
+public:
+    static constexpr bool enabled = true;
+    static constexpr std::size_t min_spins = 16;
+    static constexpr std::size_t default_max_spins = 4096;
+
+    explicit adaptive_spin(std::size_t max_spins = default_max_spins) noexcept
+        : _max_spins(std::max(max_spins, min_spins)),
+          _limit(min_spins) {}
+
+    adaptive_spin(const adaptive_spin&) = delete;
+    adaptive_spin(adaptive_spin&&) = delete;
+
+    std::size_t limit() const noexcept { return _limit.load(std::memory_order_relaxed); }
+
+    // Returns true when ready() becomes true within the spin limit.
+    template <class Ready>
+    bool spin(Ready&& ready) noexcept;
+
+private:
+    const std::size_t _max_spins;
+    std::atomic<std::size_t> _limit;
+
+    void adjust(std::size_t target) noexcept;
+};
+
+template <class Ready>
+bool adaptive_spin::spin(Ready&& ready) noexcept {
+    const auto limit = this->limit();
+    for (std::size_t spins = 0; spins < limit; ++spins) {
+        if (ready()) {
+            adjust(2 * spins);
+            return true;
+        }
+        cpu_relax();
+    }
+    adjust(limit / 2);
+    return false;
+}
+
+// Moves limit by 1/8 of the distance to target, concurrent updates may be lost.
+inline void adaptive_spin::adjust(std::size_t target) noexcept {
+    const auto limit = static_cast<std::ptrdiff_t>(this->limit());
+    const auto next = limit + (static_cast<std::ptrdiff_t>(target) - limit) / 8;
+    _limit.store(std::clamp(static_cast<std::size_t>(next), min_spins, _max_spins), std::memory_order_relaxed);
+}
+
+} // namespace detail
+} // namespace sync
+} // namespace resource_pool
+} // namespace yamail
+
+#endif // YAMAIL_RESOURCE_POOL_SYNC_DETAIL_ADAPTIVE_SPIN_HPP
@@ -1,15 +1,23 @@
 #ifndef YAMAIL_RESOURCE_POOL_SYNC_DETAIL_POOL_IMPL_HPP
 #define YAMAIL_RESOURCE_POOL_SYNC_DETAIL_POOL_IMPL_HPP
 
+#include <yamail/resource_pool/batch_mode.hpp>
 #include <yamail/resource_pool/error.hpp>
+#include <yamail/resource_pool/lease_order.hpp>
 #include <yamail/resource_pool/time_traits.hpp>
 #include <yamail/resource_pool/detail/idle.hpp>
 #include <yamail/resource_pool/detail/storage.hpp>
+#include <yamail/resource_pool/detail/cell_ring.hpp>
 #include <yamail/resource_pool/detail/pool_returns.hpp>
+#include <yamail/resource_pool/sync/detail/adaptive_spin.hpp>
 
+#include <algorithm>
+#include <atomic>
 #include <condition_variable>
 #include <list>
+#include <memory>
 #include <mutex>
+#include <vector>
 
 namespace yamail {
 namespace resource_pool {
@@ -19,47 +27,72 @@ struct stats {
     std::size_t size;
     std::size_t available;
     std::size_t used;
+    std::size_t queue_size;
 };
 
 namespace detail {
 
 using resource_pool::detail::pool_returns;
+using resource_pool::detail::no_cell_cache;
 
-template <class Value, class Mutex, class ConditionVariable>
-class pool_impl : public pool_returns<Value> {
+template <class Value,
+          class Mutex,
+          class ConditionVariable,
+          class Storage = resource_pool::detail::storage<Value>,
+          template <class> class CellCache = no_cell_cache,
+          class Spin = no_spin>
+class pool_impl : public pool_returns<Value, typename Storage::cell_iterator>,
+                  public std::enable_shared_from_this<pool_impl<Value, Mutex, ConditionVariable, Storage, CellCache, Spin>> {
 public:
     using value_type = Value;
     using condition_variable = ConditionVariable;
     using idle = resource_pool::detail::idle<value_type>;
-    using storage_type = resource_pool::detail::storage<value_type>;
+    using storage_type = Storage;
     using list_iterator = typename storage_type::cell_iterator;
     using get_result = std::pair<boost::system::error_code, list_iterator>;
+    using get_many_result = std::pair<boost::system::error_code, std::vector<list_iterator>>;
+    using cell_cache_type = CellCache<list_iterator>;
+    using spin_type = Spin;
 
-    pool_impl(std::size_t capacity, time_traits::duration idle_timeout, time_traits::duration lifespan)
-            : storage_(assert_capacity(capacity), idle_timeout, lifespan),
-              _capacity(capacity) {
+    pool_impl(std::size_t capacity,
+              time_traits::duration idle_timeout,
+              time_traits::duration lifespan,
+              lease_order order = lease_order::fifo)
+            : storage_(assert_capacity(capacity), idle_timeout, lifespan, order),
+              _capacity(capacity),
+              _idle_timeout(idle_timeout),
+              _lifespan(lifespan),
+              _cache(capacity) {
     }
 
     template <class Generator>
     pool_impl(Generator&& gen_value,
               std::size_t capacity,
               time_traits::duration idle_timeout,
-              time_traits::duration lifespan)
-            : storage_(std::forward<Generator>(gen_value), assert_capacity(capacity), idle_timeout, lifespan),
-              _capacity(capacity) {
+              time_traits::duration lifespan,
+              lease_order order = lease_order::fifo)
+            : storage_(std::forward<Generator>(gen_value), assert_capacity(capacity), idle_timeout, lifespan, order),
+              _capacity(capacity),
+              _idle_timeout(idle_timeout),
+              _lifespan(lifespan),
+              _cache(capacity) {
     }
 
     std::size_t capacity() const { return _capacity; }
+    const spin_type& spin() const { return _spin; }
     std::size_t size() const;
     std::size_t available() const;
     std::size_t used() const;
     sync::stats stats() const;
 
-    const condition_variable& has_capacity() const { return _has_capacity; }
-
     get_result get(time_traits::duration wait_duration = time_traits::duration(0));
+    get_many_result get_many(std::size_t count,
+                             time_traits::duration wait_duration = time_traits::duration(0),
+                             batch_mode mode = batch_mode::all);
     void recycle(list_iterator res_it) final;
     void waste(list_iterator res_it) final;
+    void recycle_many(const std::vector<list_iterator>& cells);
+    void waste_many(const std::vector<list_iterator>& cells);
     void disable();
     void invalidate();
 
@@ -69,18 +102,74 @@ private:
     using mutex_t = Mutex;
     using lock_guard = std::lock_guard<mutex_t>;
     using unique_lock = std::unique_lock<mutex_t>;
+    using cache_entry = typename resource_pool::detail::cell_ring<list_iterator>::entry;
+
+    // Waiting request leased by recycle or waste directly, cells are stored into
+    // caller's array. Waiter lives on the stack of waiting thread and is linked
+    // into the queue intrusively, so queueing doesn't allocate.
+    struct waiter {
+        condition_variable wake;
+        list_iterator* const cells;
+        const std::size_t count;
+        const batch_mode mode;
+        std::size_t leased = 0;
+        std::atomic<bool> served {false};
+        waiter* prev = nullptr;
+        waiter* next = nullptr;
+
+        waiter(list_iterator* cells, std::size_t count, batch_mode mode)
+            : cells(cells), count(count), mode(mode) {}
+
+        waiter(const waiter&) = delete;
+        waiter(waiter&&) = delete;
+    };
+
+    struct waiter_list {
+        waiter* head = nullptr;
+        waiter* tail = nullptr;
+        std::size_t size = 0;
+    };
+
+    struct waiter_guard {
+        std::atomic<std::size_t>& waiters;
+
+        waiter_guard(std::atomic<std::size_t>& waiters) : waiters(waiters) { ++waiters; }
+        ~waiter_guard() { --waiters; }
+    };
 
     mutable mutex_t _mutex;
     storage_type storage_;
     const std::size_t _capacity;
-    condition_variable _has_capacity;
-    bool _disabled = false;
+    const time_traits::duration _idle_timeout;
+    const time_traits::duration _lifespan;
+    std::atomic<bool> _disabled {false};
+    cell_cache_type _cache;
+    std::atomic<std::uint64_t> _generation {0};
+    std::atomic<std::size_t> _waiters {0};
+    waiter_list _queue;
+    spin_type _spin;
+    std::shared_ptr<pool_impl> _self;
 
-    bool wait_for(unique_lock& lock, time_traits::duration wait_duration);
+    get_result get_locked(time_traits::duration wait_duration);
+    boost::system::error_code acquire(waiter& w, time_traits::duration wait_duration);
+    bool lease_for(waiter& w, std::vector<value_type>& dropped);
+    boost::optional<list_iterator> lease_locked(std::vector<value_type>& dropped);
+    void serve_locked(std::vector<value_type>& dropped);
+    void push_waiter(waiter& w);
+    void erase_waiter(waiter& w);
+    void recycle_locked(list_iterator res_it);
+    void return_many(const std::vector<list_iterator>& cells, bool recycle);
+    bool wait_for(unique_lock& lock, waiter& w, time_traits::time_point deadline);
+    bool try_recycle_cached(list_iterator res_it);
+    boost::optional<list_iterator> lease_cached();
+    boost::optional<list_iterator> lease_cached(std::vector<value_type>& dropped);
+    std::size_t cached() const noexcept;
+    std::shared_ptr<pool_impl> keep_alive() const;
+    std::shared_ptr<pool_impl> release_if_unused();
 };
 
-template <class T, class M, class C>
-std::size_t pool_impl<T, M, C>::size() const {
+template <class T, class M, class C, class S, template <class> class CC, class SP>
+std::size_t pool_impl<T, M, C, S, CC, SP>::size() const {
     const auto stats = [&] {
         const lock_guard lock(_mutex);
         return storage_.stats();
@@ -88,85 +177,406 @@ std::size_t pool_impl<T, M, C>::size() const {
     return stats.available + stats.used;
 }
 
-template <class T, class M, class C>
-std::size_t pool_impl<T, M, C>::available() const {
+template <class T, class M, class C, class S, template <class> class CC, class SP>
+std::size_t pool_impl<T, M, C, S, CC, SP>::available() const {
     const lock_guard lock(_mutex);
-    return storage_.stats().available;
+    return storage_.stats().available + cached();
 }
 
-template <class T, class M, class C>
-std::size_t pool_impl<T, M, C>::used() const {
+template <class T, class M, class C, class S, template <class> class CC, class SP>
+std::size_t pool_impl<T, M, C, S, CC, SP>::used() const {
     const lock_guard lock(_mutex);
-    return storage_.stats().used;
+    return storage_.stats().used - cached();
 }
 
-template <class T, class M, class C>
-sync::stats pool_impl<T, M, C>::stats() const {
+template <class T, class M, class C, class S, template <class> class CC, class SP>
+sync::stats pool_impl<T, M, C, S, CC, SP>::stats() const {
     const auto stats = [&] {
         const lock_guard lock(_mutex);
-        return storage_.stats();
+        auto result = storage_.stats();
+        const auto cached = this->cached();
+        result.available += cached;
+        result.used -= cached;
+        return std::make_pair(result, _queue.size);
     } ();
     sync::stats result;
-    result.size = stats.available + stats.used;
-    result.available = stats.available;
-    result.used = stats.used;
+    result.size = stats.first.available + stats.first.used;
+    result.available = stats.first.available;
+    result.used = stats.first.used;
+    result.queue_size = stats.second;
     return result;
 }
 
-template <class T, class M, class C>
-void pool_impl<T, M, C>::recycle(list_iterator res_it) {
+template <class T, class M, class C, class S, template <class> class CC, class SP>
+void pool_impl<T, M, C, S, CC, SP>::recycle(list_iterator res_it) {
+    if constexpr (cell_cache_type::enabled) {
+        if (try_recycle_cached(res_it)) {
+            return;
+        }
+    }
+    recycle_locked(res_it);
+}
+
+template <class T, class M, class C, class S, template <class> class CC, class SP>
+void pool_impl<T, M, C, S, CC, SP>::recycle_locked(list_iterator res_it) {
+    std::shared_ptr<pool_impl> self;
+    std::vector<value_type> dropped;
+    const lock_guard lock(_mutex);
+    storage_.recycle(res_it, dropped);
+    self = release_if_unused();
+    serve_locked(dropped);
+}
+
+template <class T, class M, class C, class S, template <class> class CC, class SP>
+void pool_impl<T, M, C, S, CC, SP>::waste(list_iterator res_it) {
+    std::shared_ptr<pool_impl> self;
+    boost::optional<value_type> value;
+    value.swap(res_it->value);
+    std::vector<value_type> dropped;
     const lock_guard lock(_mutex);
-    storage_.recycle(res_it);
-    _has_capacity.notify_one();
+    storage_.waste(res_it, dropped);
+    self = release_if_unused();
+    serve_locked(dropped);
+}
+
+template <class T, class M, class C, class S, template <class> class CC, class SP>
+void pool_impl<T, M, C, S, CC, SP>::recycle_many(const std::vector<list_iterator>& cells) {
+    if constexpr (cell_cache_type::enabled) {
+        std::vector<list_iterator> rest;
+        for (const auto cell : cells) {
+            if (!try_recycle_cached(cell)) {
+                rest.push_back(cell);
+            }
+        }
+        return_many(rest, true);
+    } else {
+        return_many(cells, true);
+    }
+}
+
+template <class T, class M, class C, class S, template <class> class CC, class SP>
+void pool_impl<T, M, C, S, CC, SP>::waste_many(const std::vector<list_iterator>& cells) {
+    return_many(cells, false);
 }
 
-template <class T, class M, class C>
-void pool_impl<T, M, C>::waste(list_iterator res_it) {
+// Returns cells under single lock, values are destroyed after unlock.
+template <class T, class M, class C, class S, template <class> class CC, class SP>
+void pool_impl<T, M, C, S, CC, SP>::return_many(const std::vector<list_iterator>& cells, bool recycle) {
+    if (cells.empty()) {
+        return;
+    }
+    std::shared_ptr<pool_impl> self;
+    std::vector<value_type> dropped;
+    if (!recycle) {
+        for (const auto cell : cells) {
+            if (cell->value) {
+                dropped.push_back(std::move(*cell->value));
+                cell->value.reset();
+            }
+        }
+    }
     const lock_guard lock(_mutex);
-    storage_.waste(res_it);
-    _has_capacity.notify_one();
+    for (const auto cell : cells) {
+        if (recycle) {
+            storage_.recycle(cell, dropped);
+        } else {
+            storage_.waste(cell, dropped);
+        }
+    }
+    self = release_if_unused();
+    serve_locked(dropped);
 }
 
-template <class T, class M, class C>
-void pool_impl<T, M, C>::disable() {
+// Disabled pool keeps itself alive while there are leased cells, handles refer
+// to the pool by raw pointer.
+template <class T, class M, class C, class S, template <class> class CC, class SP>
+void pool_impl<T, M, C, S, CC, SP>::disable() {
+    std::vector<value_type> dropped;
     const lock_guard lock(_mutex);
     _disabled = true;
-    _has_capacity.notify_all();
+    if constexpr (cell_cache_type::enabled) {
+        cache_entry entry;
+        while (_cache.pop(entry)) {
+            storage_.recycle(entry.cell, dropped);
+        }
+    }
+    if (storage_.stats().used != 0) {
+        _self = this->weak_from_this().lock();
+    }
+    for (auto w = _queue.head; w != nullptr; w = w->next) {
+        w->wake.notify_one();
+    }
+}
+
+template <class T, class M, class C, class S, template <class> class CC, class SP>
+typename pool_impl<T, M, C, S, CC, SP>::get_result pool_impl<T, M, C, S, CC, SP>::get(time_traits::duration wait_duration) {
+    if constexpr (cell_cache_type::enabled) {
+        if (!_disabled) {
+            if (const auto cell = lease_cached()) {
+                return std::make_pair(boost::system::error_code(), *cell);
+            }
+        }
+        const waiter_guard waiting(_waiters);
+        return get_locked(wait_duration);
+    } else {
+        return get_locked(wait_duration);
+    }
+}
+
+// Waiter is registered before locked attempt to lease when cell cache is enabled,
+// so concurrent recycle either puts cell into storage under the lock or leaves it
+// in cache visible for the attempt.
+template <class T, class M, class C, class S, template <class> class CC, class SP>
+typename pool_impl<T, M, C, S, CC, SP>::get_result pool_impl<T, M, C, S, CC, SP>::get_locked(time_traits::duration wait_duration) {
+    list_iterator cell;
+    waiter w(&cell, 1, batch_mode::all);
+    const auto ec = acquire(w, wait_duration);
+    return std::make_pair(ec, ec ? list_iterator() : cell);
+}
+
+// Batch is leased only when there are enough free cells, so waiting batch
+// doesn't hold cells required by other waiters.
+template <class T, class M, class C, class S, template <class> class CC, class SP>
+typename pool_impl<T, M, C, S, CC, SP>::get_many_result pool_impl<T, M, C, S, CC, SP>::get_many(
+        std::size_t count, time_traits::duration wait_duration, batch_mode mode) {
+    if (count == 0) {
+        return get_many_result();
+    }
+    if (mode == batch_mode::all && count > _capacity) {
+        return get_many_result(make_error_code(error::batch_exceeds_capacity), {});
+    }
+    boost::optional<waiter_guard> waiting;
+    if constexpr (cell_cache_type::enabled) {
+        waiting.emplace(_waiters);
+    }
+    std::vector<list_iterator> cells(count);
+    waiter w(cells.data(), count, mode);
+    const auto ec = acquire(w, wait_duration);
+    cells.resize(ec ? 0 : w.leased);
+    return get_many_result(ec, std::move(cells));
 }
 
-template <class T, class M, class C>
-typename pool_impl<T, M, C>::get_result pool_impl<T, M, C>::get(time_traits::duration wait_duration) {
+// Requests are served in FIFO order: new request leases without waiting only
+// when nobody is queued, queued one is leased by recycle or waste and woken up.
+// Deadline is computed once, so wake up without lease doesn't prolong waiting.
+template <class T, class M, class C, class S, template <class> class CC, class SP>
+boost::system::error_code pool_impl<T, M, C, S, CC, SP>::acquire(waiter& w, time_traits::duration wait_duration) {
+    std::vector<value_type> dropped;
     unique_lock lock(_mutex);
+    if (_disabled) {
+        return make_error_code(error::disabled);
+    }
+    if (_queue.head == nullptr && lease_for(w, dropped)) {
+        return boost::system::error_code();
+    }
+    const auto deadline = time_traits::add(time_traits::now(), wait_duration);
+    push_waiter(w);
     while (true) {
-        if (_disabled) {
-            lock.unlock();
-            return std::make_pair(make_error_code(error::disabled), list_iterator());
-        } 
-        if (const auto cell = storage_.lease()) {
-            lock.unlock();
-            return std::make_pair(boost::system::error_code(), *cell);
+        const bool woken = wait_for(lock, w, deadline);
+        if (w.served) {
+            return boost::system::error_code();
+        }
+        if (_disabled || !woken || time_traits::now() >= deadline) {
+            const bool first = _queue.head == &w;
+            erase_waiter(w);
+            if (first) {
+                serve_locked(dropped);
+            }
+            return make_error_code(_disabled ? error::disabled : error::get_resource_timeout);
         }
-        if (!wait_for(lock, wait_duration)) {
+    }
+}
+
+// Leases all cells for the waiter or none of them.
+template <class T, class M, class C, class S, template <class> class CC, class SP>
+bool pool_impl<T, M, C, S, CC, SP>::lease_for(waiter& w, std::vector<value_type>& dropped) {
+    const auto free = _capacity - (storage_.stats().used - cached());
+    if (free < (w.mode == batch_mode::all ? w.count : 1)) {
+        return false;
+    }
+    while (w.leased < w.count) {
+        const auto cell = lease_locked(dropped);
+        if (!cell) {
+            break;
+        }
+        w.cells[w.leased++] = *cell;
+    }
+    if (w.leased == w.count || (w.mode == batch_mode::partial && w.leased != 0)) {
+        return true;
+    }
+    for (std::size_t i = 0; i < w.leased; ++i) {
+        if (w.cells[i]->value) {
+            storage_.recycle(w.cells[i], dropped);
+        } else {
+            storage_.waste(w.cells[i], dropped);
+        }
+    }
+    w.leased = 0;
+    return false;
+}
+
+template <class T, class M, class C, class S, template <class> class CC, class SP>
+void pool_impl<T, M, C, S, CC, SP>::invalidate() {
+    std::vector<value_type> dropped;
+    const lock_guard lock(_mutex);
+    ++_generation;
+    if constexpr (cell_cache_type::enabled) {
+        cache_entry entry;
+        while (_cache.pop(entry)) {
+            storage_.waste(entry.cell, dropped);
+        }
+    }
+    storage_.invalidate(dropped);
+}
+
+template <class T, class M, class C, class S, template <class> class CC, class SP>
+boost::optional<typename pool_impl<T, M, C, S, CC, SP>::list_iterator> pool_impl<T, M, C, S, CC, SP>::lease_locked(
+        std::vector<value_type>& dropped) {
+    if constexpr (cell_cache_type::enabled) {
+        if (const auto cell = lease_cached(dropped)) {
+            return cell;
+        }
+    }
+    if (const auto cell = storage_.lease(dropped)) {
+        (*cell)->generation = _generation;
+        return cell;
+    }
+    return {};
+}
+
+// Hands cells to queued waiters in order, stops at the first waiter which can't
+// be served, so later smaller requests don't overtake it. Waiter is notified
+// under the lock because it owns the wake primitive and may leave on timeout.
+template <class T, class M, class C, class S, template <class> class CC, class SP>
+void pool_impl<T, M, C, S, CC, SP>::serve_locked(std::vector<value_type>& dropped) {
+    while (!_disabled && _queue.head != nullptr) {
+        waiter& w = *_queue.head;
+        if (!lease_for(w, dropped)) {
+            break;
+        }
+        w.served.store(true, std::memory_order_release);
+        erase_waiter(w);
+        w.wake.notify_one();
+    }
+}
+
+template <class T, class M, class C, class S, template <class> class CC, class SP>
+void pool_impl<T, M, C, S, CC, SP>::push_waiter(waiter& w) {
+    w.prev = _queue.tail;
+    w.next = nullptr;
+    (_queue.tail == nullptr ? _queue.head : _queue.tail->next) = &w;
+    _queue.tail = &w;
+    ++_queue.size;
+}
+
+template <class T, class M, class C, class S, template <class> class CC, class SP>
+void pool_impl<T, M, C, S, CC, SP>::erase_waiter(waiter& w) {
+    (w.prev == nullptr ? _queue.head : w.prev->next) = w.next;
+    (w.next == nullptr ? _queue.tail : w.next->prev) = w.prev;
+    w.prev = w.next = nullptr;
+    --_queue.size;
+}
+
+// Spins without the lock before parking when spin is enabled, waiter served
+// while the lock was released is checked again under the lock because its
+// notification is already missed.
+template <class T, class M, class C, class S, template <class> class CC, class SP>
+bool pool_impl<T, M, C, S, CC, SP>::wait_for(unique_lock& lock, waiter& w, time_traits::time_point deadline) {
+    if constexpr (spin_type::enabled) {
+        if (deadline > time_traits::now()) {
             lock.unlock();
-            return std::make_pair(make_error_code(error::get_resource_timeout),
-                                  list_iterator());
+            const bool ready = _spin.spin([&] { return w.served.load(std::memory_order_acquire) || _disabled; });
+            lock.lock();
+            if (ready || w.served || _disabled) {
+                return true;
+            }
+        }
+    }
+    const auto wait_duration = std::max(deadline - time_traits::now(), time_traits::duration(0));
+    return w.wake.wait_for(lock, wait_duration) == std::cv_status::no_timeout;
+}
+
+// Puts valid cell into cache if there are no waiters. Waiters registered after
+// cell is put into cache will find it, otherwise cache is drained into storage
+// notifying waiters.
+template <class T, class M, class C, class S, template <class> class CC, class SP>
+bool pool_impl<T, M, C, S, CC, SP>::try_recycle_cached(list_iterator res_it) {
+    if (_disabled || _waiters != 0 || !res_it->value || res_it->generation != _generation) {
+        return false;
+    }
+    const auto now = time_traits::now();
+    const auto life_end = time_traits::add(res_it->reset_time, _lifespan);
+    if (life_end <= now) {
+        return false;
+    }
+    res_it->drop_time = std::min(time_traits::add(now, _idle_timeout), life_end);
+    if (!_cache.push(cache_entry {res_it, res_it->generation})) {
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_waiters != 0 || _disabled) {
+        const auto self = keep_alive();
+        cache_entry entry;
+        while (_cache.pop(entry)) {
+            recycle_locked(entry.cell);
         }
     }
+    return true;
 }
 
-template <class T, class M, class C>
-void pool_impl<T, M, C>::invalidate() {
+template <class T, class M, class C, class S, template <class> class CC, class SP>
+boost::optional<typename pool_impl<T, M, C, S, CC, SP>::list_iterator> pool_impl<T, M, C, S, CC, SP>::lease_cached() {
+    cache_entry entry;
+    while (_cache.pop(entry)) {
+        if (entry.generation == _generation && entry.cell->drop_time > time_traits::now()) {
+            entry.cell->generation = entry.generation;
+            return entry.cell;
+        }
+        waste(entry.cell);
+    }
+    return {};
+}
+
+template <class T, class M, class C, class S, template <class> class CC, class SP>
+boost::optional<typename pool_impl<T, M, C, S, CC, SP>::list_iterator> pool_impl<T, M, C, S, CC, SP>::lease_cached(
+        std::vector<value_type>& dropped) {
+    cache_entry entry;
+    while (_cache.pop(entry)) {
+        if (entry.generation == _generation && entry.cell->drop_time > time_traits::now()) {
+            entry.cell->generation = entry.generation;
+            return entry.cell;
+        }
+        storage_.waste(entry.cell, dropped);
+    }
+    return {};
+}
+
+template <class T, class M, class C, class S, template <class> class CC, class SP>
+std::size_t pool_impl<T, M, C, S, CC, SP>::cached() const noexcept {
+    if constexpr (cell_cache_type::enabled) {
+        return _cache.size();
+    } else {
+        return 0;
+    }
+}
+
+template <class T, class M, class C, class S, template <class> class CC, class SP>
+std::shared_ptr<pool_impl<T, M, C, S, CC, SP>> pool_impl<T, M, C, S, CC, SP>::keep_alive() const {
     const lock_guard lock(_mutex);
-    storage_.invalidate();
+    return _self;
 }
 
-template <class T, class M, class C>
-bool pool_impl<T, M, C>::wait_for(unique_lock& lock, time_traits::duration wait_duration) {
-    return _has_capacity.wait_for(lock, wait_duration) == std::cv_status::no_timeout;
+// Returns self reference to be released after unlock when disabled pool has no leased cells.
+template <class T, class M, class C, class S, template <class> class CC, class SP>
+std::shared_ptr<pool_impl<T, M, C, S, CC, SP>> pool_impl<T, M, C, S, CC, SP>::release_if_unused() {
+    if (_self && storage_.stats().used == cached()) {
+        return std::move(_self);
+    }
+    return {};
 }
 
-template <class T, class M, class C>
-std::size_t pool_impl<T, M, C>::assert_capacity(std::size_t value) {
+template <class T, class M, class C, class S, template <class> class CC, class SP>
+std::size_t pool_impl<T, M, C, S, CC, SP>::assert_capacity(std::size_t value) {
     if (value == 0) {
         throw error::zero_pool_capacity();
     }
@@ -1,16 +1,47 @@
 #ifndef YAMAIL_RESOURCE_POOL_SYNC_POOL_HPP
 #define YAMAIL_RESOURCE_POOL_SYNC_POOL_HPP
 
+#include <yamail/resource_pool/batch_mode.hpp>
 #include <yamail/resource_pool/error.hpp>
 #include <yamail/resource_pool/handle.hpp>
+#include <yamail/resource_pool/lease_order.hpp>
 #include <yamail/resource_pool/sync/detail/pool_impl.hpp>
+#include <yamail/resource_pool/detail/magazine_cache.hpp>
 
 #include <condition_variable>
+#include <vector>
 
 namespace yamail {
 namespace resource_pool {
 namespace sync {
 
+// Pool implementation serving get and recycle through per thread magazines of cells
+// while there are no waiting requests.
+template <class Value, class Mutex = std::mutex, class Storage = resource_pool::detail::storage<Value>>
+struct magazine_pool_impl {
+    using type = detail::pool_impl<
+        Value,
+        Mutex,
+        std::condition_variable,
+        Storage,
+        resource_pool::detail::magazine_cache
+    >;
+};
+
+// Pool implementation where waiting thread spins for short time before parking
+// on condition variable, spin limit adapts to how soon resources are returned.
+template <class Value, class Mutex = std::mutex, class Storage = resource_pool::detail::storage<Value>>
+struct spinning_pool_impl {
+    using type = detail::pool_impl<
+        Value,
+        Mutex,
+        std::condition_variable,
+        Storage,
+        resource_pool::detail::no_cell_cache,
+        detail::adaptive_spin
+    >;
+};
+
 template <class Value,
           class Mutex = std::mutex,
           class Impl = detail::pool_impl<Value, Mutex, std::condition_variable>>
@@ -18,13 +49,17 @@ class pool {
 public:
     using value_type = Value;
     using pool_impl = Impl;
-    using handle = resource_pool::handle<value_type>;
+    using handle = resource_pool::handle<value_type, typename pool_impl::list_iterator>;
     using get_result = std::pair<boost::system::error_code, handle>;
+    using get_many_result = std::pair<boost::system::error_code, std::vector<handle>>;
+    template <class Strategy>
+    using static_handle = resource_pool::static_handle<pool_impl, Strategy>;
 
     pool(std::size_t capacity,
          time_traits::duration idle_timeout = time_traits::duration::max(),
-         time_traits::duration lifespan = time_traits::duration::max())
-            : _impl(std::make_shared<pool_impl>(capacity, idle_timeout, lifespan))
+         time_traits::duration lifespan = time_traits::duration::max(),
+         lease_order order = lease_order::fifo)
+            : _impl(std::make_shared<pool_impl>(capacity, idle_timeout, lifespan, order))
     {}
 
     pool(std::shared_ptr<pool_impl> impl)
@@ -41,7 +76,15 @@ public:
     }
 
     pool& operator =(const pool&) = delete;
-    pool& operator =(pool&&) = default;
+    pool& operator =(pool&& other) {
+        if (this != &other) {
+            if (_impl) {
+                _impl->disable();
+            }
+            _impl = std::move(other._impl);
+        }
+        return *this;
+    }
 
     std::size_t capacity() const { return _impl->capacity(); }
     std::size_t size() const { return _impl->size(); }
@@ -57,6 +100,44 @@ public:
         return get_handle(&handle::recycle, wait_duration);
     }
 
+    // Leases count resources under single lock, see batch_mode for completion rules.
+    get_many_result get_many_auto_waste(std::size_t count,
+                                        time_traits::duration wait_duration = time_traits::duration(0),
+                                        batch_mode mode = batch_mode::all) {
+        return get_handles(&handle::waste, count, wait_duration, mode);
+    }
+
+    get_many_result get_many_auto_recycle(std::size_t count,
+                                          time_traits::duration wait_duration = time_traits::duration(0),
+                                          batch_mode mode = batch_mode::all) {
+        return get_handles(&handle::recycle, count, wait_duration, mode);
+    }
+
+    // Returns static_handle, Strategy is auto_recycle or auto_waste.
+    template <class Strategy>
+    std::pair<boost::system::error_code, static_handle<Strategy>> get(
+            time_traits::duration wait_duration = time_traits::duration(0)) {
+        const typename pool_impl::get_result& res = _impl->get(wait_duration);
+        if (res.first) {
+            return std::make_pair(res.first, static_handle<Strategy>());
+        }
+        return std::make_pair(res.first, static_handle<Strategy>(_impl.get(), res.second));
+    }
+
+    // Returns resources of usable handles from range to the pool under single lock.
+    // Handles of other pools are returned one by one.
+    template <class Range>
+    void recycle_all(Range&& handles) {
+        _impl->recycle_many(resource_pool::detail::take_cells(_impl.get(), handles,
+            [] (auto& handle) { handle.recycle(); }));
+    }
+
+    template <class Range>
+    void waste_all(Range&& handles) {
+        _impl->waste_many(resource_pool::detail::take_cells(_impl.get(), handles,
+            [] (auto& handle) { handle.waste(); }));
+    }
+
     void invalidate() {
         _impl->invalidate();
     }
@@ -69,7 +150,21 @@ private:
 
     get_result get_handle(strategy use_strategy, time_traits::duration wait_duration) {
         const typename pool_impl::get_result& res = _impl->get(wait_duration);
-        return std::make_pair(res.first, handle(_impl, use_strategy, res.second));
+        if (res.first) {
+            return std::make_pair(res.first, handle());
+        }
+        return std::make_pair(res.first, handle(_impl.get(), use_strategy, res.second));
+    }
+
+    get_many_result get_handles(strategy use_strategy, std::size_t count,
+                                time_traits::duration wait_duration, batch_mode mode) {
+        const typename pool_impl::get_many_result& res = _impl->get_many(count, wait_duration, mode);
+        std::vector<handle> handles;
+        handles.reserve(res.second.size());
+        for (const auto& cell : res.second) {
+            handles.emplace_back(_impl.get(), use_strategy, cell);
+        }
+        return std::make_pair(res.first, std::move(handles));
     }
 };
 
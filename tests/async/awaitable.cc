@@ -0,0 +1,142 @@
+#include <yamail/resource_pool/async/pool.hpp>
+
+#include <gtest/gtest.h>
+
+#if defined(BOOST_ASIO_HAS_CO_AWAIT)
+
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/use_awaitable.hpp>
+
+#include <chrono>
+
+namespace {
+
+using namespace testing;
+using namespace yamail::resource_pool;
+using namespace yamail::resource_pool::async;
+
+namespace asio = boost::asio;
+
+struct resource {
+    int value;
+
+    resource(int value) : value(value) {}
+    resource(const resource&) = delete;
+    resource(resource&&) = default;
+    resource& operator =(const resource&) = delete;
+    resource& operator =(resource&&) = default;
+};
+
+using resource_pool = pool<resource>;
+using boost::system::error_code;
+
+struct async_resource_pool_awaitable : Test {
+    asio::io_context io;
+    bool coroutine_finished = false;
+    bool coroutine1_finished = false;
+    bool coroutine2_finished = false;
+};
+
+TEST_F(async_resource_pool_awaitable, get_auto_recycle_with_use_awaitable_should_return_usable_handle) {
+    resource_pool pool(1, 0);
+
+    asio::co_spawn(io, [&] () -> asio::awaitable<void> {
+        auto handle = co_await pool.get_auto_recycle(io, asio::use_awaitable);
+        EXPECT_FALSE(handle.unusable());
+        EXPECT_TRUE(handle.empty());
+        handle.reset(resource {42});
+        coroutine_finished = true;
+    }, asio::detached);
+
+    io.run();
+
+    EXPECT_TRUE(coroutine_finished);
+    EXPECT_EQ(pool.available(), 1u);
+}
+
+TEST_F(async_resource_pool_awaitable, get_auto_waste_with_use_awaitable_on_exhausted_pool_should_throw) {
+    resource_pool pool(1, 0);
+
+    asio::co_spawn(io, [&] () -> asio::awaitable<void> {
+        auto handle = co_await pool.get_auto_waste(io, asio::use_awaitable);
+        EXPECT_FALSE(handle.unusable());
+        try {
+            co_await pool.get_auto_waste(io, asio::use_awaitable);
+            ADD_FAILURE() << "get should throw";
+        } catch (const boost::system::system_error& e) {
+            EXPECT_EQ(e.code(), error_code(error::get_resource_timeout));
+        }
+        coroutine_finished = true;
+    }, asio::detached);
+
+    io.run();
+
+    EXPECT_TRUE(coroutine_finished);
+}
+
+TEST_F(async_resource_pool_awaitable, co_get_auto_recycle_with_available_resource_should_complete_without_posting) {
+    resource_pool pool(1, 0);
+
+    asio::co_spawn(io, [&] () -> asio::awaitable<void> {
+        {
+            auto handle = co_await pool.co_get_auto_recycle(io);
+            EXPECT_FALSE(handle.unusable());
+            handle.reset(resource {42});
+        }
+        auto handle = co_await pool.co_get_auto_recycle(io);
+        EXPECT_EQ(handle->value, 42);
+        coroutine_finished = true;
+    }, asio::detached);
+
+    EXPECT_EQ(io.run_one(), 1u);
+
+    EXPECT_TRUE(coroutine_finished);
+}
+
+TEST_F(async_resource_pool_awaitable, co_get_auto_waste_should_wait_for_returned_resource) {
+    resource_pool pool(1, 1);
+
+    asio::co_spawn(io, [&] () -> asio::awaitable<void> {
+        auto handle = co_await pool.co_get_auto_waste(io);
+        handle.reset(resource {1});
+        co_await asio::post(io, asio::use_awaitable);
+        handle.recycle();
+        coroutine1_finished = true;
+    }, asio::detached);
+
+    asio::co_spawn(io, [&] () -> asio::awaitable<void> {
+        auto handle = co_await pool.co_get_auto_waste(io, std::chrono::seconds(1));
+        EXPECT_EQ(handle->value, 1);
+        coroutine2_finished = true;
+    }, asio::detached);
+
+    io.run();
+
+    EXPECT_TRUE(coroutine1_finished);
+    EXPECT_TRUE(coroutine2_finished);
+    EXPECT_EQ(pool.used(), 0u);
+}
+
+TEST_F(async_resource_pool_awaitable, co_get_auto_waste_on_full_queue_should_throw) {
+    resource_pool pool(1, 0);
+
+    asio::co_spawn(io, [&] () -> asio::awaitable<void> {
+        auto handle = co_await pool.co_get_auto_waste(io);
+        try {
+            co_await pool.co_get_auto_waste(io, time_traits::duration::max());
+            ADD_FAILURE() << "get should throw";
+        } catch (const boost::system::system_error& e) {
+            EXPECT_EQ(e.code(), error_code(error::request_queue_overflow));
+        }
+        coroutine_finished = true;
+    }, asio::detached);
+
+    io.run();
+
+    EXPECT_TRUE(coroutine_finished);
+}
+
+}
+
+#endif
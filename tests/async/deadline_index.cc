@@ -0,0 +1,112 @@
+#include <yamail/resource_pool/async/detail/deadline_index.hpp>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+using namespace testing;
+using namespace yamail::resource_pool;
+using namespace yamail::resource_pool::async::detail;
+
+template <template <class> class Index>
+struct node {
+    int value = 0;
+    typename Index<node>::hook deadline_hook;
+};
+
+template <template <class> class Index>
+struct index_type {
+    using node_type = node<Index>;
+    using type = Index<node_type>;
+};
+
+template <class T>
+struct async_deadline_index : Test {
+    using index = typename T::type;
+    using node_type = typename T::node_type;
+
+    const time_traits::time_point now = time_traits::now();
+    index deadlines;
+};
+
+using index_types = Types<
+    index_type<fifo_deadline_index>,
+    index_type<multimap_deadline_index>
+>;
+
+TYPED_TEST_SUITE(async_deadline_index, index_types);
+
+TYPED_TEST(async_deadline_index, create_should_be_empty) {
+    EXPECT_TRUE(this->deadlines.empty());
+    EXPECT_EQ(this->deadlines.size(), 0u);
+}
+
+TYPED_TEST(async_deadline_index, insert_then_earliest_should_return_node) {
+    typename TestFixture::node_type first {1, {}};
+    this->deadlines.insert(first, this->now, time_traits::duration(0));
+    EXPECT_FALSE(this->deadlines.empty());
+    EXPECT_EQ(this->deadlines.size(), 1u);
+    EXPECT_EQ(&this->deadlines.earliest(), &first);
+    EXPECT_EQ(TestFixture::index::expires_at(first), this->now);
+}
+
+TYPED_TEST(async_deadline_index, earliest_should_return_node_with_minimal_deadline_across_durations) {
+    using std::chrono::seconds;
+    typename TestFixture::node_type first {1, {}};
+    typename TestFixture::node_type second {2, {}};
+    typename TestFixture::node_type third {3, {}};
+    this->deadlines.insert(first, this->now + seconds(3), seconds(3));
+    this->deadlines.insert(second, this->now + seconds(1), seconds(1));
+    this->deadlines.insert(third, this->now + seconds(4), seconds(3));
+    EXPECT_EQ(&this->deadlines.earliest(), &second);
+    this->deadlines.erase(second);
+    EXPECT_EQ(&this->deadlines.earliest(), &first);
+    this->deadlines.erase(first);
+    EXPECT_EQ(&this->deadlines.earliest(), &third);
+    this->deadlines.erase(third);
+    EXPECT_TRUE(this->deadlines.empty());
+}
+
+TYPED_TEST(async_deadline_index, erase_from_middle_should_keep_order) {
+    using std::chrono::seconds;
+    typename TestFixture::node_type first {1, {}};
+    typename TestFixture::node_type second {2, {}};
+    typename TestFixture::node_type third {3, {}};
+    this->deadlines.insert(first, this->now + seconds(1), seconds(1));
+    this->deadlines.insert(second, this->now + seconds(2), seconds(1));
+    this->deadlines.insert(third, this->now + seconds(3), seconds(1));
+    this->deadlines.erase(second);
+    EXPECT_EQ(this->deadlines.size(), 2u);
+    EXPECT_EQ(&this->deadlines.earliest(), &first);
+    this->deadlines.erase(first);
+    EXPECT_EQ(&this->deadlines.earliest(), &third);
+}
+
+TYPED_TEST(async_deadline_index, insert_after_erase_all_should_reuse_index) {
+    using std::chrono::seconds;
+    typename TestFixture::node_type first {1, {}};
+    typename TestFixture::node_type second {2, {}};
+    this->deadlines.insert(first, this->now + seconds(1), seconds(1));
+    this->deadlines.erase(first);
+    this->deadlines.insert(second, this->now + seconds(2), seconds(2));
+    this->deadlines.insert(first, this->now + seconds(3), seconds(1));
+    EXPECT_EQ(this->deadlines.size(), 2u);
+    EXPECT_EQ(&this->deadlines.earliest(), &second);
+}
+
+TYPED_TEST(async_deadline_index, insert_with_earlier_deadline_of_same_duration_should_keep_order) {
+    using std::chrono::seconds;
+    typename TestFixture::node_type first {1, {}};
+    typename TestFixture::node_type second {2, {}};
+    typename TestFixture::node_type third {3, {}};
+    this->deadlines.insert(second, this->now + seconds(2), seconds(1));
+    this->deadlines.insert(third, this->now + seconds(3), seconds(1));
+    this->deadlines.insert(first, this->now + seconds(1), seconds(1));
+    EXPECT_EQ(&this->deadlines.earliest(), &first);
+    this->deadlines.erase(first);
+    EXPECT_EQ(&this->deadlines.earliest(), &second);
+    this->deadlines.erase(second);
+    EXPECT_EQ(&this->deadlines.earliest(), &third);
+}
+
+}
@@ -0,0 +1,238 @@
+#include <yamail/resource_pool/async/factory.hpp>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <vector>
+
+namespace {
+
+using namespace testing;
+using namespace yamail::resource_pool;
+using namespace yamail::resource_pool::async;
+
+namespace asio = boost::asio;
+
+using resource_pool = pool<int>;
+using resource_factory = factory<resource_pool>;
+using boost::system::error_code;
+
+struct async_resource_factory : Test {
+    asio::io_context io;
+    std::vector<resource_factory::on_create> pending;
+    std::size_t completed = 0;
+
+    resource_factory::create_function deferred_create() {
+        return [this] (asio::io_context&, resource_factory::on_create on_create) {
+            pending.push_back(std::move(on_create));
+        };
+    }
+
+    void finish_first(error_code ec, int value) {
+        auto on_create = std::move(pending.front());
+        pending.erase(pending.begin());
+        on_create(ec, value);
+    }
+};
+
+TEST_F(async_resource_factory, get_from_empty_pool_should_return_created_resource) {
+    resource_pool pool(1, 0);
+    resource_factory factory(pool, [] (asio::io_context& io, resource_factory::on_create on_create) {
+        asio::post(io, [on_create] { on_create(error_code(), 42); });
+    }, 1);
+
+    factory.get_auto_recycle(io, [&] (error_code ec, resource_pool::handle handle) {
+        EXPECT_FALSE(ec);
+        ASSERT_FALSE(handle.empty());
+        EXPECT_EQ(handle.get(), 42);
+        ++completed;
+    });
+
+    io.run();
+
+    EXPECT_EQ(completed, 1u);
+    EXPECT_EQ(pool.available(), 1u);
+    const auto stats = factory.stats();
+    EXPECT_EQ(stats.created, 1u);
+    EXPECT_EQ(stats.failed, 0u);
+    EXPECT_EQ(stats.in_flight, 0u);
+    EXPECT_EQ(stats.waiting, 0u);
+    EXPECT_GE(stats.max_latency, time_traits::duration(0));
+    EXPECT_GE(stats.total_latency, stats.max_latency);
+}
+
+TEST_F(async_resource_factory, get_of_recycled_resource_should_not_create_resource) {
+    resource_pool pool(1, 0);
+    resource_factory factory(pool, deferred_create(), 1);
+    {
+        auto handle = pool.try_get_auto_recycle();
+        handle.reset(13);
+    }
+
+    factory.get_auto_waste(io, [&] (error_code ec, resource_pool::handle handle) {
+        EXPECT_FALSE(ec);
+        EXPECT_EQ(handle.get(), 13);
+        ++completed;
+    });
+
+    io.run();
+
+    EXPECT_EQ(completed, 1u);
+    EXPECT_TRUE(pending.empty());
+    EXPECT_EQ(factory.stats().created, 0u);
+}
+
+TEST_F(async_resource_factory, concurrent_gets_should_not_create_more_than_max_concurrent_resources_at_once) {
+    resource_pool pool(3, 0);
+    resource_factory factory(pool, deferred_create(), 2);
+    std::vector<int> values;
+
+    for (int i = 0; i < 3; ++i) {
+        factory.get_auto_recycle(io, [&] (error_code ec, resource_pool::handle handle) {
+            EXPECT_FALSE(ec);
+            values.push_back(handle.get());
+        });
+    }
+
+    io.run();
+    io.restart();
+    ASSERT_EQ(pending.size(), 2u);
+    EXPECT_EQ(factory.stats().in_flight, 2u);
+    EXPECT_EQ(factory.stats().waiting, 3u);
+
+    finish_first(error_code(), 1);
+    ASSERT_EQ(pending.size(), 2u);
+    finish_first(error_code(), 2);
+    finish_first(error_code(), 3);
+    EXPECT_TRUE(pending.empty());
+
+    io.run();
+
+    EXPECT_EQ(values, std::vector<int>({1, 2, 3}));
+    EXPECT_EQ(factory.stats().created, 3u);
+    EXPECT_EQ(factory.stats().waiting, 0u);
+    EXPECT_EQ(pool.available(), 3u);
+}
+
+TEST_F(async_resource_factory, creation_error_should_be_passed_to_handler_and_cell_returned_to_pool) {
+    resource_pool pool(1, 0);
+    resource_factory factory(pool, deferred_create(), 1);
+
+    factory.get_auto_recycle(io, [&] (error_code ec, resource_pool::handle handle) {
+        EXPECT_EQ(ec, error_code(asio::error::connection_refused));
+        EXPECT_TRUE(handle.unusable());
+        ++completed;
+    });
+
+    io.run();
+    io.restart();
+    ASSERT_EQ(pending.size(), 1u);
+    finish_first(error_code(asio::error::connection_refused), 0);
+    io.run();
+
+    EXPECT_EQ(completed, 1u);
+    EXPECT_EQ(pool.used(), 0u);
+    EXPECT_EQ(factory.stats().failed, 1u);
+}
+
+TEST_F(async_resource_factory, pool_error_should_be_passed_to_handler_without_creation) {
+    resource_pool pool(1, 0);
+    resource_factory factory(pool, deferred_create(), 1);
+    auto handle = pool.try_get_auto_recycle();
+
+    factory.get_auto_recycle(io, [&] (error_code ec, resource_pool::handle handle) {
+        EXPECT_EQ(ec, error_code(error::get_resource_timeout));
+        EXPECT_TRUE(handle.unusable());
+        ++completed;
+    });
+
+    io.run();
+
+    EXPECT_EQ(completed, 1u);
+    EXPECT_TRUE(pending.empty());
+}
+
+TEST_F(async_resource_factory, warmer_should_create_min_idle_resources_in_advance) {
+    resource_pool pool(3, 0);
+    resource_factory factory(pool, deferred_create(), 3);
+
+    factory.start_warmer(io, 2, std::chrono::hours(1));
+
+    ASSERT_EQ(pending.size(), 2u);
+    finish_first(error_code(), 1);
+    finish_first(error_code(), 2);
+    io.poll();
+
+    EXPECT_TRUE(pending.empty());
+    EXPECT_EQ(pool.available(), 2u);
+    EXPECT_EQ(pool.used(), 0u);
+    EXPECT_EQ(factory.stats().created, 2u);
+
+    factory.stop_warmer();
+    io.run();
+}
+
+TEST_F(async_resource_factory, warmer_should_refill_pool_after_resource_is_taken) {
+    resource_pool pool(3, 0);
+    resource_factory factory(pool, deferred_create(), 3);
+
+    factory.start_warmer(io, 1, std::chrono::milliseconds(1));
+    ASSERT_EQ(pending.size(), 1u);
+    finish_first(error_code(), 1);
+    io.poll();
+    ASSERT_EQ(pool.available(), 1u);
+
+    auto handle = pool.try_get_auto_recycle();
+    ASSERT_FALSE(handle.empty());
+    while (pending.empty()) {
+        io.run_one();
+    }
+    finish_first(error_code(), 2);
+    io.poll();
+
+    EXPECT_EQ(pool.available(), 1u);
+    EXPECT_EQ(pool.used(), 1u);
+
+    factory.stop_warmer();
+    io.run();
+}
+
+TEST_F(async_resource_factory, warmer_should_retry_failed_creation_on_timer) {
+    resource_pool pool(1, 0);
+    resource_factory factory(pool, deferred_create(), 1);
+
+    factory.start_warmer(io, 1, std::chrono::milliseconds(1));
+    ASSERT_EQ(pending.size(), 1u);
+    finish_first(error_code(asio::error::connection_refused), 0);
+    io.poll();
+    EXPECT_TRUE(pending.empty());
+    EXPECT_EQ(pool.available(), 0u);
+
+    while (pending.empty()) {
+        io.run_one();
+    }
+    finish_first(error_code(), 1);
+    io.poll();
+
+    EXPECT_EQ(pool.available(), 1u);
+    EXPECT_EQ(factory.stats().failed, 1u);
+    EXPECT_EQ(factory.stats().created, 1u);
+
+    factory.stop_warmer();
+    io.run();
+}
+
+TEST_F(async_resource_factory, resource_created_after_warmer_is_stopped_should_be_recycled) {
+    resource_pool pool(1, 0);
+    resource_factory factory(pool, deferred_create(), 1);
+
+    factory.start_warmer(io, 1, std::chrono::hours(1));
+    factory.stop_warmer();
+    ASSERT_EQ(pending.size(), 1u);
+    finish_first(error_code(), 1);
+    io.run();
+
+    EXPECT_EQ(pool.available(), 1u);
+}
+
+}
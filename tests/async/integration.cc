@@ -1,6 +1,21 @@
 #include <yamail/resource_pool/async/pool.hpp>
+#include <yamail/resource_pool/detail/slab_storage.hpp>
 
+#include <boost/asio/bind_executor.hpp>
 #include <boost/asio/dispatch.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/asio/version.hpp>
+
+#if BOOST_ASIO_VERSION >= 102000
+#include <boost/asio/bind_cancellation_slot.hpp>
+#include <boost/asio/cancellation_signal.hpp>
+#endif
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -489,4 +504,979 @@ TEST_F(async_resource_pool_integration, get_auto_waste_should_support_move_only_
     EXPECT_TRUE(on_get_called.test_and_set());
 }
 
+using slab_resource_pool = pool<
+    resource,
+    std::mutex,
+    asio::io_context,
+    default_pool_impl<resource, std::mutex, asio::io_context, yamail::resource_pool::detail::slab_storage<resource>>::type
+>;
+
+TEST_F(async_resource_pool_integration, pool_with_slab_storage_should_save_handle_state) {
+    slab_resource_pool pool(1, 1);
+
+    asio::spawn(io, [&] (asio::yield_context yield) {
+        {
+            auto handle = pool.get_auto_recycle(io, yield);
+            ASSERT_FALSE(handle.unusable());
+            EXPECT_TRUE(handle.empty());
+            handle.reset(resource {42});
+        }
+        {
+            const auto handle = pool.get_auto_recycle(io, yield);
+            EXPECT_FALSE(handle.unusable());
+            ASSERT_FALSE(handle.empty());
+            EXPECT_EQ(*handle, resource {42});
+        }
+
+        ASSERT_FALSE(coroutine_finished.test_and_set());
+    });
+
+    io.run();
+
+    EXPECT_TRUE(coroutine_finished.test_and_set());
+}
+
+TEST_F(async_resource_pool_integration, reaper_should_drop_expired_available_resources) {
+    resource_pool pool([] { return resource {42}; }, 2, 0, time_traits::duration(0));
+
+    pool.start_reaper(io.get_executor(), std::chrono::milliseconds(1));
+
+    while (pool.available() > 0) {
+        io.run_one();
+    }
+
+    EXPECT_EQ(pool.size(), 0u);
+
+    pool.stop_reaper();
+    io.run();
+}
+
+using fast_path_resource_pool = pool<
+    resource,
+    std::mutex,
+    asio::io_context,
+    fast_path_pool_impl<resource, std::mutex, asio::io_context>::type
+>;
+
+TEST_F(async_resource_pool_integration, fast_path_pool_should_serve_concurrent_requests_from_several_threads) {
+    constexpr std::size_t threads_count = 4;
+    constexpr std::size_t requests_count = 4000;
+    fast_path_resource_pool pool(2, requests_count);
+    std::atomic<std::size_t> succeed {0};
+
+    for (std::size_t n = 0; n < requests_count; ++n) {
+        asio::post(io, [&] {
+            pool.get_auto_recycle(io, [&] (const boost::system::error_code& ec, auto handle) {
+                if (ec) {
+                    return;
+                }
+                if (handle.empty()) {
+                    handle.reset(resource {42});
+                }
+                ++succeed;
+            }, std::chrono::seconds(10));
+        });
+    }
+
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < threads_count; ++i) {
+        threads.emplace_back([&] { io.run(); });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(succeed.load(), requests_count);
+    EXPECT_EQ(pool.available(), pool.size());
+    EXPECT_EQ(pool.used(), 0u);
+}
+
+TEST_F(async_resource_pool_integration, fast_path_pool_free_cells_should_not_exceed_capacity_under_concurrent_recycle) {
+    constexpr std::size_t threads_count = 4;
+    constexpr std::size_t iterations = 20000;
+    fast_path_resource_pool pool(2, 0);
+    std::atomic<bool> done {false};
+    std::size_t max_free = 0;
+
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < threads_count; ++i) {
+        threads.emplace_back([&] {
+            for (std::size_t n = 0; n < iterations; ++n) {
+                auto handle = pool.try_get_auto_recycle();
+                if (!handle.unusable() && handle.empty()) {
+                    handle.reset(resource {42});
+                }
+            }
+        });
+    }
+    std::thread observer([&] {
+        while (!done) {
+            max_free = std::max(max_free, pool.impl().free_cells());
+        }
+    });
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    done = true;
+    observer.join();
+
+    EXPECT_LE(max_free, pool.capacity());
+    EXPECT_EQ(pool.impl().free_cells(), pool.capacity());
+}
+
+TEST_F(async_resource_pool_integration, pool_impl_should_be_destroyed_after_last_handle_returns_to_destroyed_pool) {
+    auto impl = std::make_shared<resource_pool::pool_impl>(1, 0, time_traits::duration::max(),
+                                                           time_traits::duration::max());
+    const std::weak_ptr<resource_pool::pool_impl> weak_impl(impl);
+    boost::optional<resource_pool::handle> handle;
+    {
+        resource_pool pool(std::move(impl));
+        pool.get_auto_recycle(io, [&] (const error_code& ec, resource_pool::handle result) {
+            EXPECT_FALSE(ec);
+            handle = std::move(result);
+        });
+        io.run();
+        ASSERT_TRUE(handle);
+        handle->reset(resource {42});
+    }
+    EXPECT_FALSE(weak_impl.expired());
+    handle->recycle();
+    EXPECT_TRUE(weak_impl.expired());
+}
+
+TEST_F(async_resource_pool_integration, pool_impl_should_be_destroyed_after_last_handle_returns_to_move_assigned_pool) {
+    auto impl = std::make_shared<resource_pool::pool_impl>(1, 0, time_traits::duration::max(),
+                                                           time_traits::duration::max());
+    const std::weak_ptr<resource_pool::pool_impl> weak_impl(impl);
+    boost::optional<resource_pool::handle> handle;
+    resource_pool pool(std::move(impl));
+    pool.start_reaper(io.get_executor(), std::chrono::milliseconds(1));
+    pool.get_auto_recycle(io, [&] (const error_code& ec, resource_pool::handle result) {
+        EXPECT_FALSE(ec);
+        handle = std::move(result);
+    });
+    while (!handle) {
+        io.run_one();
+    }
+    pool = resource_pool(2, 0);
+    EXPECT_FALSE(weak_impl.expired());
+    handle->reset(resource {42});
+    handle->recycle();
+    io.run();
+    EXPECT_TRUE(weak_impl.expired());
+    EXPECT_EQ(pool.capacity(), 2u);
+}
+
+TEST_F(async_resource_pool_integration, pool_impl_should_be_destroyed_with_not_run_io_context_holding_leased_resource) {
+    auto impl = std::make_shared<resource_pool::pool_impl>(1, 0, time_traits::duration::max(),
+                                                           time_traits::duration::max());
+    const std::weak_ptr<resource_pool::pool_impl> weak_impl(impl);
+    auto local_io = std::make_unique<asio::io_context>();
+    {
+        resource_pool pool(std::move(impl));
+        pool.get_auto_recycle(*local_io, [] (const error_code&, resource_pool::handle) {});
+    }
+    EXPECT_FALSE(weak_impl.expired());
+    local_io.reset();
+    EXPECT_TRUE(weak_impl.expired());
+}
+
+TEST_F(async_resource_pool_integration, pool_impl_should_be_destroyed_with_not_run_io_context_holding_served_resource) {
+    auto impl = std::make_shared<resource_pool::pool_impl>(1, 1, time_traits::duration::max(),
+                                                           time_traits::duration::max());
+    const std::weak_ptr<resource_pool::pool_impl> weak_impl(impl);
+    auto local_io = std::make_unique<asio::io_context>();
+    {
+        resource_pool pool(std::move(impl));
+        boost::optional<resource_pool::handle> handle;
+        pool.get_auto_recycle(io, [&] (const error_code& ec, resource_pool::handle result) {
+            EXPECT_FALSE(ec);
+            handle = std::move(result);
+        });
+        io.run();
+        ASSERT_TRUE(handle);
+        pool.get_auto_recycle(*local_io, [] (const error_code&, resource_pool::handle) {},
+                              time_traits::duration::max());
+        handle->reset(resource {42});
+        handle->recycle();
+        EXPECT_EQ(pool.stats().queue_size, 0u);
+    }
+    EXPECT_FALSE(weak_impl.expired());
+    local_io.reset();
+    EXPECT_TRUE(weak_impl.expired());
+}
+
+TEST_F(async_resource_pool_integration, pool_impl_should_be_destroyed_with_pool_when_there_are_no_handles) {
+    auto impl = std::make_shared<resource_pool::pool_impl>(1, 0, time_traits::duration::max(),
+                                                           time_traits::duration::max());
+    const std::weak_ptr<resource_pool::pool_impl> weak_impl(impl);
+    {
+        resource_pool pool(std::move(impl));
+        pool.get_auto_recycle(io, [&] (const error_code& ec, resource_pool::handle handle) {
+            EXPECT_FALSE(ec);
+            handle.reset(resource {42});
+        });
+        io.run();
+    }
+    EXPECT_TRUE(weak_impl.expired());
+}
+
+TEST_F(async_resource_pool_integration, get_static_handle_with_auto_recycle_should_return_resource_to_pool) {
+    resource_pool pool(1, 0);
+
+    pool.get<auto_recycle>(io, [&] (const error_code& ec, resource_pool::static_handle<auto_recycle> handle) {
+        EXPECT_FALSE(ec);
+        ASSERT_FALSE(handle.unusable());
+        handle.reset(resource {42});
+    });
+    io.run();
+    io.restart();
+
+    EXPECT_EQ(pool.available(), 1u);
+
+    pool.get<auto_waste>(io, [&] (const error_code& ec, resource_pool::static_handle<auto_waste> handle) {
+        EXPECT_FALSE(ec);
+        ASSERT_FALSE(handle.empty());
+        EXPECT_EQ(*handle, resource {42});
+    });
+    io.run();
+
+    EXPECT_EQ(pool.available(), 0u);
+    EXPECT_EQ(pool.size(), 0u);
+}
+
+TEST_F(async_resource_pool_integration, get_many_should_complete_once_with_handles_for_all_resources) {
+    resource_pool pool(3, 0);
+
+    pool.get_many_auto_recycle(io, 3, [&] (const error_code& ec, std::vector<resource_pool::handle> handles) {
+        ASSERT_FALSE(on_get_called.test_and_set());
+        EXPECT_FALSE(ec);
+        ASSERT_EQ(handles.size(), 3u);
+        for (auto& handle : handles) {
+            ASSERT_FALSE(handle.unusable());
+            handle.reset(resource {42});
+        }
+    });
+    io.run();
+
+    EXPECT_TRUE(on_get_called.test_and_set());
+    EXPECT_EQ(pool.available(), 3u);
+    EXPECT_EQ(pool.used(), 0u);
+}
+
+TEST_F(async_resource_pool_integration, get_many_with_zero_count_should_return_no_handles) {
+    resource_pool pool(1, 0);
+
+    pool.get_many_auto_recycle(io, 0, [&] (const error_code& ec, std::vector<resource_pool::handle> handles) {
+        ASSERT_FALSE(on_get_called.test_and_set());
+        EXPECT_FALSE(ec);
+        EXPECT_TRUE(handles.empty());
+    });
+    io.run();
+
+    EXPECT_TRUE(on_get_called.test_and_set());
+}
+
+TEST_F(async_resource_pool_integration, get_many_more_than_capacity_should_return_error) {
+    resource_pool pool(2, 1);
+
+    pool.get_many_auto_recycle(io, 3, [&] (const error_code& ec, std::vector<resource_pool::handle> handles) {
+        ASSERT_FALSE(on_get_called.test_and_set());
+        EXPECT_EQ(ec, error_code(error::batch_exceeds_capacity));
+        EXPECT_TRUE(handles.empty());
+    }, time_traits::duration::max());
+    io.run();
+
+    EXPECT_TRUE(on_get_called.test_and_set());
+    EXPECT_EQ(pool.size(), 0u);
+}
+
+TEST_F(async_resource_pool_integration, get_many_without_enough_resources_should_return_leased_ones_on_timeout) {
+    resource_pool pool(2, 0);
+
+    asio::spawn(io, [&] (asio::yield_context yield) {
+        auto handle = pool.get_auto_recycle(io, yield);
+        ASSERT_FALSE(handle.unusable());
+        handle.reset(resource {42});
+
+        error_code ec;
+        const auto handles = pool.get_many_auto_recycle(io, 2, yield[ec]);
+        EXPECT_EQ(ec, error_code(error::get_resource_timeout));
+        EXPECT_TRUE(handles.empty());
+        EXPECT_EQ(pool.used(), 1u);
+
+        ASSERT_FALSE(coroutine_finished.test_and_set());
+    });
+    io.run();
+
+    EXPECT_TRUE(coroutine_finished.test_and_set());
+    EXPECT_EQ(pool.used(), 0u);
+}
+
+TEST_F(async_resource_pool_integration, get_many_in_partial_mode_should_return_available_resources) {
+    resource_pool pool(3, 0);
+
+    asio::spawn(io, [&] (asio::yield_context yield) {
+        auto handle = pool.get_auto_recycle(io, yield);
+        ASSERT_FALSE(handle.unusable());
+
+        const auto handles = pool.get_many_auto_recycle(io, 3, yield, time_traits::duration(0), batch_mode::partial);
+        EXPECT_EQ(handles.size(), 2u);
+        EXPECT_EQ(pool.used(), 3u);
+
+        ASSERT_FALSE(coroutine_finished.test_and_set());
+    });
+    io.run();
+
+    EXPECT_TRUE(coroutine_finished.test_and_set());
+}
+
+TEST_F(async_resource_pool_integration, queued_get_many_should_complete_when_resources_are_returned) {
+    resource_pool pool(2, 1);
+
+    asio::spawn(io, [&] (asio::yield_context yield) {
+        auto handle1 = pool.get_auto_recycle(io, yield);
+        auto handle2 = pool.get_auto_recycle(io, yield);
+        handle1.reset(resource {1});
+        handle2.reset(resource {2});
+
+        pool.get_many_auto_waste(io, 2, [&] (const error_code& ec, std::vector<resource_pool::handle> handles) {
+            ASSERT_FALSE(on_get_called.test_and_set());
+            EXPECT_FALSE(ec);
+            ASSERT_EQ(handles.size(), 2u);
+            EXPECT_EQ(*handles[0], resource {2});
+            EXPECT_EQ(*handles[1], resource {1});
+        }, time_traits::duration::max());
+        EXPECT_EQ(pool.stats().queue_size, 1u);
+
+        handle1.recycle();
+        asio::post(io, yield);
+        EXPECT_EQ(pool.stats().queue_size, 1u);
+        EXPECT_EQ(pool.used(), 1u);
+
+        handle2.recycle();
+
+        ASSERT_FALSE(coroutine_finished.test_and_set());
+    });
+    io.run();
+
+    EXPECT_TRUE(on_get_called.test_and_set());
+    EXPECT_TRUE(coroutine_finished.test_and_set());
+    EXPECT_EQ(pool.size(), 0u);
+}
+
+TEST_F(async_resource_pool_integration, queued_get_many_should_be_completed_by_disabled_pool) {
+    auto impl = std::make_shared<fast_path_resource_pool::pool_impl>(2, 1, time_traits::duration::max(),
+                                                                     time_traits::duration::max());
+    const std::weak_ptr<fast_path_resource_pool::pool_impl> weak_impl(impl);
+    auto pool = std::make_unique<fast_path_resource_pool>(std::move(impl));
+
+    asio::spawn(io, [&] (asio::yield_context yield) {
+        auto handle = pool->get_auto_recycle(io, yield);
+        handle.reset(resource {42});
+
+        pool->get_many_auto_recycle(io, 2, [&] (const error_code& ec, std::vector<fast_path_resource_pool::handle> handles) {
+            ASSERT_FALSE(on_get_called.test_and_set());
+            EXPECT_EQ(ec, error_code(error::disabled));
+            EXPECT_TRUE(handles.empty());
+        }, time_traits::duration::max());
+        EXPECT_EQ(pool->stats().queue_size, 1u);
+        EXPECT_EQ(pool->used(), 1u);
+
+        pool.reset();
+
+        ASSERT_FALSE(coroutine_finished.test_and_set());
+    });
+    io.run();
+
+    EXPECT_TRUE(on_get_called.test_and_set());
+    EXPECT_TRUE(coroutine_finished.test_and_set());
+    EXPECT_TRUE(weak_impl.expired());
+}
+
+TEST_F(async_resource_pool_integration, concurrent_queued_get_many_should_complete_one_after_another) {
+    resource_pool pool(2, 2);
+    std::vector<resource_pool::handle> handles;
+    std::vector<resource_pool::handle> first;
+    std::size_t completed = 0;
+
+    pool.get_many_auto_recycle(io, 2, [&] (const error_code& ec, std::vector<resource_pool::handle> result) {
+        ASSERT_FALSE(ec);
+        handles = std::move(result);
+    });
+    io.run();
+    io.restart();
+    ASSERT_EQ(handles.size(), 2u);
+
+    pool.get_many_auto_recycle(io, 2, [&] (const error_code& ec, std::vector<resource_pool::handle> result) {
+        EXPECT_FALSE(ec);
+        EXPECT_EQ(result.size(), 2u);
+        EXPECT_EQ(completed++, 0u);
+        first = std::move(result);
+    }, time_traits::duration::max());
+    pool.get_many_auto_recycle(io, 2, [&] (const error_code& ec, std::vector<resource_pool::handle> result) {
+        EXPECT_FALSE(ec);
+        EXPECT_EQ(result.size(), 2u);
+        EXPECT_EQ(completed++, 1u);
+    }, time_traits::duration::max());
+    EXPECT_EQ(pool.stats().queue_size, 2u);
+
+    handles[0].recycle();
+    io.poll();
+    io.restart();
+    EXPECT_EQ(pool.stats().queue_size, 2u);
+    EXPECT_EQ(pool.used(), 1u);
+
+    handles[1].recycle();
+    io.poll();
+    io.restart();
+    EXPECT_EQ(completed, 1u);
+    EXPECT_EQ(pool.stats().queue_size, 1u);
+
+    pool.recycle_all(first);
+    io.poll();
+
+    EXPECT_EQ(completed, 2u);
+    EXPECT_EQ(pool.stats().queue_size, 0u);
+    EXPECT_EQ(pool.used(), 0u);
+}
+
+TEST_F(async_resource_pool_integration, expired_queued_get_many_should_let_free_resources_serve_requests_queued_after_it) {
+    resource_pool pool(2, 2);
+    std::vector<resource_pool::handle> handles;
+    bool batch_completed = false;
+    bool get_completed = false;
+
+    pool.get_many_auto_recycle(io, 2, [&] (const error_code& ec, std::vector<resource_pool::handle> result) {
+        ASSERT_FALSE(ec);
+        handles = std::move(result);
+    });
+    io.run();
+    io.restart();
+    ASSERT_EQ(handles.size(), 2u);
+    handles[0].reset(resource {42});
+
+    pool.get_many_auto_recycle(io, 2, [&] (const error_code& ec, std::vector<resource_pool::handle> result) {
+        EXPECT_EQ(ec, error_code(error::get_resource_timeout));
+        EXPECT_TRUE(result.empty());
+        batch_completed = true;
+    }, std::chrono::milliseconds(10));
+    pool.get_auto_recycle(io, [&] (const error_code& ec, resource_pool::handle handle) {
+        EXPECT_FALSE(ec);
+        ASSERT_FALSE(handle.empty());
+        EXPECT_EQ(*handle, resource {42});
+        EXPECT_TRUE(batch_completed);
+        get_completed = true;
+    }, time_traits::duration::max());
+
+    handles[0].recycle();
+    io.poll();
+    io.restart();
+    EXPECT_EQ(pool.stats().queue_size, 2u);
+    EXPECT_EQ(pool.available(), 1u);
+
+    while (!get_completed) {
+        io.run_one();
+    }
+    EXPECT_EQ(pool.stats().queue_size, 0u);
+}
+
+TEST_F(async_resource_pool_integration, recycle_all_should_return_resources_of_all_handles_to_pool) {
+    resource_pool pool(3, 0);
+
+    pool.get_many_auto_waste(io, 3, [&] (const error_code& ec, std::vector<resource_pool::handle> handles) {
+        ASSERT_FALSE(ec);
+        for (auto& handle : handles) {
+            handle.reset(resource {42});
+        }
+        pool.recycle_all(handles);
+        for (const auto& handle : handles) {
+            EXPECT_TRUE(handle.unusable());
+        }
+    });
+    io.run();
+
+    EXPECT_EQ(pool.available(), 3u);
+    EXPECT_EQ(pool.used(), 0u);
+}
+
+TEST_F(async_resource_pool_integration, waste_all_should_drop_resources_of_all_handles) {
+    resource_pool pool(2, 0);
+
+    pool.get_many_auto_recycle(io, 2, [&] (const error_code& ec, std::vector<resource_pool::handle> handles) {
+        ASSERT_FALSE(ec);
+        for (auto& handle : handles) {
+            handle.reset(resource {42});
+        }
+        pool.waste_all(handles);
+    });
+    io.run();
+
+    EXPECT_EQ(pool.size(), 0u);
+}
+
+TEST_F(async_resource_pool_integration, recycle_all_should_serve_queued_requests_of_several_io_contexts) {
+    resource_pool pool(3, 3);
+    asio::io_context other_io;
+    std::vector<resource_pool::handle> handles;
+    std::atomic<std::size_t> served {0};
+
+    pool.get_many_auto_waste(io, 3, [&] (const error_code& ec, std::vector<resource_pool::handle> result) {
+        ASSERT_FALSE(ec);
+        handles = std::move(result);
+    });
+    io.run();
+    io.restart();
+    ASSERT_EQ(handles.size(), 3u);
+    for (std::size_t i = 0; i < handles.size(); ++i) {
+        handles[i].reset(resource {int(i)});
+    }
+
+    const auto on_get = [&] (const error_code& ec, resource_pool::handle handle) {
+        EXPECT_FALSE(ec);
+        ASSERT_FALSE(handle.empty());
+        ++served;
+    };
+    pool.get_auto_waste(io, on_get, time_traits::duration::max());
+    pool.get_auto_waste(other_io, on_get, time_traits::duration::max());
+    pool.get_auto_waste(io, on_get, time_traits::duration::max());
+    EXPECT_EQ(pool.stats().queue_size, 3u);
+
+    pool.recycle_all(handles);
+    EXPECT_EQ(pool.stats().queue_size, 0u);
+
+    io.run();
+    other_io.run();
+
+    EXPECT_EQ(served.load(), 3u);
+    EXPECT_EQ(pool.size(), 0u);
+}
+
+TEST_F(async_resource_pool_integration, try_get_auto_recycle_should_return_usable_handle_without_io_context) {
+    resource_pool pool(1, 0);
+
+    {
+        auto handle = pool.try_get_auto_recycle();
+        ASSERT_FALSE(handle.unusable());
+        handle.reset(resource {42});
+        EXPECT_EQ(pool.used(), 1u);
+    }
+
+    const auto handle = pool.try_get_auto_recycle();
+    ASSERT_FALSE(handle.empty());
+    EXPECT_EQ(handle->value, 42);
+}
+
+TEST_F(async_resource_pool_integration, try_get_from_exhausted_pool_should_return_unusable_handle) {
+    resource_pool pool(1, 0);
+
+    const auto handle = pool.try_get<auto_waste>();
+    EXPECT_FALSE(handle.unusable());
+    EXPECT_TRUE(pool.try_get_auto_waste().unusable());
+}
+
+TEST_F(async_resource_pool_integration, get_with_dispatch_completion_mode_from_io_context_thread_should_complete_inline) {
+    resource_pool pool(1, 0);
+
+    asio::post(io, [&] {
+        pool.get_auto_waste(io, [&] (const error_code& ec, resource_pool::handle handle) {
+            EXPECT_FALSE(ec);
+            EXPECT_FALSE(handle.unusable());
+            ASSERT_FALSE(on_get_called.test_and_set());
+        }, time_traits::duration(0), completion_mode::dispatch);
+        EXPECT_TRUE(on_get_called.test_and_set());
+    });
+
+    EXPECT_EQ(io.run(), 1u);
+}
+
+TEST_F(async_resource_pool_integration, get_with_dispatch_completion_mode_outside_io_context_should_post) {
+    resource_pool pool(1, 0);
+
+    pool.get_auto_waste(io, [&] (const error_code& ec, resource_pool::handle handle) {
+        EXPECT_FALSE(ec);
+        EXPECT_FALSE(handle.unusable());
+        ASSERT_FALSE(on_get_called.test_and_set());
+    }, time_traits::duration(0), completion_mode::dispatch);
+    EXPECT_EQ(pool.used(), 1u);
+
+    io.run();
+
+    EXPECT_TRUE(on_get_called.test_and_set());
+}
+
+TEST_F(async_resource_pool_integration, get_with_dispatch_completion_mode_from_exhausted_pool_should_wait_in_queue) {
+    resource_pool pool(1, 1);
+
+    asio::post(io, [&] {
+        auto handle = pool.try_get_auto_recycle();
+        ASSERT_FALSE(handle.unusable());
+        pool.get_auto_waste(io, [&] (const error_code& ec, resource_pool::handle handle) {
+            EXPECT_FALSE(ec);
+            EXPECT_FALSE(handle.unusable());
+            ASSERT_FALSE(on_get_called.test_and_set());
+        }, time_traits::duration::max(), completion_mode::dispatch);
+        EXPECT_EQ(pool.stats().queue_size, 1u);
+    });
+
+    io.run();
+
+    EXPECT_TRUE(on_get_called.test_and_set());
+}
+
+TEST_F(async_resource_pool_integration, get_with_handler_bound_to_other_io_context_should_complete_without_running_pool_io_context) {
+    resource_pool pool(1, 0);
+    asio::io_context handler_io;
+
+    pool.get_auto_waste(io, asio::bind_executor(handler_io, [&] (const error_code& ec, resource_pool::handle handle) {
+        EXPECT_FALSE(ec);
+        EXPECT_FALSE(handle.unusable());
+        ASSERT_FALSE(on_get_called.test_and_set());
+    }));
+
+    EXPECT_EQ(handler_io.run(), 1u);
+    EXPECT_TRUE(on_get_called.test_and_set());
+}
+
+TEST_F(async_resource_pool_integration, queued_get_with_handler_bound_to_other_io_context_should_be_served_without_running_pool_io_context) {
+    resource_pool pool(1, 1);
+    asio::io_context handler_io;
+    auto handle = pool.try_get_auto_recycle();
+    ASSERT_FALSE(handle.unusable());
+
+    pool.get_auto_waste(io, asio::bind_executor(handler_io, [&] (const error_code& ec, resource_pool::handle handle) {
+        EXPECT_FALSE(ec);
+        EXPECT_FALSE(handle.unusable());
+        ASSERT_FALSE(on_get_called.test_and_set());
+    }), time_traits::duration::max());
+    handle.recycle();
+
+    EXPECT_EQ(handler_io.run(), 1u);
+    EXPECT_TRUE(on_get_called.test_and_set());
+}
+
+TEST_F(async_resource_pool_integration, get_with_executor_should_complete_on_executor) {
+    resource_pool pool(1, 0);
+    const auto strand = asio::make_strand(io);
+
+    pool.get_auto_recycle(strand, [&] (const error_code& ec, resource_pool::handle handle) {
+        EXPECT_FALSE(ec);
+        EXPECT_FALSE(handle.unusable());
+        EXPECT_TRUE(strand.running_in_this_thread());
+        ASSERT_FALSE(on_get_called.test_and_set());
+    });
+
+    EXPECT_EQ(io.run(), 1u);
+    EXPECT_TRUE(on_get_called.test_and_set());
+}
+
+TEST_F(async_resource_pool_integration, queued_get_with_executor_should_expire_on_executor) {
+    resource_pool pool(1, 1);
+    const auto strand = asio::make_strand(io);
+    auto handle = pool.try_get_auto_recycle();
+    ASSERT_FALSE(handle.unusable());
+
+    pool.get_auto_waste(strand, [&] (const error_code& ec, resource_pool::handle handle) {
+        EXPECT_EQ(ec, error_code(error::get_resource_timeout));
+        EXPECT_TRUE(handle.empty());
+        EXPECT_TRUE(strand.running_in_this_thread());
+        ASSERT_FALSE(on_get_called.test_and_set());
+    }, std::chrono::milliseconds(1));
+
+    io.run();
+    EXPECT_TRUE(on_get_called.test_and_set());
+    EXPECT_EQ(pool.stats().queue_size, 0u);
+}
+
+TEST_F(async_resource_pool_integration, queued_gets_with_io_context_and_its_executor_should_be_served_in_order) {
+    resource_pool pool(1, 2);
+    auto handle = pool.try_get_auto_recycle();
+    ASSERT_FALSE(handle.unusable());
+    handle.reset(resource {42});
+    std::vector<int> order;
+
+    pool.get_auto_recycle(io, [&] (const error_code& ec, resource_pool::handle handle) {
+        EXPECT_FALSE(ec);
+        EXPECT_FALSE(handle.unusable());
+        order.push_back(1);
+    }, time_traits::duration::max());
+    pool.get_auto_recycle(io.get_executor(), [&] (const error_code& ec, resource_pool::handle handle) {
+        EXPECT_FALSE(ec);
+        EXPECT_FALSE(handle.unusable());
+        order.push_back(2);
+    }, time_traits::duration::max());
+    EXPECT_EQ(pool.stats().queue_size, 2u);
+    handle.recycle();
+
+    io.run();
+    EXPECT_EQ(order, (std::vector<int> {1, 2}));
+}
+
+TEST_F(async_resource_pool_integration, get_many_with_executor_should_complete_on_executor) {
+    resource_pool pool(3, 1);
+    const auto strand = asio::make_strand(io);
+
+    pool.get_many_auto_recycle(strand, 2, [&] (const error_code& ec, std::vector<resource_pool::handle> handles) {
+        EXPECT_FALSE(ec);
+        EXPECT_EQ(handles.size(), 2u);
+        EXPECT_TRUE(strand.running_in_this_thread());
+        ASSERT_FALSE(on_get_called.test_and_set());
+    });
+
+    io.run();
+    EXPECT_TRUE(on_get_called.test_and_set());
+    EXPECT_EQ(pool.used(), 0u);
+}
+
+TEST_F(async_resource_pool_integration, recycle_all_should_post_handlers_bound_to_executors_directly) {
+    resource_pool pool(2, 2);
+    asio::io_context handler_io;
+    std::vector<resource_pool::handle> handles;
+    handles.push_back(pool.try_get_auto_recycle());
+    handles.push_back(pool.try_get_auto_recycle());
+    std::size_t served = 0;
+
+    const auto on_get = [&] (const error_code& ec, resource_pool::handle handle) {
+        EXPECT_FALSE(ec);
+        EXPECT_FALSE(handle.unusable());
+        ++served;
+    };
+    pool.get_auto_waste(io, asio::bind_executor(handler_io, on_get), time_traits::duration::max());
+    pool.get_auto_waste(io, on_get, time_traits::duration::max());
+    pool.recycle_all(handles);
+
+    EXPECT_EQ(handler_io.run(), 1u);
+    EXPECT_EQ(served, 1u);
+    io.run();
+    EXPECT_EQ(served, 2u);
+}
+
+TEST_F(async_resource_pool_integration, canceled_queued_get_should_leave_queue_and_complete_with_operation_aborted) {
+    resource_pool pool(1, 1);
+    auto handle = pool.try_get_auto_recycle();
+    ASSERT_FALSE(handle.unusable());
+    cancellation_signal signal;
+
+    pool.get_auto_waste(io, bind_cancellation_slot(signal.slot(),
+        [&] (const error_code& ec, resource_pool::handle handle) {
+            EXPECT_EQ(ec, error_code(asio::error::operation_aborted));
+            EXPECT_TRUE(handle.unusable());
+            ASSERT_FALSE(on_get_called.test_and_set());
+        }), time_traits::duration::max());
+    EXPECT_EQ(pool.stats().queue_size, 1u);
+
+    signal.emit();
+    EXPECT_EQ(pool.stats().queue_size, 0u);
+
+    io.run();
+    EXPECT_TRUE(on_get_called.test_and_set());
+}
+
+TEST_F(async_resource_pool_integration, resource_recycled_after_cancel_should_be_given_to_next_waiter) {
+    resource_pool pool(1, 2);
+    auto handle = pool.try_get_auto_recycle();
+    ASSERT_FALSE(handle.unusable());
+    handle.reset(resource {42});
+    cancellation_signal signal;
+
+    pool.get_auto_waste(io, bind_cancellation_slot(signal.slot(),
+        [&] (const error_code& ec, resource_pool::handle handle) {
+            EXPECT_EQ(ec, error_code(asio::error::operation_aborted));
+            EXPECT_TRUE(handle.unusable());
+            ASSERT_FALSE(on_get1_called.test_and_set());
+        }), time_traits::duration::max());
+    pool.get_auto_waste(io, [&] (const error_code& ec, resource_pool::handle handle) {
+        EXPECT_FALSE(ec);
+        EXPECT_EQ(handle.get(), resource {42});
+        ASSERT_FALSE(on_get2_called.test_and_set());
+    }, time_traits::duration::max());
+
+    signal.emit();
+    handle.recycle();
+
+    io.run();
+    EXPECT_TRUE(on_get1_called.test_and_set());
+    EXPECT_TRUE(on_get2_called.test_and_set());
+}
+
+TEST_F(async_resource_pool_integration, cancel_after_completion_should_do_nothing) {
+    resource_pool pool(1, 1);
+    cancellation_signal signal;
+
+    pool.get_auto_recycle(io, bind_cancellation_slot(signal.slot(),
+        [&] (const error_code& ec, resource_pool::handle handle) {
+            EXPECT_FALSE(ec);
+            EXPECT_FALSE(handle.unusable());
+            ASSERT_FALSE(on_get_called.test_and_set());
+            signal.emit();
+        }), time_traits::duration::max());
+
+    io.run();
+    signal.emit();
+    EXPECT_TRUE(on_get_called.test_and_set());
+    EXPECT_EQ(pool.available(), 1u);
+}
+
+TEST_F(async_resource_pool_integration, cancel_of_served_request_before_completion_should_do_nothing) {
+    resource_pool pool(1, 1);
+    auto handle = pool.try_get_auto_recycle();
+    ASSERT_FALSE(handle.unusable());
+    cancellation_signal signal;
+
+    pool.get_auto_recycle(io, bind_cancellation_slot(signal.slot(),
+        [&] (const error_code& ec, resource_pool::handle handle) {
+            EXPECT_FALSE(ec);
+            EXPECT_FALSE(handle.unusable());
+            ASSERT_FALSE(on_get_called.test_and_set());
+        }), time_traits::duration::max());
+    handle.recycle();
+    signal.emit();
+
+    io.run();
+    EXPECT_TRUE(on_get_called.test_and_set());
+}
+
+TEST_F(async_resource_pool_integration, canceled_queued_get_of_fast_path_pool_should_complete_with_operation_aborted) {
+    fast_path_resource_pool pool(1, 1);
+    auto handle = pool.try_get_auto_recycle();
+    ASSERT_FALSE(handle.unusable());
+    cancellation_signal signal;
+
+    pool.get_auto_waste(io, bind_cancellation_slot(signal.slot(),
+        [&] (const error_code& ec, fast_path_resource_pool::handle handle) {
+            EXPECT_EQ(ec, error_code(asio::error::operation_aborted));
+            EXPECT_TRUE(handle.unusable());
+            ASSERT_FALSE(on_get_called.test_and_set());
+        }), time_traits::duration::max());
+    signal.emit();
+    EXPECT_EQ(pool.stats().queue_size, 0u);
+    handle.recycle();
+
+    io.run();
+    EXPECT_TRUE(on_get_called.test_and_set());
+    EXPECT_EQ(pool.available(), 1u);
+}
+
+TEST_F(async_resource_pool_integration, canceled_queued_get_many_should_leave_queue_and_complete_with_operation_aborted) {
+    resource_pool pool(1, 1);
+    auto handle = pool.try_get_auto_recycle();
+    ASSERT_FALSE(handle.unusable());
+    handle.reset(resource {42});
+    cancellation_signal signal;
+
+    pool.get_many_auto_recycle(io, 1, bind_cancellation_slot(signal.slot(),
+        [&] (const error_code& ec, std::vector<resource_pool::handle> handles) {
+            EXPECT_EQ(ec, error_code(asio::error::operation_aborted));
+            EXPECT_TRUE(handles.empty());
+            ASSERT_FALSE(on_get_called.test_and_set());
+        }), time_traits::duration::max());
+    EXPECT_EQ(pool.stats().queue_size, 1u);
+
+    signal.emit();
+    EXPECT_EQ(pool.stats().queue_size, 0u);
+    handle.recycle();
+
+    io.run();
+    EXPECT_TRUE(on_get_called.test_and_set());
+    EXPECT_EQ(pool.available(), 1u);
+}
+
+TEST_F(async_resource_pool_integration, canceled_get_many_queued_again_after_served_cell_should_return_the_cell) {
+    resource_pool pool(2, 1);
+    auto handle1 = pool.try_get_auto_recycle();
+    auto handle2 = pool.try_get_auto_recycle();
+    ASSERT_FALSE(handle1.unusable());
+    ASSERT_FALSE(handle2.unusable());
+    handle1.reset(resource {1});
+    handle2.reset(resource {2});
+    cancellation_signal signal;
+
+    pool.get_many_auto_recycle(io, 2, bind_cancellation_slot(signal.slot(),
+        [&] (const error_code& ec, std::vector<resource_pool::handle> handles) {
+            EXPECT_EQ(ec, error_code(asio::error::operation_aborted));
+            EXPECT_TRUE(handles.empty());
+            ASSERT_FALSE(on_get_called.test_and_set());
+        }), time_traits::duration::max());
+    handle1.recycle();
+    io.poll();
+    io.restart();
+    EXPECT_EQ(pool.stats().queue_size, 1u);
+    EXPECT_EQ(pool.available(), 1u);
+
+    signal.emit();
+    EXPECT_EQ(pool.stats().queue_size, 0u);
+    handle2.recycle();
+
+    io.run();
+    EXPECT_TRUE(on_get_called.test_and_set());
+    EXPECT_EQ(pool.available(), 2u);
+}
+
+#if BOOST_ASIO_VERSION >= 102000
+TEST_F(async_resource_pool_integration, canceled_queued_get_with_asio_cancellation_slot_should_complete_with_operation_aborted) {
+    resource_pool pool(1, 1);
+    auto handle = pool.try_get_auto_recycle();
+    ASSERT_FALSE(handle.unusable());
+    asio::cancellation_signal signal;
+
+    pool.get_auto_waste(io, asio::bind_cancellation_slot(signal.slot(),
+        [&] (const error_code& ec, resource_pool::handle handle) {
+            EXPECT_EQ(ec, error_code(asio::error::operation_aborted));
+            EXPECT_TRUE(handle.unusable());
+            ASSERT_FALSE(on_get_called.test_and_set());
+        }), time_traits::duration::max());
+    EXPECT_EQ(pool.stats().queue_size, 1u);
+
+    signal.emit(asio::cancellation_type::terminal);
+    EXPECT_EQ(pool.stats().queue_size, 0u);
+    handle.recycle();
+
+    io.run();
+    EXPECT_TRUE(on_get_called.test_and_set());
+    EXPECT_EQ(pool.available(), 1u);
+}
+#endif
+
+struct foreign_cancellation_slot {
+    bool* cleared;
+
+    void clear() const { *cleared = true; }
+};
+
+template <class Handler>
+struct foreign_cancellation_slot_handler {
+    foreign_cancellation_slot slot;
+    Handler handler;
+
+    void operator ()(const error_code& ec, resource_pool::handle handle) {
+        handler(ec, std::move(handle));
+    }
+
+    foreign_cancellation_slot get_cancellation_slot() const noexcept { return slot; }
+};
+
+template <class Handler>
+foreign_cancellation_slot_handler(foreign_cancellation_slot, Handler) -> foreign_cancellation_slot_handler<Handler>;
+
+TEST_F(async_resource_pool_integration, get_with_handler_of_foreign_cancellation_slot_should_complete_without_cancellation) {
+    resource_pool pool(1, 1);
+    auto handle = pool.try_get_auto_recycle();
+    ASSERT_FALSE(handle.unusable());
+    handle.reset(resource {42});
+    bool cleared = false;
+
+    pool.get_auto_waste(io, foreign_cancellation_slot_handler {foreign_cancellation_slot {&cleared},
+        [&] (const error_code& ec, resource_pool::handle handle) {
+            EXPECT_FALSE(ec);
+            EXPECT_EQ(handle.get(), resource {42});
+            ASSERT_FALSE(on_get_called.test_and_set());
+        }}, time_traits::duration::max());
+    EXPECT_EQ(pool.stats().queue_size, 1u);
+    handle.recycle();
+
+    io.run();
+    EXPECT_TRUE(on_get_called.test_and_set());
+    EXPECT_FALSE(cleared);
+}
+
 }
@@ -2,6 +2,8 @@
 
 #include <yamail/resource_pool/async/pool.hpp>
 
+#include <boost/optional/optional_io.hpp>
+
 namespace {
 
 using namespace tests;
@@ -23,6 +25,7 @@ struct mocked_pool_impl : pool_returns<resource> {
     MOCK_CONST_METHOD0(used, std::size_t ());
     MOCK_CONST_METHOD0(stats, async::stats ());
     MOCK_METHOD3(get, void (mocked_io_context&, const callback&, time_traits::duration));
+    MOCK_METHOD0(try_lease, boost::optional<list_iterator> ());
     MOCK_METHOD1(recycle, void (list_iterator));
     MOCK_METHOD1(waste, void (list_iterator));
     MOCK_METHOD0(disable, void ());
@@ -30,6 +33,18 @@ struct mocked_pool_impl : pool_returns<resource> {
 
 using resource_pool = pool<resource, std::mutex, mocked_io_context, StrictMock<mocked_pool_impl>>;
 
+}
+
+namespace tests {
+
+inline std::ostream& operator <<(std::ostream& stream, mocked_pool_impl::list_iterator res) {
+    return stream << &*res;
+}
+
+}
+
+namespace {
+
 using boost::system::error_code;
 
 struct async_resource_pool : Test {
@@ -234,6 +249,31 @@ TEST_F(async_resource_pool, get_from_pool_returns_error_should_not_call_waste_or
     on_get(make_error_code(error::get_resource_timeout), mocked_pool_impl::list_iterator());
 }
 
+TEST_F(async_resource_pool, try_get_auto_waste_with_available_resource_should_return_handle_calling_waste) {
+    const auto pool_impl = std::make_shared<StrictMock<mocked_pool_impl>>();
+    resource_pool pool(pool_impl);
+
+    InSequence s;
+
+    EXPECT_CALL(*pool_impl, try_lease()).WillOnce(Return(resource_iterator));
+    EXPECT_CALL(*pool_impl, waste(resource_iterator)).WillOnce(Return());
+    EXPECT_CALL(*pool_impl, disable()).WillOnce(Return());
+
+    EXPECT_FALSE(pool.try_get_auto_waste().unusable());
+}
+
+TEST_F(async_resource_pool, try_get_auto_recycle_without_available_resource_should_return_unusable_handle) {
+    const auto pool_impl = std::make_shared<StrictMock<mocked_pool_impl>>();
+    resource_pool pool(pool_impl);
+
+    InSequence s;
+
+    EXPECT_CALL(*pool_impl, try_lease()).WillOnce(Return(boost::none));
+    EXPECT_CALL(*pool_impl, disable()).WillOnce(Return());
+
+    EXPECT_TRUE(pool.try_get_auto_recycle().unusable());
+}
+
 struct mocked_callback {
     MOCK_METHOD0(call, void ());
 };
@@ -261,12 +301,13 @@ TEST_F(async_resource_pool, asio_use_executor) {
     const InSequence s;
 
     EXPECT_CALL(executor, on_work_started()).WillOnce(Return());
+    EXPECT_CALL(executor, post(_)).WillOnce(InvokeArgument<0>());
     EXPECT_CALL(executor, dispatch(_)).WillOnce(InvokeArgument<0>());
     EXPECT_CALL(*call, call()).WillOnce(Return());
     EXPECT_CALL(executor, on_work_finished()).WillOnce(Return());
 
     pool.get_auto_waste(service, on_get_callback {call, executor_wrapper});
-    service.run();
+    EXPECT_EQ(service.run(), 0u);
 }
 
 }
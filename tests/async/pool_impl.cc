@@ -1,6 +1,7 @@
 #include "tests.hpp"
 
 #include <yamail/resource_pool/async/detail/pool_impl.hpp>
+#include <yamail/resource_pool/detail/magazine_cache.hpp>
 
 #include <boost/optional/optional_io.hpp>
 
@@ -13,7 +14,8 @@ using namespace yamail::resource_pool::async::detail;
 struct mocked_queue {
     using list_iterator = std::list<detail::idle<resource>>::iterator;
     using value_type = list_iterator_handler<resource>;
-    using queued_value_t = queued_value<value_type, mocked_io_context>;
+    using executor_type = mocked_executor;
+    using queued_value_t = queued_value<value_type, executor_type>;
 
     MOCK_CONST_METHOD3(push, bool (mocked_io_context&, time_traits::duration, const value_type&));
     MOCK_CONST_METHOD0(pop, boost::optional<queued_value_t> ());
@@ -27,7 +29,7 @@ using resource_ptr_list_iterator = resource_pool_impl::list_iterator;
 using queued_value_t = mocked_queue::queued_value_t;
 
 auto make_queued_value(mocked_queue::value_type&& request, mocked_io_context& io) {
-    return boost::optional<queued_value_t>(queued_value_t {std::move(request), io});
+    return boost::optional<queued_value_t>(queued_value_t {std::move(request), io.get_executor()});
 }
 
 }
@@ -425,8 +427,8 @@ TEST_F(async_resource_pool_impl, get_recycled_after_disable_returns_error) {
     pool.get(io, check_error(error::disabled), time_traits::duration(1));
 
     EXPECT_CALL(pool.queue(), pop()).WillOnce(Return(ByMove(make_queued_value(std::move(on_get_res), io))));
-    EXPECT_CALL(executor, dispatch(_)).WillOnce(SaveArg<0>(&on_second_get));
     EXPECT_CALL(pool.queue(), pop()).WillOnce(Return(ByMove(boost::none)));
+    EXPECT_CALL(executor, dispatch(_)).WillOnce(SaveArg<0>(&on_second_get));
     EXPECT_CALL(pool.queue(), pop()).WillOnce(Return(ByMove(boost::none)));
     pool.disable();
     on_first_get();
@@ -575,4 +577,346 @@ TEST_F(async_resource_pool_impl, should_waste_used_resource_after_invalidate_whe
     on_second_get();
 }
 
+TEST_F(async_resource_pool_impl, drop_expired_should_waste_expired_available_resources) {
+    resource_pool_impl pool([]{ return resource{}; }, 2, 0, time_traits::duration(0), time_traits::duration::max());
+
+    EXPECT_EQ(pool.available(), 2u);
+
+    pool.drop_expired();
+
+    EXPECT_EQ(pool.available(), 0u);
+}
+
+TEST_F(async_resource_pool_impl, drop_expired_should_keep_not_expired_available_resources) {
+    resource_pool_impl pool([]{ return resource{}; }, 2, 0, time_traits::duration::max(), time_traits::duration::max());
+
+    pool.drop_expired();
+
+    EXPECT_EQ(pool.available(), 2u);
+}
+
+TEST_F(async_resource_pool_impl, try_lease_should_return_available_resource) {
+    resource_pool_impl pool([]{ return resource{}; }, 1, 0, time_traits::duration::max(), time_traits::duration::max());
+
+    const auto res = pool.try_lease();
+
+    ASSERT_TRUE(res);
+    EXPECT_TRUE((*res)->value);
+    EXPECT_EQ(pool.available(), 0u);
+    EXPECT_EQ(pool.used(), 1u);
+}
+
+TEST_F(async_resource_pool_impl, try_lease_without_capacity_should_return_none) {
+    resource_pool_impl pool(1, 0, time_traits::duration::max(), time_traits::duration::max());
+
+    EXPECT_TRUE(pool.try_lease());
+    EXPECT_FALSE(pool.try_lease());
+}
+
+TEST_F(async_resource_pool_impl, try_lease_after_disable_should_return_none) {
+    resource_pool_impl pool(1, 0, time_traits::duration::max(), time_traits::duration::max());
+
+    EXPECT_CALL(pool.queue(), pop()).WillOnce(Return(ByMove(boost::none)));
+
+    pool.disable();
+
+    EXPECT_FALSE(pool.try_lease());
+}
+
+struct counting_allocator_state {
+    std::size_t allocations = 0;
+    std::size_t deallocations = 0;
+};
+
+template <class T>
+struct counting_allocator {
+    using value_type = T;
+
+    counting_allocator_state* state;
+
+    explicit counting_allocator(counting_allocator_state* state) : state(state) {}
+
+    template <class U>
+    counting_allocator(const counting_allocator<U>& other) : state(other.state) {}
+
+    T* allocate(std::size_t n) {
+        ++state->allocations;
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* ptr, std::size_t n) {
+        ++state->deallocations;
+        std::allocator<T>().deallocate(ptr, n);
+    }
+
+    friend bool operator ==(const counting_allocator& lhs, const counting_allocator& rhs) {
+        return lhs.state == rhs.state;
+    }
+
+    friend bool operator !=(const counting_allocator& lhs, const counting_allocator& rhs) {
+        return !(lhs == rhs);
+    }
+};
+
+template <std::size_t size>
+struct sized_handler {
+    using allocator_type = counting_allocator<void>;
+
+    counting_allocator_state* state;
+    std::shared_ptr<std::size_t> calls;
+    std::array<char, size> payload {};
+
+    void operator ()(error_code, resource_ptr_list_iterator) const {
+        ++*calls;
+    }
+
+    allocator_type get_allocator() const noexcept {
+        return allocator_type(state);
+    }
+};
+
+using small_handler = sized_handler<16>;
+using large_handler = sized_handler<list_iterator_handler_buffer_size>;
+
+TEST(async_list_iterator_handler, create_from_small_handler_should_not_allocate) {
+    counting_allocator_state state;
+    const auto calls = std::make_shared<std::size_t>(0);
+    {
+        mocked_queue::value_type handler(small_handler {&state, calls});
+        handler(error_code(), resource_ptr_list_iterator());
+    }
+    EXPECT_EQ(*calls, 1u);
+    EXPECT_EQ(state.allocations, 0u);
+}
+
+TEST(async_list_iterator_handler, create_from_large_handler_should_use_associated_allocator) {
+    counting_allocator_state state;
+    const auto calls = std::make_shared<std::size_t>(0);
+    {
+        mocked_queue::value_type handler(large_handler {&state, calls});
+        handler(error_code(), resource_ptr_list_iterator());
+        EXPECT_EQ(state.allocations, 1u);
+        EXPECT_EQ(state.deallocations, 0u);
+    }
+    EXPECT_EQ(*calls, 1u);
+    EXPECT_EQ(state.deallocations, 1u);
+}
+
+TEST(async_list_iterator_handler, move_should_transfer_handler) {
+    counting_allocator_state state;
+    const auto calls = std::make_shared<std::size_t>(0);
+    mocked_queue::value_type handler(small_handler {&state, calls});
+    mocked_queue::value_type moved(std::move(handler));
+    EXPECT_EQ(calls.use_count(), 2);
+    moved(error_code());
+    EXPECT_EQ(*calls, 1u);
+    mocked_queue::value_type assigned;
+    assigned = std::move(moved);
+    assigned(resource_ptr_list_iterator());
+    EXPECT_EQ(*calls, 2u);
+    EXPECT_EQ(calls.use_count(), 2);
+}
+
+TEST(async_list_iterator_handler, move_large_handler_should_not_allocate) {
+    counting_allocator_state state;
+    const auto calls = std::make_shared<std::size_t>(0);
+    {
+        mocked_queue::value_type handler(large_handler {&state, calls});
+        mocked_queue::value_type moved(std::move(handler));
+        moved(error_code());
+    }
+    EXPECT_EQ(*calls, 1u);
+    EXPECT_EQ(state.allocations, 1u);
+    EXPECT_EQ(state.deallocations, 1u);
+}
+
+using cached_resource_pool_impl = pool_impl<resource, std::mutex, mocked_io_context, mocked_queue,
+    detail::storage<resource>, cell_ring>;
+
+template <class Pool>
+struct set_and_recycle_cached_resource {
+    Pool& pool;
+
+    void operator ()(const error_code& err, resource_ptr_list_iterator res) const {
+        EXPECT_EQ(err, error_code());
+        res->value = resource {};
+        res->reset_time = time_traits::now();
+        pool.recycle(res);
+    }
+};
+
+template <class Pool>
+set_and_recycle_cached_resource(Pool&) -> set_and_recycle_cached_resource<Pool>;
+
+struct save_cached_resource {
+    boost::optional<resource_ptr_list_iterator>& result;
+
+    void operator ()(const error_code& err, resource_ptr_list_iterator res) const {
+        EXPECT_EQ(err, error_code());
+        result = res;
+    }
+};
+
+TEST_F(async_resource_pool_impl, cached_recycle_without_waiters_should_not_lock_queue) {
+    cached_resource_pool_impl pool(1, 0, time_traits::duration::max(), time_traits::duration::max());
+
+    EXPECT_CALL(executor, post(_)).WillOnce(SaveArg<0>(&on_get));
+    EXPECT_CALL(pool.queue(), pop()).Times(0);
+
+    pool.get(io, set_and_recycle_cached_resource {pool});
+    on_get();
+
+    EXPECT_EQ(pool.available(), 1u);
+    EXPECT_EQ(pool.used(), 0u);
+    EXPECT_EQ(pool.size(), 1u);
+}
+
+TEST_F(async_resource_pool_impl, cached_get_after_recycle_should_return_same_cell) {
+    cached_resource_pool_impl pool(1, 0, time_traits::duration::max(), time_traits::duration::max());
+    boost::optional<resource_ptr_list_iterator> first;
+    boost::optional<resource_ptr_list_iterator> second;
+
+    EXPECT_CALL(executor, post(_)).WillOnce(SaveArg<0>(&on_first_get)).WillOnce(SaveArg<0>(&on_second_get));
+
+    pool.get(io, save_cached_resource {first});
+    on_first_get();
+    ASSERT_TRUE(first);
+    (*first)->value = resource {};
+    (*first)->reset_time = time_traits::now();
+    pool.recycle(*first);
+
+    pool.get(io, save_cached_resource {second});
+    on_second_get();
+    ASSERT_TRUE(second);
+    EXPECT_EQ(*first, *second);
+    EXPECT_TRUE((*second)->value);
+    EXPECT_EQ(pool.available(), 0u);
+    EXPECT_EQ(pool.used(), 1u);
+}
+
+TEST_F(async_resource_pool_impl, cached_invalidate_should_drop_cached_resources) {
+    cached_resource_pool_impl pool(1, 0, time_traits::duration::max(), time_traits::duration::max());
+
+    EXPECT_CALL(executor, post(_)).WillOnce(SaveArg<0>(&on_get));
+
+    pool.get(io, set_and_recycle_cached_resource {pool});
+    on_get();
+    pool.invalidate();
+
+    EXPECT_EQ(pool.available(), 0u);
+    EXPECT_EQ(pool.used(), 0u);
+}
+
+TEST_F(async_resource_pool_impl, cached_recycle_of_resource_leased_before_invalidate_should_waste_it) {
+    cached_resource_pool_impl pool(1, 0, time_traits::duration::max(), time_traits::duration::max());
+    boost::optional<resource_ptr_list_iterator> res;
+
+    EXPECT_CALL(executor, post(_)).WillOnce(SaveArg<0>(&on_get));
+    EXPECT_CALL(pool.queue(), pop()).WillOnce(Return(ByMove(boost::none)));
+
+    pool.get(io, save_cached_resource {res});
+    on_get();
+    ASSERT_TRUE(res);
+    (*res)->value = resource {};
+    (*res)->reset_time = time_traits::now();
+    pool.invalidate();
+    pool.recycle(*res);
+
+    EXPECT_EQ(pool.available(), 0u);
+    EXPECT_EQ(pool.used(), 0u);
+}
+
+TEST_F(async_resource_pool_impl, cached_drop_expired_should_drop_expired_cached_resources) {
+    cached_resource_pool_impl pool(1, 0, time_traits::duration(0), time_traits::duration::max());
+
+    EXPECT_CALL(executor, post(_)).WillOnce(SaveArg<0>(&on_get));
+
+    pool.get(io, set_and_recycle_cached_resource {pool});
+    on_get();
+    pool.drop_expired();
+
+    EXPECT_EQ(pool.available(), 0u);
+    EXPECT_EQ(pool.used(), 0u);
+}
+
+TEST_F(async_resource_pool_impl, cached_recycle_with_waiter_should_serve_queued_request) {
+    cached_resource_pool_impl pool(1, 1, time_traits::duration::max(), time_traits::duration::max());
+    boost::optional<resource_ptr_list_iterator> first;
+    boost::optional<resource_ptr_list_iterator> second;
+
+    InSequence s;
+
+    EXPECT_CALL(executor, post(_)).WillOnce(SaveArg<0>(&on_first_get));
+    EXPECT_CALL(pool.queue(), push(_, _, _)).WillOnce(DoAll(SaveMoveArg2(&on_get_res), Return(true)));
+
+    pool.get(io, save_cached_resource {first});
+    on_first_get();
+    ASSERT_TRUE(first);
+    pool.get(io, save_cached_resource {second}, time_traits::duration(1));
+
+    EXPECT_CALL(pool.queue(), pop()).WillOnce(Return(ByMove(make_queued_value(std::move(on_get_res), io))));
+    EXPECT_CALL(executor, post(_)).WillOnce(SaveArg<0>(&on_second_get));
+
+    (*first)->value = resource {};
+    (*first)->reset_time = time_traits::now();
+    pool.recycle(*first);
+    on_second_get();
+
+    ASSERT_TRUE(second);
+    EXPECT_EQ(*first, *second);
+}
+
+using magazine_resource_pool_impl = pool_impl<resource, std::mutex, mocked_io_context, mocked_queue,
+    detail::storage<resource>, detail::magazine_cache>;
+
+TEST_F(async_resource_pool_impl, magazine_get_after_recycle_in_same_thread_should_return_same_cell_without_locking_queue) {
+    magazine_resource_pool_impl pool(2, 0, time_traits::duration::max(), time_traits::duration::max());
+    boost::optional<resource_ptr_list_iterator> first;
+    boost::optional<resource_ptr_list_iterator> second;
+
+    EXPECT_CALL(executor, post(_)).WillOnce(SaveArg<0>(&on_first_get)).WillOnce(SaveArg<0>(&on_second_get));
+    EXPECT_CALL(pool.queue(), pop()).Times(0);
+
+    pool.get(io, save_cached_resource {first});
+    on_first_get();
+    ASSERT_TRUE(first);
+    (*first)->value = resource {};
+    (*first)->reset_time = time_traits::now();
+    pool.recycle(*first);
+    EXPECT_EQ(pool.available(), 1u);
+
+    pool.get(io, save_cached_resource {second});
+    on_second_get();
+    ASSERT_TRUE(second);
+    EXPECT_EQ(*first, *second);
+    EXPECT_EQ(pool.available(), 0u);
+    EXPECT_EQ(pool.used(), 1u);
+}
+
+TEST_F(async_resource_pool_impl, magazine_invalidate_should_drop_resources_in_magazines) {
+    magazine_resource_pool_impl pool(1, 0, time_traits::duration::max(), time_traits::duration::max());
+
+    EXPECT_CALL(executor, post(_)).WillOnce(SaveArg<0>(&on_get));
+
+    pool.get(io, set_and_recycle_cached_resource {pool});
+    on_get();
+    pool.invalidate();
+
+    EXPECT_EQ(pool.available(), 0u);
+    EXPECT_EQ(pool.used(), 0u);
+}
+
+TEST_F(async_resource_pool_impl, magazine_drop_expired_should_drop_expired_resources_in_magazines) {
+    magazine_resource_pool_impl pool(1, 0, time_traits::duration(0), time_traits::duration::max());
+
+    EXPECT_CALL(executor, post(_)).WillOnce(SaveArg<0>(&on_get));
+
+    pool.get(io, set_and_recycle_cached_resource {pool});
+    on_get();
+    pool.drop_expired();
+
+    EXPECT_EQ(pool.available(), 0u);
+    EXPECT_EQ(pool.used(), 0u);
+}
+
 }
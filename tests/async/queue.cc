@@ -18,9 +18,11 @@ struct mocked_timer {
 };
 
 struct timer {
+    using executor_type = mocked_executor;
+
     std::unique_ptr<mocked_timer> impl = std::make_unique<mocked_timer>();
 
-    timer(mocked_io_context&) {}
+    timer(const executor_type&) {}
 
     time_traits::time_point expires_at() const {
         return impl->expires_at();
@@ -155,10 +157,74 @@ TEST_F(async_request_queue, push_then_pop_should_return_request) {
     EXPECT_FALSE(queue->empty());
     const auto result = queue->pop();
     ASSERT_TRUE(result);
-    EXPECT_EQ(&result->io_context, &io1);
+    EXPECT_EQ(result->executor, io1.get_executor());
     EXPECT_EQ(result->request.impl, expired);
 }
 
+TEST_F(async_request_queue, timer_of_io_context_should_be_timer_of_its_executor) {
+    request_queue queue(1);
+    EXPECT_EQ(&queue.timer(io1), &queue.timer(executor_wrapper1));
+    EXPECT_NE(&queue.timer(io1), &queue.timer(io2));
+}
+
+TEST_F(async_request_queue, push_with_io_context_and_its_executor_should_arm_one_timer) {
+    request_queue_ptr queue = make_queue(2);
+
+    EXPECT_CALL(*queue->timer(io1).impl, expires_at(_)).WillOnce(Return());
+    EXPECT_CALL(*queue->timer(io1).impl, async_wait(_)).WillOnce(SaveArg<0>(&on_async_wait));
+    EXPECT_CALL(*queue->timer(io1).impl, cancel()).WillOnce(Return());
+    EXPECT_CALL(*expired, call(_)).Times(0);
+
+    EXPECT_TRUE(queue->push(io1, time_traits::duration(1), callback(expired)));
+    EXPECT_TRUE(queue->push(executor_wrapper1, time_traits::duration(2), callback(expired)));
+
+    const auto first = queue->pop();
+    ASSERT_TRUE(first);
+    EXPECT_EQ(first->executor, executor_wrapper1);
+    const auto second = queue->pop();
+    ASSERT_TRUE(second);
+    EXPECT_EQ(second->executor, executor_wrapper1);
+}
+
+TEST_F(async_request_queue, push_then_cancel_should_remove_request_and_call_it_with_operation_aborted) {
+    request_queue_ptr queue = make_queue(1);
+    yamail::resource_pool::async::cancellation_signal signal;
+
+    InSequence s;
+
+    EXPECT_CALL(*queue->timer(io1).impl, expires_at(_)).WillOnce(Return());
+    EXPECT_CALL(*queue->timer(io1).impl, async_wait(_)).WillOnce(SaveArg<0>(&on_async_wait));
+    EXPECT_CALL(executor1, post(_)).WillOnce(InvokeArgument<0>());
+    EXPECT_CALL(*expired, call(error_code(asio::error::operation_aborted))).WillOnce(Return());
+    EXPECT_CALL(*queue->timer(io1).impl, cancel()).WillOnce(Return());
+
+    EXPECT_TRUE(queue->push(io1, time_traits::duration(1), callback(expired), signal.slot()));
+
+    signal.emit();
+
+    EXPECT_TRUE(queue->empty());
+    EXPECT_EQ(queue->size(), 0u);
+}
+
+TEST_F(async_request_queue, cancel_after_pop_should_do_nothing) {
+    request_queue_ptr queue = make_queue(1);
+    yamail::resource_pool::async::cancellation_signal signal;
+
+    InSequence s;
+
+    EXPECT_CALL(*queue->timer(io1).impl, expires_at(_)).WillOnce(Return());
+    EXPECT_CALL(*queue->timer(io1).impl, async_wait(_)).WillOnce(SaveArg<0>(&on_async_wait));
+    EXPECT_CALL(*queue->timer(io1).impl, cancel()).WillOnce(Return());
+    EXPECT_CALL(*expired, call(_)).Times(0);
+
+    EXPECT_TRUE(queue->push(io1, time_traits::duration(1), callback(expired), signal.slot()));
+    EXPECT_TRUE(queue->pop());
+
+    signal.emit();
+
+    EXPECT_TRUE(queue->empty());
+}
+
 TEST_F(async_request_queue, push_into_queue_with_null_capacity_should_return_error) {
     request_queue_ptr queue = make_queue(0);
 
@@ -185,10 +251,6 @@ TEST_F(async_request_queue, push_twice_with_different_io_contexts_then_pop_twice
 
     EXPECT_CALL(*queue->timer(io1).impl, expires_at(_)).InSequence(s).WillOnce(Return());
     EXPECT_CALL(*queue->timer(io1).impl, async_wait(_)).InSequence(s).WillOnce(Return());
-    EXPECT_CALL(*queue->timer(io1).impl, expires_at(_)).InSequence(s).WillOnce(Return());
-    EXPECT_CALL(*queue->timer(io1).impl, async_wait(_)).InSequence(s).WillOnce(Return());
-    EXPECT_CALL(*queue->timer(io2).impl, expires_at(_)).InSequence(s).WillOnce(Return());
-    EXPECT_CALL(*queue->timer(io2).impl, async_wait(_)).InSequence(s).WillOnce(Return());
     EXPECT_CALL(*queue->timer(io1).impl, cancel()).WillOnce(Return());
     EXPECT_CALL(*queue->timer(io2).impl, cancel()).WillOnce(Return());
     EXPECT_CALL(*expired1, call(_)).Times(0);
@@ -203,12 +265,12 @@ TEST_F(async_request_queue, push_twice_with_different_io_contexts_then_pop_twice
 
     const auto result1 = queue->pop();
     ASSERT_TRUE(result1);
-    EXPECT_EQ(&result1->io_context, &io1);
+    EXPECT_EQ(result1->executor, io1.get_executor());
     EXPECT_EQ(result1->request.impl, expired1);
 
     const auto result2 = queue->pop();
     ASSERT_TRUE(result2);
-    EXPECT_EQ(&result2->io_context, &io2);
+    EXPECT_EQ(result2->executor, io2.get_executor());
     EXPECT_EQ(result2->request.impl, expired2);
 }
 
@@ -226,8 +288,6 @@ TEST_F(async_request_queue, push_twice_with_different_io_contexts_where_second_e
     EXPECT_CALL(*queue->timer(io1).impl, async_wait(_)).InSequence(s).WillOnce(Return());
     EXPECT_CALL(*queue->timer(io2).impl, expires_at(_)).InSequence(s).WillOnce(Return());
     EXPECT_CALL(*queue->timer(io2).impl, async_wait(_)).InSequence(s).WillOnce(Return());
-    EXPECT_CALL(*queue->timer(io2).impl, expires_at(_)).InSequence(s).WillOnce(Return());
-    EXPECT_CALL(*queue->timer(io2).impl, async_wait(_)).InSequence(s).WillOnce(Return());
     EXPECT_CALL(*queue->timer(io1).impl, cancel()).WillOnce(Return());
     EXPECT_CALL(*queue->timer(io2).impl, cancel()).WillOnce(Return());
     EXPECT_CALL(*expired1, call(_)).Times(0);
@@ -242,12 +302,12 @@ TEST_F(async_request_queue, push_twice_with_different_io_contexts_where_second_e
 
     const auto result1 = queue->pop();
     ASSERT_TRUE(result1);
-    EXPECT_EQ(&result1->io_context, &io1);
+    EXPECT_EQ(result1->executor, io1.get_executor());
     EXPECT_EQ(result1->request.impl, expired1);
 
     const auto result2 = queue->pop();
     ASSERT_TRUE(result2);
-    EXPECT_EQ(&result2->io_context, &io2);
+    EXPECT_EQ(result2->executor, io2.get_executor());
     EXPECT_EQ(result2->request.impl, expired2);
 }
 
@@ -255,7 +315,6 @@ TEST_F(async_request_queue, push_twice_with_different_io_serivices_and_timeout_b
     auto& expired1 = expired;
     auto& on_async_wait1 = on_async_wait;
     auto expired2 = std::make_shared<mocked_callback>();
-    std::function<void (error_code)> on_async_wait2;
     const auto queue = make_queue(2);
 
     Sequence s;
@@ -263,14 +322,10 @@ TEST_F(async_request_queue, push_twice_with_different_io_serivices_and_timeout_b
     (void) queue->timer(io1);
     (void) queue->timer(io2);
 
-    EXPECT_CALL(*queue->timer(io1).impl, expires_at(_)).InSequence(s).WillOnce(Return());
-    EXPECT_CALL(*queue->timer(io1).impl, async_wait(_)).InSequence(s).WillOnce(SaveArg<0>(&on_async_wait1));
     EXPECT_CALL(*queue->timer(io1).impl, expires_at(_)).InSequence(s).WillOnce(Return());
     EXPECT_CALL(*queue->timer(io1).impl, async_wait(_)).InSequence(s).WillOnce(SaveArg<0>(&on_async_wait1));
     EXPECT_CALL(executor1, post(_)).InSequence(s).WillOnce(InvokeArgument<0>());
     EXPECT_CALL(*expired1, call(_)).InSequence(s).WillOnce(Return());
-    EXPECT_CALL(*queue->timer(io2).impl, expires_at(_)).InSequence(s).WillOnce(Return());
-    EXPECT_CALL(*queue->timer(io2).impl, async_wait(_)).InSequence(s).WillOnce(SaveArg<0>(&on_async_wait2));
     EXPECT_CALL(executor2, post(_)).InSequence(s).WillOnce(InvokeArgument<0>());
     EXPECT_CALL(*expired2, call(_)).InSequence(s).WillOnce(Return());
     EXPECT_CALL(*queue->timer(io1).impl, cancel()).WillOnce(Return());
@@ -280,9 +335,88 @@ TEST_F(async_request_queue, push_twice_with_different_io_serivices_and_timeout_b
     ASSERT_TRUE(queue->push(io2, time_traits::duration(0), callback(expired2)));
 
     on_async_wait1(error_code());
-    on_async_wait2(error_code());
 
     EXPECT_TRUE(queue->empty());
 }
 
+TEST_F(async_request_queue, push_twice_then_pop_and_timeout_before_second_request_expiration_should_rearm_timer) {
+    auto& expired1 = expired;
+    auto expired2 = std::make_shared<mocked_callback>();
+    const auto queue = make_queue(2);
+
+    InSequence s;
+
+    EXPECT_CALL(*queue->timer(io1).impl, expires_at(_)).WillOnce(Return());
+    EXPECT_CALL(*queue->timer(io1).impl, async_wait(_)).WillOnce(SaveArg<0>(&on_async_wait));
+    EXPECT_CALL(*queue->timer(io1).impl, expires_at(_)).WillOnce(Return());
+    EXPECT_CALL(*queue->timer(io1).impl, async_wait(_)).WillOnce(Return());
+    EXPECT_CALL(*queue->timer(io1).impl, cancel()).WillOnce(Return());
+    EXPECT_CALL(*expired1, call(_)).Times(0);
+    EXPECT_CALL(*expired2, call(_)).Times(0);
+
+    ASSERT_TRUE(queue->push(io1, std::chrono::hours(1), callback(expired1)));
+    ASSERT_TRUE(queue->push(io1, std::chrono::hours(2), callback(expired2)));
+
+    const auto result1 = queue->pop();
+    ASSERT_TRUE(result1);
+    EXPECT_EQ(result1->request.impl, expired1);
+
+    on_async_wait(error_code());
+
+    EXPECT_EQ(queue->size(), 1u);
+
+    const auto result2 = queue->pop();
+    ASSERT_TRUE(result2);
+    EXPECT_EQ(result2->request.impl, expired2);
+}
+
+TEST_F(async_request_queue, push_front_of_popped_request_should_return_it_before_others_keeping_its_deadline) {
+    auto& expired1 = expired;
+    auto expired2 = std::make_shared<mocked_callback>();
+    const auto queue = make_queue(2);
+    time_traits::time_point expires_at;
+
+    InSequence s;
+
+    EXPECT_CALL(*queue->timer(io1).impl, expires_at(_)).WillOnce(SaveArg<0>(&expires_at));
+    EXPECT_CALL(*queue->timer(io1).impl, async_wait(_)).WillOnce(SaveArg<0>(&on_async_wait));
+    EXPECT_CALL(*queue->timer(io1).impl, cancel()).WillOnce(Return());
+    EXPECT_CALL(*expired1, call(_)).Times(0);
+    EXPECT_CALL(*expired2, call(_)).Times(0);
+
+    ASSERT_TRUE(queue->push(io1, std::chrono::hours(1), callback(expired1)));
+    ASSERT_TRUE(queue->push(io1, std::chrono::hours(1), callback(expired2)));
+    auto result1 = queue->pop();
+    ASSERT_TRUE(result1);
+
+    queue->push_front(io1, expires_at, std::chrono::hours(1), std::move(result1->request));
+    EXPECT_EQ(queue->size(), 2u);
+
+    const auto first = queue->pop();
+    ASSERT_TRUE(first);
+    EXPECT_EQ(first->request.impl, expired1);
+    const auto second = queue->pop();
+    ASSERT_TRUE(second);
+    EXPECT_EQ(second->request.impl, expired2);
+}
+
+TEST_F(async_request_queue, push_then_pop_with_multimap_deadline_index_should_return_request) {
+    const auto queue = std::make_shared<async::detail::queue<callback, std::mutex, mocked_io_context, timer,
+        multimap_deadline_index>>(1);
+
+    InSequence s;
+
+    EXPECT_CALL(*queue->timer(io1).impl, expires_at(_)).WillOnce(Return());
+    EXPECT_CALL(*queue->timer(io1).impl, async_wait(_)).WillOnce(Return());
+    EXPECT_CALL(*queue->timer(io1).impl, cancel()).WillOnce(Return());
+
+    EXPECT_TRUE(queue->push(io1, time_traits::duration(1), callback(expired)));
+    EXPECT_EQ(queue->size(), 1u);
+
+    const auto result = queue->pop();
+    ASSERT_TRUE(result);
+    EXPECT_EQ(result->request.impl, expired);
+    EXPECT_TRUE(queue->empty());
+}
+
 }
@@ -0,0 +1,348 @@
+#include <yamail/resource_pool/async/sharded_pool.hpp>
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <thread>
+
+namespace {
+
+using namespace testing;
+using namespace yamail::resource_pool;
+using namespace yamail::resource_pool::async;
+
+namespace asio = boost::asio;
+
+struct resource {
+    int value;
+};
+
+using resource_pool = sharded_pool<resource>;
+using boost::system::error_code;
+
+struct async_sharded_resource_pool : Test {
+    asio::io_context io;
+};
+
+TEST_F(async_sharded_resource_pool, create_with_zero_shards_should_throw_exception) {
+    EXPECT_THROW(resource_pool(0, 1, 0), error::zero_pool_capacity);
+}
+
+TEST_F(async_sharded_resource_pool, create_with_capacity_less_than_shards_should_throw_exception) {
+    EXPECT_THROW(resource_pool(2, 1, 0), error::zero_pool_capacity);
+}
+
+TEST_F(async_sharded_resource_pool, create_should_partition_capacity_across_shards) {
+    const resource_pool pool(3, 7, 0);
+    EXPECT_EQ(pool.shards(), 3u);
+    EXPECT_EQ(pool.capacity(), 7u);
+    EXPECT_EQ(pool.shard(0).capacity(), 3u);
+    EXPECT_EQ(pool.shard(1).capacity(), 2u);
+    EXPECT_EQ(pool.shard(2).capacity(), 2u);
+}
+
+TEST_F(async_sharded_resource_pool, create_with_generator_should_fill_all_shards) {
+    const resource_pool pool([] { return resource {42}; }, 2, 4, 0);
+    EXPECT_EQ(pool.available(), 4u);
+    EXPECT_EQ(pool.shard(0).available(), 2u);
+    EXPECT_EQ(pool.shard(1).available(), 2u);
+}
+
+TEST_F(async_sharded_resource_pool, get_should_lease_from_local_shard) {
+    resource_pool pool([] { return resource {42}; }, 2, 2, 0);
+    const auto local = pool.local_shard();
+
+    std::size_t calls = 0;
+    pool.get_auto_recycle(io, [&] (error_code ec, resource_pool::handle handle) {
+        EXPECT_EQ(ec, error_code());
+        EXPECT_FALSE(handle.empty());
+        EXPECT_EQ(pool.shard(local).used(), 1u);
+        EXPECT_EQ(pool.shard(1 - local).used(), 0u);
+        ++calls;
+    });
+    io.run();
+
+    EXPECT_EQ(calls, 1u);
+    EXPECT_EQ(pool.shard(local).available(), 1u);
+}
+
+TEST_F(async_sharded_resource_pool, get_with_executor_should_lease_from_local_shard) {
+    resource_pool pool([] { return resource {42}; }, 2, 2, 0);
+    const auto local = pool.local_shard();
+
+    std::size_t calls = 0;
+    pool.get_auto_recycle(io.get_executor(), [&] (error_code ec, resource_pool::handle handle) {
+        EXPECT_EQ(ec, error_code());
+        EXPECT_FALSE(handle.empty());
+        EXPECT_EQ(pool.shard(local).used(), 1u);
+        ++calls;
+    });
+    io.run();
+
+    EXPECT_EQ(calls, 1u);
+    EXPECT_EQ(pool.shard(local).available(), 1u);
+}
+
+TEST_F(async_sharded_resource_pool, handle_should_return_resource_to_move_assigned_pool) {
+    resource_pool pool([] { return resource {42}; }, 2, 2, 0);
+    boost::optional<resource_pool::handle> handle;
+    pool.get_auto_recycle(io, [&] (error_code ec, resource_pool::handle result) {
+        EXPECT_EQ(ec, error_code());
+        handle = std::move(result);
+    });
+    io.run();
+    ASSERT_TRUE(handle);
+
+    pool = resource_pool(3, 3, 0);
+    EXPECT_EQ(pool.shards(), 3u);
+    (*handle)->value = 13;
+    handle->recycle();
+    EXPECT_TRUE(handle->unusable());
+    EXPECT_EQ(pool.used(), 0u);
+}
+
+TEST_F(async_sharded_resource_pool, destroy_of_not_run_io_context_should_return_leased_resource) {
+    resource_pool pool([] { return resource {42}; }, 2, 2, 0);
+    auto local_io = std::make_unique<asio::io_context>();
+    pool.get_auto_recycle(*local_io, [] (error_code, resource_pool::handle) {});
+    EXPECT_EQ(pool.used(), 1u);
+    local_io.reset();
+    EXPECT_EQ(pool.used(), 0u);
+    EXPECT_EQ(pool.available(), 2u);
+}
+
+TEST_F(async_sharded_resource_pool, get_with_exhausted_local_shard_should_steal_from_other_shard) {
+    resource_pool pool([] { return resource {42}; }, 2, 2, 0);
+    const auto local = pool.local_shard();
+
+    std::vector<resource_pool::handle> handles;
+    for (std::size_t i = 0; i < 2; ++i) {
+        pool.get_auto_recycle(io, [&] (error_code ec, resource_pool::handle handle) {
+            EXPECT_EQ(ec, error_code());
+            EXPECT_FALSE(handle.empty());
+            handles.emplace_back(std::move(handle));
+        });
+    }
+    io.run();
+
+    ASSERT_EQ(handles.size(), 2u);
+    EXPECT_EQ(pool.shard(local).used(), 1u);
+    EXPECT_EQ(pool.shard(1 - local).used(), 1u);
+
+    handles.clear();
+
+    EXPECT_EQ(pool.shard(local).available(), 1u);
+    EXPECT_EQ(pool.shard(1 - local).available(), 1u);
+}
+
+TEST_F(async_sharded_resource_pool, get_should_steal_idle_resource_from_other_shard_before_taking_empty_local_cell) {
+    resource_pool pool(2, 2, 0);
+    const auto local = pool.local_shard();
+    auto empty = pool.try_get_auto_waste();
+    auto idle = pool.try_get_auto_recycle();
+    ASSERT_FALSE(empty.unusable());
+    ASSERT_FALSE(idle.unusable());
+    idle.reset(resource {42});
+    idle.recycle();
+    empty.waste();
+
+    std::size_t calls = 0;
+    pool.get_auto_recycle(io, [&] (error_code ec, resource_pool::handle handle) {
+        EXPECT_EQ(ec, error_code());
+        ASSERT_FALSE(handle.empty());
+        EXPECT_EQ(handle->value, 42);
+        EXPECT_EQ(pool.shard(local).used(), 0u);
+        EXPECT_EQ(pool.shard(1 - local).used(), 1u);
+        ++calls;
+    });
+    io.run();
+
+    EXPECT_EQ(calls, 1u);
+}
+
+TEST_F(async_sharded_resource_pool, try_get_should_steal_idle_resource_from_other_shard_before_taking_empty_local_cell) {
+    resource_pool pool(2, 2, 0);
+    const auto local = pool.local_shard();
+    auto empty = pool.try_get_auto_waste();
+    auto idle = pool.try_get_auto_recycle();
+    idle.reset(resource {42});
+    idle.recycle();
+    empty.waste();
+
+    auto handle = pool.try_get_auto_recycle();
+    ASSERT_FALSE(handle.empty());
+    EXPECT_EQ(handle->value, 42);
+    EXPECT_EQ(pool.shard(local).used(), 0u);
+    EXPECT_EQ(pool.shard(1 - local).used(), 1u);
+
+    auto other = pool.try_get_auto_recycle();
+    ASSERT_FALSE(other.unusable());
+    EXPECT_TRUE(other.empty());
+    EXPECT_EQ(pool.shard(local).used(), 1u);
+}
+
+TEST_F(async_sharded_resource_pool, get_with_exhausted_shards_should_wait_for_resource_returned_into_local_shard) {
+    resource_pool pool([] { return resource {42}; }, 2, 2, 1);
+
+    std::vector<resource_pool::handle> handles;
+    std::size_t calls = 0;
+    for (std::size_t i = 0; i < 2; ++i) {
+        pool.get_auto_recycle(io, [&] (error_code ec, resource_pool::handle handle) {
+            EXPECT_EQ(ec, error_code());
+            handles.emplace_back(std::move(handle));
+        });
+    }
+    io.run();
+    io.restart();
+    ASSERT_EQ(handles.size(), 2u);
+
+    pool.get_auto_recycle(io, [&] (error_code ec, resource_pool::handle handle) {
+        EXPECT_EQ(ec, error_code());
+        EXPECT_FALSE(handle.empty());
+        ++calls;
+    }, time_traits::duration::max());
+    EXPECT_EQ(pool.stats().queue_size, 1u);
+
+    handles.clear();
+    io.run();
+
+    EXPECT_EQ(calls, 1u);
+    EXPECT_EQ(pool.available(), 2u);
+}
+
+TEST_F(async_sharded_resource_pool, get_with_exhausted_shards_should_be_served_by_resource_returned_into_other_shard) {
+    resource_pool pool([] { return resource {42}; }, 2, 2, 1);
+    const auto local = pool.local_shard();
+
+    std::vector<resource_pool::handle> handles;
+    for (std::size_t i = 0; i < 2; ++i) {
+        pool.get_auto_recycle(io, [&] (error_code ec, resource_pool::handle handle) {
+            EXPECT_EQ(ec, error_code());
+            handles.emplace_back(std::move(handle));
+        });
+    }
+    io.run();
+    io.restart();
+    ASSERT_EQ(handles.size(), 2u);
+
+    std::vector<resource_pool::handle> served;
+    pool.get_auto_recycle(io, [&] (error_code ec, resource_pool::handle handle) {
+        EXPECT_EQ(ec, error_code());
+        EXPECT_FALSE(handle.empty());
+        served.emplace_back(std::move(handle));
+    }, time_traits::duration::max());
+    EXPECT_EQ(pool.stats().queue_size, 1u);
+
+    handles.pop_back();
+    io.run();
+
+    ASSERT_EQ(served.size(), 1u);
+    EXPECT_EQ(pool.stats().queue_size, 0u);
+    EXPECT_EQ(pool.shard(local).used(), 1u);
+    EXPECT_EQ(pool.shard(1 - local).used(), 1u);
+
+    served.clear();
+
+    EXPECT_EQ(pool.shard(local).available(), 0u);
+    EXPECT_EQ(pool.shard(1 - local).available(), 1u);
+}
+
+TEST_F(async_sharded_resource_pool, get_from_pool_with_magazines_should_be_served_by_resource_returned_into_other_shard) {
+    using magazine_pool = sharded_pool<resource, std::mutex, asio::io_context,
+        magazine_pool_impl<resource, std::mutex, asio::io_context>::type>;
+    magazine_pool pool([] { return resource {42}; }, 2, 2, 1);
+
+    auto first = pool.try_get_auto_recycle();
+    auto second = pool.try_get_auto_recycle();
+    ASSERT_FALSE(second.unusable());
+
+    std::size_t calls = 0;
+    pool.get_auto_recycle(io, [&] (error_code ec, magazine_pool::handle handle) {
+        EXPECT_EQ(ec, error_code());
+        EXPECT_FALSE(handle.empty());
+        ++calls;
+    }, time_traits::duration::max());
+    EXPECT_EQ(pool.stats().queue_size, 1u);
+
+    second.recycle();
+    io.run();
+
+    EXPECT_EQ(calls, 1u);
+    EXPECT_EQ(pool.available(), 1u);
+}
+
+TEST_F(async_sharded_resource_pool, exhausted_shards_should_have_no_free_cells) {
+    resource_pool pool(2, 3, 0);
+    std::vector<resource_pool::handle> handles;
+    for (std::size_t i = 0; i < 3; ++i) {
+        handles.push_back(pool.try_get_auto_waste());
+        ASSERT_FALSE(handles.back().unusable());
+    }
+    EXPECT_EQ(pool.shard(0).free_cells(), 0u);
+    EXPECT_EQ(pool.shard(1).free_cells(), 0u);
+    handles.clear();
+    EXPECT_EQ(pool.shard(0).free_cells(), 2u);
+    EXPECT_EQ(pool.shard(1).free_cells(), 1u);
+}
+
+TEST_F(async_sharded_resource_pool, get_with_exhausted_shards_and_zero_wait_duration_should_return_error) {
+    resource_pool pool(1, 1, 0);
+
+    std::vector<resource_pool::handle> handles;
+    std::vector<error_code> errors;
+    for (std::size_t i = 0; i < 2; ++i) {
+        pool.get_auto_recycle(io, [&] (error_code ec, resource_pool::handle handle) {
+            errors.push_back(ec);
+            handles.emplace_back(std::move(handle));
+        });
+    }
+    io.run();
+
+    ASSERT_EQ(errors.size(), 2u);
+    EXPECT_EQ(errors[0], error_code());
+    EXPECT_EQ(errors[1], make_error_code(error::get_resource_timeout));
+}
+
+TEST_F(async_sharded_resource_pool, invalidate_should_drop_available_resources_of_all_shards) {
+    resource_pool pool([] { return resource {42}; }, 2, 2, 0);
+    pool.invalidate();
+    EXPECT_EQ(pool.available(), 0u);
+}
+
+TEST_F(async_sharded_resource_pool, get_from_different_threads_should_use_different_shards) {
+    const resource_pool pool(2, 2, 0);
+    std::size_t first = 0;
+    std::size_t second = 0;
+    std::thread([&] { first = pool.local_shard(); }).join();
+    std::thread([&] { second = pool.local_shard(); }).join();
+    EXPECT_NE(first, second);
+}
+
+TEST_F(async_sharded_resource_pool, try_get_should_take_resource_from_other_shard_when_local_is_exhausted) {
+    resource_pool pool(2, 2, 0);
+
+    const auto first = pool.try_get_auto_waste();
+    const auto second = pool.try_get_auto_recycle();
+    EXPECT_FALSE(first.unusable());
+    EXPECT_FALSE(second.unusable());
+    EXPECT_TRUE(pool.try_get_auto_waste().unusable());
+    EXPECT_EQ(pool.used(), 2u);
+}
+
+TEST_F(async_sharded_resource_pool, get_with_dispatch_completion_mode_from_io_context_thread_should_complete_inline) {
+    resource_pool pool(2, 2, 0);
+    bool completed = false;
+
+    asio::post(io, [&] {
+        pool.get_auto_recycle(io, [&] (error_code ec, resource_pool::handle handle) {
+            EXPECT_FALSE(ec);
+            EXPECT_FALSE(handle.unusable());
+            completed = true;
+        }, time_traits::duration(0), completion_mode::dispatch);
+        EXPECT_TRUE(completed);
+    });
+
+    EXPECT_EQ(io.run(), 1u);
+}
+
+}
@@ -0,0 +1,95 @@
+#include <yamail/resource_pool/detail/cell_ring.hpp>
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace testing;
+using namespace yamail::resource_pool::detail;
+
+using ring = cell_ring<int*>;
+
+TEST(cell_ring, create_should_round_capacity_up_to_power_of_2_but_not_less_than_2) {
+    EXPECT_EQ(ring(1).capacity(), 2u);
+    EXPECT_EQ(ring(3).capacity(), 4u);
+    EXPECT_EQ(ring(8).capacity(), 8u);
+}
+
+TEST(cell_ring, pop_from_empty_should_return_false) {
+    ring cells(2);
+    ring::entry entry;
+    EXPECT_FALSE(cells.pop(entry));
+    EXPECT_EQ(cells.size(), 0u);
+}
+
+TEST(cell_ring, push_then_pop_should_return_entries_in_fifo_order) {
+    int values[2];
+    ring cells(2);
+    EXPECT_TRUE(cells.push({&values[0], 1}));
+    EXPECT_TRUE(cells.push({&values[1], 2}));
+    EXPECT_EQ(cells.size(), 2u);
+    ring::entry entry;
+    ASSERT_TRUE(cells.pop(entry));
+    EXPECT_EQ(entry.cell, &values[0]);
+    EXPECT_EQ(entry.generation, 1u);
+    ASSERT_TRUE(cells.pop(entry));
+    EXPECT_EQ(entry.cell, &values[1]);
+    EXPECT_EQ(entry.generation, 2u);
+    EXPECT_EQ(cells.size(), 0u);
+}
+
+TEST(cell_ring, push_into_full_should_return_false) {
+    int value;
+    ring cells(2);
+    EXPECT_TRUE(cells.push({&value, 0}));
+    EXPECT_TRUE(cells.push({&value, 0}));
+    EXPECT_FALSE(cells.push({&value, 0}));
+}
+
+TEST(cell_ring, push_and_pop_many_times_should_wrap_around) {
+    std::vector<int> values(10);
+    ring cells(4);
+    for (auto& value : values) {
+        EXPECT_TRUE(cells.push({&value, 0}));
+        ring::entry entry;
+        ASSERT_TRUE(cells.pop(entry));
+        EXPECT_EQ(entry.cell, &value);
+    }
+}
+
+TEST(cell_ring, concurrent_push_and_pop_should_not_lose_entries) {
+    constexpr std::size_t threads_count = 4;
+    constexpr std::size_t iterations = 10000;
+    std::vector<int> values(threads_count);
+    ring cells(threads_count);
+    for (auto& value : values) {
+        ASSERT_TRUE(cells.push({&value, 0}));
+    }
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < threads_count; ++i) {
+        threads.emplace_back([&] {
+            for (std::size_t n = 0; n < iterations;) {
+                ring::entry entry;
+                if (cells.pop(entry)) {
+                    ++*entry.cell;
+                    while (!cells.push(entry)) {}
+                    ++n;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(cells.size(), threads_count);
+    int sum = 0;
+    for (const auto value : values) {
+        sum += value;
+    }
+    EXPECT_EQ(sum, static_cast<int>(threads_count * iterations));
+}
+
+}
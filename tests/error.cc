@@ -34,6 +34,11 @@ TEST(error_test, make_disabled_error_and_check_message) {
     EXPECT_EQ(error.message(), "resource pool is disabled");
 }
 
+TEST(error_test, make_batch_exceeds_capacity_error_and_check_message) {
+    const error_code error = make_error_code(batch_exceeds_capacity);
+    EXPECT_EQ(error.message(), "requested batch exceeds pool capacity");
+}
+
 TEST(error_test, make_out_of_range_error_and_check_message) {
     const error_code error = make_error_code(code(std::numeric_limits<int>::max()));
     EXPECT_THROW(error.message(), std::logic_error);
@@ -40,7 +40,7 @@ TEST(handle_test, construct_usable_should_be_not_unusable) {
     std::list<idle> resources;
     resources.emplace_back();
     const auto pool_impl = std::make_shared<StrictMock<pool_impl_mock>>();
-    const resource_handle handle(pool_impl, &resource_handle::waste, resources.begin());
+    const resource_handle handle(pool_impl.get(), &resource_handle::waste, resources.begin());
     EXPECT_FALSE(handle.unusable());
     EXPECT_CALL(*pool_impl, waste(_)).WillOnce(Return());
 }
@@ -49,7 +49,7 @@ TEST(handle_test, construct_usable_and_move_then_destination_should_contain_valu
     std::list<idle> resources;
     resources.emplace_back();
     const auto pool_impl = std::make_shared<StrictMock<pool_impl_mock>>();
-    resource_handle src(pool_impl, &resource_handle::waste, resources.begin());
+    resource_handle src(pool_impl.get(), &resource_handle::waste, resources.begin());
     const resource_handle dst = std::move(src);
     EXPECT_FALSE(dst.unusable());
     EXPECT_CALL(*pool_impl, waste(_)).WillOnce(Return());
@@ -59,7 +59,7 @@ TEST(handle_test, construct_usable_and_move_over_assign_then_destination_should_
     std::list<idle> resources;
     resources.emplace_back();
     const auto pool_impl = std::make_shared<StrictMock<pool_impl_mock>>();
-    resource_handle src(pool_impl, &resource_handle::waste, resources.begin());
+    resource_handle src(pool_impl.get(), &resource_handle::waste, resources.begin());
     resource_handle dst;
     dst = std::move(src);
     EXPECT_FALSE(dst.unusable());
@@ -70,7 +70,7 @@ TEST(handle_test, construct_usable_then_get_should_return_value) {
     std::list<idle> resources;
     resources.emplace_back(resource(42), time_traits::time_point(), time_traits::time_point());
     auto pool_impl = std::make_shared<StrictMock<pool_impl_mock>>();
-    resource_handle handle(pool_impl, &resource_handle::waste, resources.begin());
+    resource_handle handle(pool_impl.get(), &resource_handle::waste, resources.begin());
     EXPECT_EQ(42, handle->value);
     EXPECT_CALL(*pool_impl, waste(_)).WillOnce(Return());
 }
@@ -79,7 +79,7 @@ TEST(handle_test, construct_usable_then_get_const_should_return_value) {
     std::list<idle> resources;
     resources.emplace_back(resource(42), time_traits::time_point(), time_traits::time_point());
     auto pool_impl = std::make_shared<StrictMock<pool_impl_mock>>();
-    const resource_handle handle(pool_impl, &resource_handle::waste, resources.begin());
+    const resource_handle handle(pool_impl.get(), &resource_handle::waste, resources.begin());
     EXPECT_EQ(42, handle->value);
     EXPECT_CALL(*pool_impl, waste(_)).WillOnce(Return());
 }
@@ -89,8 +89,8 @@ TEST(handle_test, move_to_usable_should_release_replaced_resource) {
     const auto pool_impl = std::make_shared<StrictMock<pool_impl_mock>>();
     const auto src_res = resources.begin();
     const auto dst_res = std::next(resources.begin());
-    resource_handle src(pool_impl, &resource_handle::waste, src_res);
-    resource_handle dst(pool_impl, &resource_handle::waste, dst_res);
+    resource_handle src(pool_impl.get(), &resource_handle::waste, src_res);
+    resource_handle dst(pool_impl.get(), &resource_handle::waste, dst_res);
 
     EXPECT_CALL(*pool_impl, waste(dst_res)).WillOnce(Return());
     dst = std::move(src);
@@ -99,4 +99,76 @@ TEST(handle_test, move_to_usable_should_release_replaced_resource) {
     EXPECT_CALL(*pool_impl, waste(src_res)).WillOnce(Return());
 }
 
+struct static_pool_impl_mock {
+    using value_type = resource;
+    using list_iterator = ::list_iterator;
+
+    MOCK_METHOD1(recycle, void (list_iterator));
+    MOCK_METHOD1(waste, void (list_iterator));
+};
+
+using yamail::resource_pool::auto_recycle;
+using yamail::resource_pool::auto_waste;
+
+template <class Strategy>
+using static_resource_handle = yamail::resource_pool::static_handle<StrictMock<static_pool_impl_mock>, Strategy>;
+
+TEST(handle_test, static_handle_default_constructed_should_be_unusable) {
+    const static_resource_handle<auto_waste> handle;
+    EXPECT_TRUE(handle.unusable());
+    EXPECT_TRUE(handle.empty());
+}
+
+TEST(handle_test, static_handle_with_auto_waste_should_waste_on_destruction) {
+    std::list<idle> resources(1);
+    StrictMock<static_pool_impl_mock> pool_impl;
+    EXPECT_CALL(pool_impl, waste(resources.begin())).WillOnce(Return());
+    const static_resource_handle<auto_waste> handle(&pool_impl, resources.begin());
+    EXPECT_FALSE(handle.unusable());
+}
+
+TEST(handle_test, static_handle_with_auto_recycle_should_recycle_on_destruction) {
+    std::list<idle> resources(1);
+    StrictMock<static_pool_impl_mock> pool_impl;
+    EXPECT_CALL(pool_impl, recycle(resources.begin())).WillOnce(Return());
+    const static_resource_handle<auto_recycle> handle(&pool_impl, resources.begin());
+}
+
+TEST(handle_test, static_handle_explicit_waste_should_make_it_unusable) {
+    std::list<idle> resources(1);
+    StrictMock<static_pool_impl_mock> pool_impl;
+    EXPECT_CALL(pool_impl, waste(resources.begin())).WillOnce(Return());
+    static_resource_handle<auto_recycle> handle(&pool_impl, resources.begin());
+    handle.waste();
+    EXPECT_TRUE(handle.unusable());
+    EXPECT_THROW(handle.recycle(), yamail::resource_pool::error::unusable_handle);
+}
+
+TEST(handle_test, static_handle_reset_then_get_should_return_value) {
+    std::list<idle> resources(1);
+    StrictMock<static_pool_impl_mock> pool_impl;
+    EXPECT_CALL(pool_impl, recycle(resources.begin())).WillOnce(Return());
+    static_resource_handle<auto_recycle> handle(&pool_impl, resources.begin());
+    EXPECT_TRUE(handle.empty());
+    EXPECT_THROW(handle.get(), yamail::resource_pool::error::empty_handle);
+    handle.reset(resource(42));
+    EXPECT_EQ(handle->value, 42);
+}
+
+TEST(handle_test, static_handle_move_to_usable_should_release_replaced_resource) {
+    std::list<idle> resources(2);
+    StrictMock<static_pool_impl_mock> pool_impl;
+    const auto src_res = resources.begin();
+    const auto dst_res = std::next(resources.begin());
+    static_resource_handle<auto_waste> src(&pool_impl, src_res);
+    static_resource_handle<auto_waste> dst(&pool_impl, dst_res);
+
+    EXPECT_CALL(pool_impl, waste(dst_res)).WillOnce(Return());
+    dst = std::move(src);
+
+    EXPECT_TRUE(src.unusable());
+    EXPECT_FALSE(dst.unusable());
+    EXPECT_CALL(pool_impl, waste(src_res)).WillOnce(Return());
+}
+
 }
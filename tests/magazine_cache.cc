@@ -0,0 +1,99 @@
+#include <yamail/resource_pool/detail/magazine_cache.hpp>
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace testing;
+using namespace yamail::resource_pool::detail;
+
+using cache = magazine_cache<int*>;
+
+TEST(magazine_cache, create_should_make_given_number_of_magazines) {
+    EXPECT_EQ(cache(1, 3).magazines(), 3u);
+}
+
+TEST(magazine_cache, push_then_pop_in_same_thread_should_return_entry) {
+    int value = 0;
+    cache cells(4, 2);
+    EXPECT_TRUE(cells.push({&value, 1}));
+    EXPECT_EQ(cells.size(), 1u);
+    cache::entry entry;
+    ASSERT_TRUE(cells.pop(entry));
+    EXPECT_EQ(entry.cell, &value);
+    EXPECT_EQ(entry.generation, 1u);
+    EXPECT_EQ(cells.size(), 0u);
+}
+
+TEST(magazine_cache, pop_in_same_thread_should_return_last_pushed_entry) {
+    int values[3];
+    cache cells(4, 2);
+    for (auto& value : values) {
+        ASSERT_TRUE(cells.push({&value, 0}));
+    }
+    cache::entry entry;
+    ASSERT_TRUE(cells.pop(entry));
+    EXPECT_EQ(entry.cell, &values[2]);
+    ASSERT_TRUE(cells.pop(entry));
+    EXPECT_EQ(entry.cell, &values[1]);
+}
+
+TEST(magazine_cache, push_more_than_pool_capacity_in_same_thread_should_return_false) {
+    int values[3];
+    cache cells(2, 2);
+    EXPECT_TRUE(cells.push({&values[0], 0}));
+    EXPECT_TRUE(cells.push({&values[1], 0}));
+    EXPECT_FALSE(cells.push({&values[2], 0}));
+    EXPECT_EQ(cells.size(), 2u);
+}
+
+TEST(magazine_cache, pop_from_empty_cache_should_return_false) {
+    cache cells(4, 16);
+    cache::entry entry;
+    EXPECT_FALSE(cells.pop(entry));
+}
+
+TEST(magazine_cache, push_more_than_magazine_capacity_in_same_thread_should_return_false) {
+    std::vector<int> values(cache::magazine_capacity + 1);
+    cache cells(values.size(), 2);
+    for (std::size_t i = 0; i < cache::magazine_capacity; ++i) {
+        EXPECT_TRUE(cells.push({&values[i], 0}));
+    }
+    EXPECT_FALSE(cells.push({&values.back(), 0}));
+}
+
+TEST(magazine_cache, pop_should_take_entry_from_magazine_of_other_thread) {
+    int value = 0;
+    cache cells(4, 2);
+    std::thread([&] { EXPECT_TRUE(cells.push({&value, 0})); }).join();
+    EXPECT_EQ(cells.size(), 1u);
+    cache::entry entry;
+    ASSERT_TRUE(cells.pop(entry));
+    EXPECT_EQ(entry.cell, &value);
+}
+
+TEST(magazine_cache, filter_should_keep_satisfying_entries_and_consume_others) {
+    int values[3];
+    cache cells(4, 2);
+    for (auto& value : values) {
+        ASSERT_TRUE(cells.push({&value, 0}));
+    }
+    std::vector<int*> consumed;
+    cells.filter(
+        [&] (const cache::entry& entry) { return entry.cell != &values[1]; },
+        [&] (const cache::entry& entry) { consumed.push_back(entry.cell); }
+    );
+    EXPECT_EQ(consumed, std::vector<int*>({&values[1]}));
+    EXPECT_EQ(cells.size(), 2u);
+    cache::entry entry;
+    ASSERT_TRUE(cells.pop(entry));
+    EXPECT_EQ(entry.cell, &values[2]);
+    ASSERT_TRUE(cells.pop(entry));
+    EXPECT_EQ(entry.cell, &values[0]);
+    EXPECT_FALSE(cells.pop(entry));
+}
+
+}
@@ -0,0 +1,259 @@
+#include <yamail/resource_pool/detail/storage.hpp>
+#include <yamail/resource_pool/detail/slab_storage.hpp>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+using namespace testing;
+using namespace yamail::resource_pool;
+
+struct resource {
+    int value = 0;
+
+    resource(int value = 0) : value(value) {}
+    resource(const resource&) = delete;
+    resource(resource&&) = default;
+    resource& operator =(const resource&) = delete;
+    resource& operator =(resource&&) = default;
+};
+
+template <class Storage>
+struct storage_test : Test {};
+
+using storages = Types<
+    detail::storage<resource>,
+    detail::slab_storage<resource>
+>;
+
+TYPED_TEST_SUITE(storage_test, storages);
+
+TYPED_TEST(storage_test, create_with_capacity_should_have_only_wasted_cells) {
+    const TypeParam storage(3, time_traits::duration::max(), time_traits::duration::max());
+    const auto stats = storage.stats();
+    EXPECT_EQ(stats.available, 0u);
+    EXPECT_EQ(stats.used, 0u);
+    EXPECT_EQ(stats.wasted, 3u);
+}
+
+TYPED_TEST(storage_test, create_with_generator_should_have_only_available_cells) {
+    int n = 0;
+    const TypeParam storage([&] { return resource(n++); }, 3, time_traits::duration::max(), time_traits::duration::max());
+    const auto stats = storage.stats();
+    EXPECT_EQ(stats.available, 3u);
+    EXPECT_EQ(stats.used, 0u);
+    EXPECT_EQ(stats.wasted, 0u);
+}
+
+TYPED_TEST(storage_test, create_with_range_should_have_only_available_cells) {
+    std::vector<resource> values;
+    values.emplace_back(1);
+    values.emplace_back(2);
+    const TypeParam storage(std::make_move_iterator(values.begin()), std::make_move_iterator(values.end()),
+                            time_traits::duration::max(), time_traits::duration::max());
+    const auto stats = storage.stats();
+    EXPECT_EQ(stats.available, 2u);
+    EXPECT_EQ(stats.used, 0u);
+    EXPECT_EQ(stats.wasted, 0u);
+}
+
+TYPED_TEST(storage_test, lease_more_than_capacity_should_return_none) {
+    TypeParam storage(2, time_traits::duration::max(), time_traits::duration::max());
+    std::vector<resource> dropped;
+    EXPECT_TRUE(storage.lease(dropped));
+    EXPECT_TRUE(storage.lease(dropped));
+    EXPECT_FALSE(storage.lease(dropped));
+    EXPECT_EQ(storage.stats().used, 2u);
+}
+
+TYPED_TEST(storage_test, lease_should_return_available_cells_in_recycle_order) {
+    TypeParam storage(2, time_traits::duration::max(), time_traits::duration::max());
+    std::vector<resource> dropped;
+    const auto first = *storage.lease(dropped);
+    const auto second = *storage.lease(dropped);
+    first->value = resource(1);
+    first->reset_time = time_traits::now();
+    second->value = resource(2);
+    second->reset_time = time_traits::now();
+    storage.recycle(second, dropped);
+    storage.recycle(first, dropped);
+    EXPECT_EQ(storage.stats().available, 2u);
+    EXPECT_EQ((*storage.lease(dropped))->value->value, 2);
+    EXPECT_EQ((*storage.lease(dropped))->value->value, 1);
+}
+
+TYPED_TEST(storage_test, lease_wasted_should_skip_available_cells) {
+    TypeParam storage(2, time_traits::duration::max(), time_traits::duration::max());
+    std::vector<resource> dropped;
+    const auto first = *storage.lease(dropped);
+    first->value = resource(1);
+    first->reset_time = time_traits::now();
+    storage.recycle(first, dropped);
+    const auto empty = storage.lease_wasted();
+    ASSERT_TRUE(empty);
+    EXPECT_FALSE((*empty)->value);
+    EXPECT_FALSE(storage.lease_wasted());
+    EXPECT_EQ(storage.stats().available, 1u);
+    EXPECT_EQ(storage.stats().used, 1u);
+}
+
+TYPED_TEST(storage_test, waste_should_reset_value_and_make_cell_wasted) {
+    TypeParam storage([] { return resource(42); }, 1, time_traits::duration::max(), time_traits::duration::max());
+    std::vector<resource> dropped;
+    const auto cell = *storage.lease(dropped);
+    EXPECT_TRUE(cell->value);
+    storage.waste(cell, dropped);
+    EXPECT_FALSE(cell->value);
+    ASSERT_EQ(dropped.size(), 1u);
+    EXPECT_EQ(dropped.front().value, 42);
+    EXPECT_EQ(storage.stats().wasted, 1u);
+    EXPECT_EQ(storage.stats().used, 0u);
+}
+
+TYPED_TEST(storage_test, lease_should_drop_expired_available_cells) {
+    TypeParam storage([] { return resource(42); }, 2, time_traits::duration(0), time_traits::duration::max());
+    std::vector<resource> dropped;
+    const auto cell = storage.lease(dropped);
+    ASSERT_TRUE(cell);
+    EXPECT_FALSE((*cell)->value);
+    EXPECT_EQ(dropped.size(), 2u);
+    const auto stats = storage.stats();
+    EXPECT_EQ(stats.available, 0u);
+    EXPECT_EQ(stats.used, 1u);
+    EXPECT_EQ(stats.wasted, 1u);
+}
+
+TYPED_TEST(storage_test, recycle_after_lifespan_should_waste_cell) {
+    TypeParam storage(1, time_traits::duration::max(), time_traits::duration(0));
+    std::vector<resource> dropped;
+    const auto cell = *storage.lease(dropped);
+    cell->value = resource(42);
+    cell->reset_time = time_traits::now();
+    storage.recycle(cell, dropped);
+    EXPECT_FALSE(cell->value);
+    EXPECT_EQ(storage.stats().wasted, 1u);
+}
+
+TYPED_TEST(storage_test, invalidate_should_waste_available_and_mark_used_cells) {
+    TypeParam storage([] { return resource(42); }, 2, time_traits::duration::max(), time_traits::duration::max());
+    std::vector<resource> dropped;
+    const auto used = *storage.lease(dropped);
+    storage.invalidate(dropped);
+    EXPECT_EQ(dropped.size(), 1u);
+    EXPECT_EQ(storage.stats().available, 0u);
+    EXPECT_EQ(storage.stats().wasted, 1u);
+    EXPECT_FALSE(storage.is_valid(used));
+    storage.recycle(used, dropped);
+    EXPECT_FALSE(used->value);
+    EXPECT_EQ(dropped.size(), 2u);
+    EXPECT_EQ(storage.stats().wasted, 2u);
+}
+
+TYPED_TEST(storage_test, lease_wasted_cell_should_make_it_valid_again) {
+    TypeParam storage(1, time_traits::duration::max(), time_traits::duration::max());
+    std::vector<resource> dropped;
+    const auto first = *storage.lease(dropped);
+    storage.invalidate(dropped);
+    storage.recycle(first, dropped);
+    const auto second = *storage.lease(dropped);
+    second->value = resource(42);
+    second->reset_time = time_traits::now();
+    EXPECT_TRUE(storage.is_valid(second));
+}
+
+TYPED_TEST(storage_test, lease_with_lifo_order_should_return_most_recently_recycled_cell) {
+    TypeParam storage(2, time_traits::duration::max(), time_traits::duration::max(), lease_order::lifo);
+    std::vector<resource> dropped;
+    const auto first = *storage.lease(dropped);
+    const auto second = *storage.lease(dropped);
+    first->value = resource(1);
+    first->reset_time = time_traits::now();
+    second->value = resource(2);
+    second->reset_time = time_traits::now();
+    storage.recycle(second, dropped);
+    storage.recycle(first, dropped);
+    EXPECT_EQ((*storage.lease(dropped))->value->value, 1);
+    EXPECT_EQ((*storage.lease(dropped))->value->value, 2);
+}
+
+TYPED_TEST(storage_test, lease_with_youngest_order_should_return_most_recently_reset_cell) {
+    TypeParam storage(3, time_traits::duration::max(), time_traits::duration::max(), lease_order::youngest);
+    std::vector<resource> dropped;
+    const auto first = *storage.lease(dropped);
+    const auto second = *storage.lease(dropped);
+    const auto third = *storage.lease(dropped);
+    const auto now = time_traits::now();
+    first->value = resource(1);
+    first->reset_time = now - std::chrono::seconds(2);
+    second->value = resource(2);
+    second->reset_time = now;
+    third->value = resource(3);
+    third->reset_time = now - std::chrono::seconds(1);
+    storage.recycle(first, dropped);
+    storage.recycle(second, dropped);
+    storage.recycle(third, dropped);
+    EXPECT_EQ((*storage.lease(dropped))->value->value, 2);
+    EXPECT_EQ((*storage.lease(dropped))->value->value, 3);
+    EXPECT_EQ((*storage.lease(dropped))->value->value, 1);
+}
+
+TYPED_TEST(storage_test, lease_with_youngest_order_should_keep_order_for_cells_recycled_in_any_order) {
+    const int capacity = 1000;
+    TypeParam storage(capacity, time_traits::duration::max(), time_traits::duration::max(), lease_order::youngest);
+    std::vector<resource> dropped;
+    std::vector<typename TypeParam::cell_iterator> cells;
+    const auto now = time_traits::now();
+    for (int i = 0; i < capacity; ++i) {
+        const auto cell = *storage.lease(dropped);
+        cell->value = resource(i);
+        cell->reset_time = now - std::chrono::seconds((i * 7919) % capacity);
+        cells.push_back(cell);
+    }
+    for (const auto cell : cells) {
+        storage.recycle(cell, dropped);
+    }
+    const auto youngest = *storage.lease(dropped);
+    storage.recycle(youngest, dropped);
+    for (int i = 0; i < capacity; ++i) {
+        const auto cell = *storage.lease(dropped);
+        EXPECT_EQ(cell->reset_time, now - std::chrono::seconds(i)) << i;
+    }
+}
+
+TYPED_TEST(storage_test, lease_with_lifo_order_should_drop_expired_least_recently_recycled_cells) {
+    TypeParam storage([] { return resource(42); }, 2, time_traits::duration(0), time_traits::duration::max(),
+                      lease_order::lifo);
+    std::vector<resource> dropped;
+    const auto cell = storage.lease(dropped);
+    ASSERT_TRUE(cell);
+    EXPECT_FALSE((*cell)->value);
+    EXPECT_EQ(storage.stats().available, 0u);
+    EXPECT_EQ(storage.stats().wasted, 1u);
+}
+
+TYPED_TEST(storage_test, drop_expired_should_move_out_expired_values_and_waste_cells) {
+    TypeParam storage(3, time_traits::duration(0), time_traits::duration::max());
+    std::vector<resource> dropped;
+    const auto first = *storage.lease(dropped);
+    const auto second = *storage.lease(dropped);
+    first->value = resource(1);
+    first->reset_time = time_traits::now();
+    storage.recycle(first, dropped);
+    storage.recycle(second, dropped);
+    storage.drop_expired(dropped);
+    ASSERT_EQ(dropped.size(), 1u);
+    EXPECT_EQ(dropped.front().value, 1);
+    EXPECT_FALSE(first->value);
+    EXPECT_EQ(storage.stats().available, 0u);
+    EXPECT_EQ(storage.stats().wasted, 3u);
+}
+
+TYPED_TEST(storage_test, drop_expired_should_keep_not_expired_cells) {
+    TypeParam storage([] { return resource(42); }, 2, time_traits::duration::max(), time_traits::duration::max());
+    std::vector<resource> dropped;
+    storage.drop_expired(dropped);
+    EXPECT_TRUE(dropped.empty());
+    EXPECT_EQ(storage.stats().available, 2u);
+}
+
+}
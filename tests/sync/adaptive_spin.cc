@@ -0,0 +1,52 @@
+#include <yamail/resource_pool/sync/detail/adaptive_spin.hpp>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+using namespace testing;
+using namespace yamail::resource_pool::sync::detail;
+
+TEST(adaptive_spin, create_should_start_from_min_spins) {
+    EXPECT_EQ(adaptive_spin().limit(), adaptive_spin::min_spins);
+}
+
+TEST(adaptive_spin, spin_should_return_true_when_ready_within_limit) {
+    adaptive_spin spin;
+    std::size_t calls = 0;
+    EXPECT_TRUE(spin.spin([&] { return ++calls == 3; }));
+    EXPECT_EQ(calls, 3u);
+}
+
+TEST(adaptive_spin, spin_should_return_false_when_not_ready_within_limit) {
+    adaptive_spin spin;
+    std::size_t calls = 0;
+    EXPECT_FALSE(spin.spin([&] { ++calls; return false; }));
+    EXPECT_EQ(calls, adaptive_spin::min_spins);
+    EXPECT_EQ(spin.limit(), adaptive_spin::min_spins);
+}
+
+TEST(adaptive_spin, spin_ready_at_the_end_of_limit_should_grow_limit_up_to_max) {
+    constexpr std::size_t max_spins = 64;
+    adaptive_spin spin(max_spins);
+    for (std::size_t i = 0; i < 100; ++i) {
+        std::size_t calls = 0;
+        const auto limit = spin.limit();
+        EXPECT_TRUE(spin.spin([&] { return ++calls == limit; }));
+    }
+    EXPECT_EQ(spin.limit(), max_spins);
+}
+
+TEST(adaptive_spin, spin_not_ready_should_shrink_limit) {
+    adaptive_spin spin(64);
+    for (std::size_t i = 0; i < 100; ++i) {
+        std::size_t calls = 0;
+        const auto limit = spin.limit();
+        spin.spin([&] { return ++calls == limit; });
+    }
+    const auto grown = spin.limit();
+    spin.spin([] { return false; });
+    EXPECT_LT(spin.limit(), grown);
+}
+
+}
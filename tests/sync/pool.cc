@@ -1,8 +1,13 @@
 #include <yamail/resource_pool/sync/pool.hpp>
+#include <yamail/resource_pool/detail/slab_storage.hpp>
 
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include <atomic>
+#include <thread>
+#include <vector>
+
 namespace {
 
 using namespace testing;
@@ -51,6 +56,21 @@ TEST_F(sync_resource_pool, create_without_mocks_should_succeed) {
     pool<resource>(1);
 }
 
+TEST_F(sync_resource_pool, get_auto_recycle_from_pool_with_slab_storage_should_return_recycled_resource) {
+    using slab_storage = yamail::resource_pool::detail::slab_storage<resource>;
+    using slab_pool_impl = sync::detail::pool_impl<resource, std::mutex, std::condition_variable, slab_storage>;
+    pool<resource, std::mutex, slab_pool_impl> pool(1);
+    {
+        auto res = pool.get_auto_recycle();
+        EXPECT_FALSE(res.first);
+        res.second.reset(resource {});
+    }
+    EXPECT_EQ(pool.available(), 1u);
+    const auto res = pool.get_auto_recycle();
+    EXPECT_FALSE(res.first);
+    EXPECT_FALSE(res.second.empty());
+}
+
 TEST_F(sync_resource_pool, call_capacity_should_call_impl_capacity) {
     const auto pool_impl = std::make_shared<StrictMock<mocked_pool_impl>>();
     const resource_pool pool(pool_impl);
@@ -105,7 +125,7 @@ TEST_F(sync_resource_pool, call_stats_should_call_impl_stats) {
 
     InSequence s;
 
-    EXPECT_CALL(*pool_impl, stats()).WillOnce(Return(sync::stats {0, 0, 0}));
+    EXPECT_CALL(*pool_impl, stats()).WillOnce(Return(sync::stats {0, 0, 0, 0}));
     EXPECT_CALL(*pool_impl, disable()).WillOnce(Return());
 
     pool.stats();
@@ -228,4 +248,201 @@ TEST_F(sync_resource_pool, get_auto_waste_handle_and_waste_should_call_waste_onc
     handle.waste();
 }
 
+TEST_F(sync_resource_pool, get_auto_recycle_from_magazine_pool_in_several_threads_should_succeed) {
+    constexpr std::size_t threads_count = 4;
+    constexpr std::size_t iterations = 1000;
+    pool<resource, std::mutex, magazine_pool_impl<resource>::type> pool(2);
+    std::atomic<std::size_t> succeed {0};
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < threads_count; ++i) {
+        threads.emplace_back([&] {
+            for (std::size_t n = 0; n < iterations; ++n) {
+                auto res = pool.get_auto_recycle(std::chrono::seconds(10));
+                if (res.first) {
+                    continue;
+                }
+                if (res.second.empty()) {
+                    res.second.reset(resource {});
+                }
+                ++succeed;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(succeed.load(), threads_count * iterations);
+    EXPECT_EQ(pool.available(), pool.size());
+    EXPECT_EQ(pool.used(), 0u);
+}
+
+TEST_F(sync_resource_pool, pool_impl_should_be_destroyed_after_last_handle_returns_to_destroyed_pool) {
+    using impl_type = sync::detail::pool_impl<resource, std::mutex, std::condition_variable>;
+    auto impl = std::make_shared<impl_type>(1, time_traits::duration::max(), time_traits::duration::max());
+    const std::weak_ptr<impl_type> weak_impl(impl);
+    boost::optional<pool<resource, std::mutex, impl_type>::handle> handle;
+    {
+        pool<resource, std::mutex, impl_type> pool(std::move(impl));
+        auto res = pool.get_auto_recycle();
+        ASSERT_FALSE(res.first);
+        res.second.reset(resource {});
+        handle = std::move(res.second);
+    }
+    EXPECT_FALSE(weak_impl.expired());
+    handle->recycle();
+    EXPECT_TRUE(weak_impl.expired());
+}
+
+TEST_F(sync_resource_pool, pool_impl_should_be_destroyed_after_last_handle_returns_to_move_assigned_pool) {
+    using impl_type = sync::detail::pool_impl<resource, std::mutex, std::condition_variable>;
+    auto impl = std::make_shared<impl_type>(1, time_traits::duration::max(), time_traits::duration::max());
+    const std::weak_ptr<impl_type> weak_impl(impl);
+    pool<resource, std::mutex, impl_type> pool(std::move(impl));
+    auto res = pool.get_auto_recycle();
+    ASSERT_FALSE(res.first);
+    pool = sync::pool<resource, std::mutex, impl_type>(2);
+    EXPECT_FALSE(weak_impl.expired());
+    res.second.reset(resource {});
+    res.second.recycle();
+    EXPECT_TRUE(weak_impl.expired());
+    EXPECT_EQ(pool.capacity(), 2u);
+    EXPECT_EQ(pool.used(), 0u);
+}
+
+TEST_F(sync_resource_pool, get_static_handle_with_auto_recycle_should_return_resource_to_pool) {
+    pool<resource> pool(1);
+    {
+        auto res = pool.get<auto_recycle>();
+        ASSERT_FALSE(res.first);
+        res.second.reset(resource {});
+    }
+    EXPECT_EQ(pool.available(), 1u);
+    {
+        const auto res = pool.get<auto_waste>();
+        ASSERT_FALSE(res.first);
+        EXPECT_FALSE(res.second.empty());
+    }
+    EXPECT_EQ(pool.available(), 0u);
+    EXPECT_EQ(pool.size(), 0u);
+}
+
+TEST_F(sync_resource_pool, get_many_should_return_handles_for_all_resources) {
+    pool<resource> pool(3);
+    {
+        auto res = pool.get_many_auto_recycle(3);
+        ASSERT_FALSE(res.first);
+        ASSERT_EQ(res.second.size(), 3u);
+        for (auto& handle : res.second) {
+            ASSERT_FALSE(handle.unusable());
+            handle.reset(resource {});
+        }
+        EXPECT_EQ(pool.used(), 3u);
+    }
+    EXPECT_EQ(pool.available(), 3u);
+}
+
+TEST_F(sync_resource_pool, get_many_more_than_capacity_should_return_error) {
+    pool<resource> pool(2);
+    const auto res = pool.get_many_auto_recycle(3, time_traits::duration::max());
+    EXPECT_EQ(res.first, boost::system::error_code(error::batch_exceeds_capacity));
+    EXPECT_TRUE(res.second.empty());
+}
+
+TEST_F(sync_resource_pool, get_many_without_enough_resources_should_return_timeout_error_and_lease_nothing) {
+    pool<resource> pool(2);
+    const auto handle = pool.get_auto_recycle();
+    const auto res = pool.get_many_auto_recycle(2, std::chrono::milliseconds(1));
+    EXPECT_EQ(res.first, boost::system::error_code(error::get_resource_timeout));
+    EXPECT_TRUE(res.second.empty());
+    EXPECT_EQ(pool.used(), 1u);
+}
+
+TEST_F(sync_resource_pool, get_many_in_partial_mode_should_return_available_resources) {
+    pool<resource> pool(3);
+    const auto handle = pool.get_auto_recycle();
+    const auto res = pool.get_many_auto_waste(3, time_traits::duration(0), batch_mode::partial);
+    EXPECT_FALSE(res.first);
+    EXPECT_EQ(res.second.size(), 2u);
+    EXPECT_EQ(pool.used(), 3u);
+}
+
+TEST_F(sync_resource_pool, get_many_should_wait_until_all_resources_are_returned) {
+    pool<resource, std::mutex, magazine_pool_impl<resource>::type> pool(2);
+    auto res = pool.get_many_auto_recycle(2);
+    ASSERT_FALSE(res.first);
+    for (auto& handle : res.second) {
+        handle.reset(resource {});
+    }
+    std::thread thread([&] {
+        for (auto& handle : res.second) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            handle.recycle();
+        }
+    });
+    const auto batch = pool.get_many_auto_recycle(2, std::chrono::seconds(10));
+    thread.join();
+    EXPECT_FALSE(batch.first);
+    ASSERT_EQ(batch.second.size(), 2u);
+    EXPECT_FALSE(batch.second[0].empty());
+    EXPECT_FALSE(batch.second[1].empty());
+}
+
+TEST_F(sync_resource_pool, queued_get_many_should_be_served_before_later_get) {
+    sync::pool<resource> pool(2);
+    auto first = pool.get_auto_recycle();
+    ASSERT_FALSE(first.first);
+    std::atomic<bool> batch_done {false};
+    std::thread batch([&] {
+        const auto res = pool.get_many_auto_recycle(2, std::chrono::seconds(10));
+        EXPECT_FALSE(res.first);
+        batch_done = true;
+    });
+    while (pool.stats().queue_size == 0) {
+        std::this_thread::yield();
+    }
+    EXPECT_EQ(pool.get_auto_recycle(std::chrono::milliseconds(1)).first, make_error_code(error::get_resource_timeout));
+    EXPECT_FALSE(batch_done);
+    first.second.recycle();
+    batch.join();
+    EXPECT_TRUE(batch_done);
+}
+
+TEST_F(sync_resource_pool, recycle_all_should_return_resources_of_all_handles_to_pool) {
+    pool<resource> pool(2);
+    auto res = pool.get_many_auto_waste(2);
+    ASSERT_FALSE(res.first);
+    for (auto& handle : res.second) {
+        handle.reset(resource {});
+    }
+    pool.recycle_all(res.second);
+    EXPECT_TRUE(res.second[0].unusable());
+    EXPECT_TRUE(res.second[1].unusable());
+    EXPECT_EQ(pool.available(), 2u);
+    EXPECT_EQ(pool.used(), 0u);
+}
+
+TEST_F(sync_resource_pool, waste_all_should_drop_resources_of_all_handles) {
+    pool<resource, std::mutex, magazine_pool_impl<resource>::type> pool(2);
+    auto res = pool.get_many_auto_recycle(2);
+    ASSERT_FALSE(res.first);
+    for (auto& handle : res.second) {
+        handle.reset(resource {});
+    }
+    pool.waste_all(res.second);
+    EXPECT_EQ(pool.size(), 0u);
+}
+
+TEST_F(sync_resource_pool, recycle_all_should_accept_static_handles) {
+    pool<resource> pool(2);
+    std::vector<decltype(pool)::static_handle<auto_waste>> handles;
+    for (std::size_t i = 0; i < 2; ++i) {
+        auto res = pool.get<auto_waste>();
+        ASSERT_FALSE(res.first);
+        res.second.reset(resource {});
+        handles.push_back(std::move(res.second));
+    }
+    pool.recycle_all(handles);
+    EXPECT_EQ(pool.available(), 2u);
+}
+
 }
@@ -1,8 +1,12 @@
 #include <yamail/resource_pool/sync/detail/pool_impl.hpp>
+#include <yamail/resource_pool/detail/magazine_cache.hpp>
 
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include <condition_variable>
+#include <thread>
+
 namespace {
 
 using namespace testing;
@@ -13,84 +17,101 @@ using std::make_shared;
 
 struct resource {};
 
-struct mocked_condition_variable {
+struct condition_variable_mock {
     MOCK_CONST_METHOD0(notify_one, void ());
-    MOCK_CONST_METHOD0(notify_all, void ());
     MOCK_CONST_METHOD2(wait_for, std::cv_status (std::unique_lock<std::mutex>&, time_traits::duration));
 };
 
+// Each waiter has own condition variable, all of them forward calls to the mock
+// of current test.
+struct mocked_condition_variable {
+    static inline const condition_variable_mock* mock = nullptr;
+
+    void notify_one() { mock->notify_one(); }
+
+    std::cv_status wait_for(std::unique_lock<std::mutex>& lock, time_traits::duration duration) {
+        return mock->wait_for(lock, duration);
+    }
+};
+
 using resource_pool_impl = pool_impl<resource, std::mutex, mocked_condition_variable>;
 using get_result = resource_pool_impl::get_result;
 using resource_ptr_list_iterator = resource_pool_impl::list_iterator;
 
-struct sync_resource_pool_impl : Test {};
+struct sync_resource_pool_impl : Test {
+    condition_variable_mock has_capacity;
+
+    sync_resource_pool_impl() { mocked_condition_variable::mock = &has_capacity; }
+    ~sync_resource_pool_impl() { mocked_condition_variable::mock = nullptr; }
+};
 
-TEST(sync_resource_pool_impl, create_with_zero_capacity_should_throw_exception) {
+TEST_F(sync_resource_pool_impl, create_with_zero_capacity_should_throw_exception) {
     EXPECT_THROW(resource_pool_impl(0, time_traits::duration::max(), time_traits::duration::max()), error::zero_pool_capacity);
 }
 
-TEST(sync_resource_pool_impl, create_with_non_zero_capacity_then_check) {
+TEST_F(sync_resource_pool_impl, create_with_non_zero_capacity_then_check) {
     const resource_pool_impl pool(1, time_traits::duration::max(), time_traits::duration::max());
     EXPECT_EQ(pool.capacity(), 1u);
 }
 
-TEST(sync_resource_pool_impl, create_then_check_size_should_be_0) {
+TEST_F(sync_resource_pool_impl, create_then_check_size_should_be_0) {
     const resource_pool_impl pool(1, time_traits::duration::max(), time_traits::duration::max());
     EXPECT_EQ(pool.size(), 0u);
 }
 
-TEST(sync_resource_pool_impl, create_then_check_available_should_be_0) {
+TEST_F(sync_resource_pool_impl, create_then_check_available_should_be_0) {
     const resource_pool_impl pool(1, time_traits::duration::max(), time_traits::duration::max());
     EXPECT_EQ(pool.available(), 0u);
 }
 
-TEST(sync_resource_pool_impl, create_then_check_used_should_be_0) {
+TEST_F(sync_resource_pool_impl, create_then_check_used_should_be_0) {
     const resource_pool_impl pool(1, time_traits::duration::max(), time_traits::duration::max());
     EXPECT_EQ(pool.used(), 0u);
 }
 
-TEST(sync_resource_pool_impl, create_const_then_check_stats_should_be_0_0_0) {
+TEST_F(sync_resource_pool_impl, create_const_then_check_stats_should_be_0_0_0) {
     const resource_pool_impl pool(1, time_traits::duration::max(), time_traits::duration::max());
-    const sync::stats expected {0, 0, 0};
+    const sync::stats expected {0, 0, 0, 0};
     const auto actual = pool.stats();
 
     EXPECT_EQ(actual.size, expected.size);
     EXPECT_EQ(actual.available, expected.available);
     EXPECT_EQ(actual.used, expected.used);
+    EXPECT_EQ(actual.queue_size, expected.queue_size);
 }
 
-TEST(sync_resource_pool_impl, get_one_should_succeed) {
+TEST_F(sync_resource_pool_impl, get_one_should_succeed) {
     resource_pool_impl pool_impl(1, time_traits::duration::max(), time_traits::duration::max());
     const get_result res = pool_impl.get();
     EXPECT_EQ(res.first, boost::system::error_code());
 }
 
-TEST(sync_resource_pool_impl, get_one_and_recycle_should_succeed) {
+TEST_F(sync_resource_pool_impl, get_one_and_recycle_should_succeed) {
     resource_pool_impl pool_impl(1, time_traits::duration::max(), time_traits::duration::max());
     const get_result res = pool_impl.get();
     EXPECT_EQ(res.first, boost::system::error_code());
-    EXPECT_CALL(pool_impl.has_capacity(), notify_one()).WillOnce(Return());
+    EXPECT_CALL(has_capacity, notify_one()).Times(0);
     pool_impl.recycle(res.second);
 }
 
-TEST(sync_resource_pool_impl, get_one_and_waste_should_succeed) {
+TEST_F(sync_resource_pool_impl, get_one_and_waste_should_succeed) {
     resource_pool_impl pool_impl(1, time_traits::duration::max(), time_traits::duration::max());
     const get_result res = pool_impl.get();
     EXPECT_EQ(res.first, boost::system::error_code());
-    EXPECT_CALL(pool_impl.has_capacity(), notify_one()).WillOnce(Return());
+    EXPECT_CALL(has_capacity, notify_one()).Times(0);
     pool_impl.waste(res.second);
 }
 
-TEST(sync_resource_pool_impl, get_more_than_capacity_returns_error) {
+TEST_F(sync_resource_pool_impl, get_more_than_capacity_returns_error) {
     resource_pool_impl pool_impl(1, time_traits::duration::max(), time_traits::duration::max());
     pool_impl.get();
-    EXPECT_CALL(pool_impl.has_capacity(), wait_for(_, _)).WillOnce(Return(std::cv_status::timeout));
+    EXPECT_CALL(has_capacity, wait_for(_, _)).WillOnce(Return(std::cv_status::timeout));
     EXPECT_EQ(pool_impl.get().first, make_error_code(error::get_resource_timeout));
 }
 
-TEST(sync_resource_pool_impl, get_after_disable_capacity_returns_error) {
+TEST_F(sync_resource_pool_impl, get_after_disable_capacity_returns_error) {
     resource_pool_impl pool_impl(1, time_traits::duration::max(), time_traits::duration::max());
-    EXPECT_CALL(pool_impl.has_capacity(), notify_all()).WillOnce(Return());
+    EXPECT_CALL(has_capacity, notify_one()).Times(0);
     pool_impl.disable();
     EXPECT_EQ(pool_impl.get().first, make_error_code(error::disabled));
 }
@@ -118,7 +139,7 @@ struct recycle_resource : handle_resource {
         : handle_resource(pool, res_it, &resource_pool_impl::recycle) {}
 };
 
-TEST(sync_resource_pool_impl, get_from_pool_and_wait_then_after_recycle_should_allocate) {
+TEST_F(sync_resource_pool_impl, get_from_pool_and_wait_then_after_recycle_should_allocate) {
     resource_pool_impl pool(1, time_traits::duration::max(), time_traits::duration::max());
     const get_result& first_res = pool.get();
 
@@ -128,8 +149,8 @@ TEST(sync_resource_pool_impl, get_from_pool_and_wait_then_after_recycle_should_a
 
     InSequence s;
 
-    EXPECT_CALL(pool.has_capacity(), wait_for(_, _)).WillOnce(Invoke(recycle_resource(pool, first_res.second)));
-    EXPECT_CALL(pool.has_capacity(), notify_one()).WillOnce(Return());
+    EXPECT_CALL(has_capacity, wait_for(_, _)).WillOnce(Invoke(recycle_resource(pool, first_res.second)));
+    EXPECT_CALL(has_capacity, notify_one()).WillOnce(Return());
 
     const get_result& second_res = pool.get();
 
@@ -137,12 +158,46 @@ TEST(sync_resource_pool_impl, get_from_pool_and_wait_then_after_recycle_should_a
     EXPECT_EQ(second_res.second, first_res.second);
 }
 
+struct recycle_resource_and_get : recycle_resource {
+    get_result& barging;
+
+    recycle_resource_and_get(resource_pool_impl& pool, resource_ptr_list_iterator res_it, get_result& barging)
+        : recycle_resource(pool, res_it), barging(barging) {}
+
+    std::cv_status operator ()(std::unique_lock<std::mutex>& lock, time_traits::duration duration) const {
+        lock.unlock();
+        pool.recycle(res_it);
+        barging = pool.get(duration);
+        lock.lock();
+        return std::cv_status::no_timeout;
+    }
+};
+
+TEST_F(sync_resource_pool_impl, recycle_should_hand_cell_to_waiter_before_new_get) {
+    resource_pool_impl pool(1, time_traits::duration::max(), time_traits::duration::max());
+    const get_result first_res = pool.get();
+    ASSERT_FALSE(first_res.first);
+    get_result barging;
+
+    InSequence s;
+
+    EXPECT_CALL(has_capacity, wait_for(_, _)).WillOnce(Invoke(recycle_resource_and_get(pool, first_res.second, barging)));
+    EXPECT_CALL(has_capacity, notify_one()).WillOnce(Return());
+    EXPECT_CALL(has_capacity, wait_for(_, _)).WillOnce(Return(std::cv_status::timeout));
+
+    const get_result second_res = pool.get(time_traits::duration::max());
+
+    EXPECT_FALSE(second_res.first);
+    EXPECT_EQ(second_res.second, first_res.second);
+    EXPECT_EQ(barging.first, make_error_code(error::get_resource_timeout));
+}
+
 struct waste_resource : handle_resource {
     waste_resource(resource_pool_impl& pool, resource_ptr_list_iterator res_it)
         : handle_resource(pool, res_it, &resource_pool_impl::waste) {}
 };
 
-TEST(sync_resource_pool_impl, get_from_pool_and_wait_then_after_waste_should_reserve) {
+TEST_F(sync_resource_pool_impl, get_from_pool_and_wait_then_after_waste_should_reserve) {
     resource_pool_impl pool(1, time_traits::duration::max(), time_traits::duration::max());
     const get_result& first_res = pool.get();
 
@@ -150,8 +205,8 @@ TEST(sync_resource_pool_impl, get_from_pool_and_wait_then_after_waste_should_res
 
     InSequence s;
 
-    EXPECT_CALL(pool.has_capacity(), wait_for(_, _)).WillOnce(Invoke(waste_resource(pool, first_res.second)));
-    EXPECT_CALL(pool.has_capacity(), notify_one()).WillOnce(Return());
+    EXPECT_CALL(has_capacity, wait_for(_, _)).WillOnce(Invoke(waste_resource(pool, first_res.second)));
+    EXPECT_CALL(has_capacity, notify_one()).WillOnce(Return());
 
     const get_result& second_res = pool.get();
 
@@ -171,7 +226,7 @@ struct disable_pool {
     }
 };
 
-TEST(sync_resource_pool_impl, get_from_pool_with_zero_capacity_then_disable_should_return_error) {
+TEST_F(sync_resource_pool_impl, get_from_pool_with_zero_capacity_then_disable_should_return_error) {
     resource_pool_impl pool(1, time_traits::duration::max(), time_traits::duration::max());
     const get_result& first = pool.get();
 
@@ -179,18 +234,18 @@ TEST(sync_resource_pool_impl, get_from_pool_with_zero_capacity_then_disable_shou
 
     InSequence s;
 
-    EXPECT_CALL(pool.has_capacity(), wait_for(_, _)).WillOnce(Invoke(disable_pool(pool)));
-    EXPECT_CALL(pool.has_capacity(), notify_all()).WillOnce(Return());
+    EXPECT_CALL(has_capacity, wait_for(_, _)).WillOnce(Invoke(disable_pool(pool)));
+    EXPECT_CALL(has_capacity, notify_one()).WillOnce(Return());
 
     const get_result& result = pool.get();
 
     EXPECT_EQ(result.first, make_error_code(error::disabled));
 }
 
-TEST(sync_resource_pool_impl, get_one_set_and_recycle_with_zero_idle_timeout_then_get_should_return_empty) {
+TEST_F(sync_resource_pool_impl, get_one_set_and_recycle_with_zero_idle_timeout_then_get_should_return_empty) {
     resource_pool_impl pool_impl(1, time_traits::duration(0), time_traits::duration::max());
 
-    EXPECT_CALL(pool_impl.has_capacity(), notify_one()).WillOnce(Return());
+    EXPECT_CALL(has_capacity, notify_one()).Times(0);
 
     const get_result first_res = pool_impl.get();
     EXPECT_EQ(first_res.first, boost::system::error_code());
@@ -206,10 +261,10 @@ TEST(sync_resource_pool_impl, get_one_set_and_recycle_with_zero_idle_timeout_the
     EXPECT_FALSE(second_res.second->value);
 }
 
-TEST(sync_resource_pool_impl, should_waste_resource_when_lifespan_ends) {
+TEST_F(sync_resource_pool_impl, should_waste_resource_when_lifespan_ends) {
     resource_pool_impl pool_impl(1, time_traits::duration::max(), time_traits::duration(0));
 
-    EXPECT_CALL(pool_impl.has_capacity(), notify_one()).WillOnce(Return());
+    EXPECT_CALL(has_capacity, notify_one()).Times(0);
 
     const get_result first_res = pool_impl.get();
     EXPECT_EQ(first_res.first, boost::system::error_code());
@@ -221,10 +276,10 @@ TEST(sync_resource_pool_impl, should_waste_resource_when_lifespan_ends) {
     EXPECT_EQ(pool_impl.available(), 0u);
 }
 
-TEST(sync_resource_pool_impl, should_waste_used_resource_after_invalidate) {
+TEST_F(sync_resource_pool_impl, should_waste_used_resource_after_invalidate) {
     resource_pool_impl pool(1, time_traits::duration::max(), time_traits::duration::max());
 
-    EXPECT_CALL(pool.has_capacity(), notify_one()).WillOnce(Return());
+    EXPECT_CALL(has_capacity, notify_one()).Times(0);
 
     const get_result res = pool.get();
     EXPECT_EQ(res.first, boost::system::error_code());
@@ -236,7 +291,7 @@ TEST(sync_resource_pool_impl, should_waste_used_resource_after_invalidate) {
     EXPECT_EQ(pool.available(), 0u);
 }
 
-TEST(sync_resource_pool_impl, should_waste_available_resource_after_invalidate) {
+TEST_F(sync_resource_pool_impl, should_waste_available_resource_after_invalidate) {
     resource_pool_impl pool([]{ return resource{}; }, 1, time_traits::duration::max(), time_traits::duration::max());
 
     pool.invalidate();
@@ -244,15 +299,14 @@ TEST(sync_resource_pool_impl, should_waste_available_resource_after_invalidate)
     EXPECT_EQ(pool.available(), 0u);
 }
 
-TEST(sync_resource_pool_impl, should_restore_wasted_cell) {
+TEST_F(sync_resource_pool_impl, should_restore_wasted_cell) {
     resource_pool_impl pool([]{ return resource{}; }, 1, time_traits::duration::max(), time_traits::duration::max());
 
     pool.invalidate();
 
     InSequence s;
 
-    EXPECT_CALL(pool.has_capacity(), notify_one()).WillOnce(Return());
-    EXPECT_CALL(pool.has_capacity(), notify_one()).WillOnce(Return());
+    EXPECT_CALL(has_capacity, notify_one()).Times(0);
 
     const get_result first_res = pool.get();
     EXPECT_EQ(first_res.first, boost::system::error_code());
@@ -268,7 +322,7 @@ TEST(sync_resource_pool_impl, should_restore_wasted_cell) {
     pool.recycle(second_res.second);
 }
 
-TEST(sync_resource_pool_impl, should_waste_used_resource_after_invalidate_when_other_client_is_waiting) {
+TEST_F(sync_resource_pool_impl, should_waste_used_resource_after_invalidate_when_other_client_is_waiting) {
     resource_pool_impl pool(1, time_traits::duration::max(), time_traits::duration::max());
     const get_result& first_res = pool.get();
     pool.invalidate();
@@ -279,8 +333,8 @@ TEST(sync_resource_pool_impl, should_waste_used_resource_after_invalidate_when_o
 
     InSequence s;
 
-    EXPECT_CALL(pool.has_capacity(), wait_for(_, _)).WillOnce(Invoke(recycle_resource(pool, first_res.second)));
-    EXPECT_CALL(pool.has_capacity(), notify_one()).WillOnce(Return());
+    EXPECT_CALL(has_capacity, wait_for(_, _)).WillOnce(Invoke(recycle_resource(pool, first_res.second)));
+    EXPECT_CALL(has_capacity, notify_one()).WillOnce(Return());
 
     const get_result& second_res = pool.get();
 
@@ -288,4 +342,213 @@ TEST(sync_resource_pool_impl, should_waste_used_resource_after_invalidate_when_o
     EXPECT_EQ(second_res.second, first_res.second);
 }
 
+struct lock_tracking_mutex {
+    static inline bool locked = false;
+    static inline std::size_t locks = 0;
+
+    std::mutex impl;
+
+    void lock() {
+        impl.lock();
+        locked = true;
+        ++locks;
+    }
+
+    void unlock() {
+        locked = false;
+        impl.unlock();
+    }
+};
+
+struct stub_condition_variable {
+    void notify_one() {}
+    void notify_all() {}
+
+    template <class Lock>
+    std::cv_status wait_for(Lock&, time_traits::duration) {
+        return std::cv_status::timeout;
+    }
+};
+
+struct lock_tracking_resource {
+    static inline std::size_t destroyed_under_lock = 0;
+
+    bool owner = true;
+
+    lock_tracking_resource() = default;
+    lock_tracking_resource(const lock_tracking_resource&) = delete;
+    lock_tracking_resource(lock_tracking_resource&& other) : owner(other.owner) { other.owner = false; }
+    lock_tracking_resource& operator =(const lock_tracking_resource&) = delete;
+
+    lock_tracking_resource& operator =(lock_tracking_resource&& other) {
+        owner = other.owner;
+        other.owner = false;
+        return *this;
+    }
+
+    ~lock_tracking_resource() {
+        if (owner && lock_tracking_mutex::locked) {
+            ++destroyed_under_lock;
+        }
+    }
+};
+
+using lock_tracking_pool_impl = pool_impl<lock_tracking_resource, lock_tracking_mutex, stub_condition_variable>;
+
+struct sync_resource_pool_impl_destroy_values : Test {
+    sync_resource_pool_impl_destroy_values() {
+        lock_tracking_resource::destroyed_under_lock = 0;
+    }
+};
+
+TEST_F(sync_resource_pool_impl_destroy_values, waste_should_destroy_value_outside_lock) {
+    lock_tracking_pool_impl pool([] { return lock_tracking_resource {}; }, 1,
+                                 time_traits::duration::max(), time_traits::duration::max());
+    const auto res = pool.get();
+    ASSERT_FALSE(res.first);
+    pool.waste(res.second);
+    EXPECT_EQ(lock_tracking_resource::destroyed_under_lock, 0u);
+}
+
+TEST_F(sync_resource_pool_impl_destroy_values, recycle_after_invalidate_should_destroy_value_outside_lock) {
+    lock_tracking_pool_impl pool([] { return lock_tracking_resource {}; }, 1,
+                                 time_traits::duration::max(), time_traits::duration::max());
+    const auto res = pool.get();
+    ASSERT_FALSE(res.first);
+    pool.invalidate();
+    pool.recycle(res.second);
+    EXPECT_EQ(pool.available(), 0u);
+    EXPECT_EQ(lock_tracking_resource::destroyed_under_lock, 0u);
+}
+
+TEST_F(sync_resource_pool_impl_destroy_values, invalidate_should_destroy_available_values_outside_lock) {
+    lock_tracking_pool_impl pool([] { return lock_tracking_resource {}; }, 2,
+                                 time_traits::duration::max(), time_traits::duration::max());
+    pool.invalidate();
+    EXPECT_EQ(pool.available(), 0u);
+    EXPECT_EQ(lock_tracking_resource::destroyed_under_lock, 0u);
+}
+
+TEST_F(sync_resource_pool_impl_destroy_values, get_should_destroy_expired_values_outside_lock) {
+    lock_tracking_pool_impl pool([] { return lock_tracking_resource {}; }, 2,
+                                 time_traits::duration(0), time_traits::duration::max());
+    const auto res = pool.get();
+    ASSERT_FALSE(res.first);
+    EXPECT_FALSE(res.second->value);
+    EXPECT_EQ(lock_tracking_resource::destroyed_under_lock, 0u);
+}
+
+using magazine_pool_impl = pool_impl<lock_tracking_resource, lock_tracking_mutex, stub_condition_variable,
+    detail::storage<lock_tracking_resource>, detail::magazine_cache>;
+
+struct sync_resource_pool_impl_magazine : Test {
+    static void set_value(magazine_pool_impl::list_iterator cell) {
+        cell->value = lock_tracking_resource {};
+        cell->reset_time = time_traits::now();
+    }
+};
+
+TEST_F(sync_resource_pool_impl_magazine, get_after_recycle_in_same_thread_should_return_same_cell_without_locking_mutex) {
+    magazine_pool_impl pool(2, time_traits::duration::max(), time_traits::duration::max());
+    const auto first = pool.get();
+    ASSERT_FALSE(first.first);
+    set_value(first.second);
+    const auto locks = lock_tracking_mutex::locks;
+    pool.recycle(first.second);
+    const auto second = pool.get();
+    EXPECT_EQ(lock_tracking_mutex::locks, locks);
+    ASSERT_FALSE(second.first);
+    EXPECT_EQ(second.second, first.second);
+    EXPECT_TRUE(second.second->value);
+
+    const auto stats = pool.stats();
+    EXPECT_EQ(stats.size, 1u);
+    EXPECT_EQ(stats.available, 0u);
+    EXPECT_EQ(stats.used, 1u);
+}
+
+TEST_F(sync_resource_pool_impl_magazine, invalidate_should_drop_resources_in_magazines) {
+    magazine_pool_impl pool(1, time_traits::duration::max(), time_traits::duration::max());
+    const auto res = pool.get();
+    ASSERT_FALSE(res.first);
+    set_value(res.second);
+    pool.recycle(res.second);
+    pool.invalidate();
+    EXPECT_EQ(pool.available(), 0u);
+    EXPECT_EQ(pool.used(), 0u);
+}
+
+TEST_F(sync_resource_pool_impl_magazine, recycle_of_resource_leased_before_invalidate_should_waste_it) {
+    magazine_pool_impl pool(1, time_traits::duration::max(), time_traits::duration::max());
+    const auto res = pool.get();
+    ASSERT_FALSE(res.first);
+    set_value(res.second);
+    pool.invalidate();
+    pool.recycle(res.second);
+    EXPECT_EQ(pool.available(), 0u);
+    EXPECT_EQ(pool.used(), 0u);
+}
+
+TEST_F(sync_resource_pool_impl_magazine, get_after_idle_timeout_should_return_empty_cell) {
+    magazine_pool_impl pool(1, time_traits::duration(0), time_traits::duration::max());
+    const auto first = pool.get();
+    ASSERT_FALSE(first.first);
+    set_value(first.second);
+    pool.recycle(first.second);
+    const auto second = pool.get();
+    ASSERT_FALSE(second.first);
+    EXPECT_FALSE(second.second->value);
+}
+
+TEST_F(sync_resource_pool_impl_magazine, recycle_after_lifespan_should_not_keep_resource) {
+    magazine_pool_impl pool(1, time_traits::duration::max(), time_traits::duration(0));
+    const auto res = pool.get();
+    ASSERT_FALSE(res.first);
+    set_value(res.second);
+    pool.recycle(res.second);
+    EXPECT_EQ(pool.available(), 0u);
+    EXPECT_EQ(pool.used(), 0u);
+}
+
+TEST_F(sync_resource_pool_impl_magazine, get_in_other_thread_should_take_resource_from_magazine) {
+    magazine_pool_impl pool(1, time_traits::duration::max(), time_traits::duration::max());
+    const auto first = pool.get();
+    ASSERT_FALSE(first.first);
+    set_value(first.second);
+    pool.recycle(first.second);
+    std::thread([&] {
+        const auto second = pool.get();
+        EXPECT_FALSE(second.first);
+        EXPECT_EQ(second.second, first.second);
+    }).join();
+}
+
+using spinning_pool_impl = pool_impl<resource, std::mutex, std::condition_variable,
+    detail::storage<resource>, detail::no_cell_cache, adaptive_spin>;
+
+TEST(sync_resource_pool_impl_spin, get_should_take_resource_recycled_by_other_thread_while_waiting) {
+    spinning_pool_impl pool(1, time_traits::duration::max(), time_traits::duration::max());
+    const auto first = pool.get();
+    ASSERT_FALSE(first.first);
+    std::thread recycler([&] {
+        while (pool.stats().queue_size == 0) {
+            std::this_thread::yield();
+        }
+        pool.recycle(first.second);
+    });
+    const auto second = pool.get(std::chrono::seconds(10));
+    recycler.join();
+    ASSERT_FALSE(second.first);
+    EXPECT_EQ(second.second, first.second);
+}
+
+TEST(sync_resource_pool_impl_spin, get_with_zero_wait_duration_should_not_spin) {
+    spinning_pool_impl pool(1, time_traits::duration::max(), time_traits::duration::max());
+    const auto first = pool.get();
+    ASSERT_FALSE(first.first);
+    const auto limit = pool.spin().limit();
+    EXPECT_EQ(pool.get().first, make_error_code(error::get_resource_timeout));
+    EXPECT_EQ(pool.spin().limit(), limit);
+}
+
 }